@@ -0,0 +1,52 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace olc
+{
+	constexpr int g_screen_w = 160;
+	constexpr int g_screen_h = 100;
+	// positions are cycled through so consecutive ops don't hit the same cells
+	constexpr int g_num_positions = 1024;
+
+	class bench_engine : public cmd_engine
+	{
+	public:
+		// Inherited via cmd_engine, never called as the engine isn't started
+		virtual bool on_user_init() override { return true; }
+		virtual bool on_user_update(float elapsed) override { return false; }
+	};
+
+	enum class clip_t
+	{
+		inside,
+		partial,
+		outside,
+	};
+
+	struct bench_case
+	{
+		std::string primitive;
+		int size;
+		clip_t clip;
+		// cells the op covers when fully on screen, clipped cases still report the nominal count.
+		// Entities processed for the spatial hash, ECS and particles.
+		double pixels_per_op;
+		// i is the index of the op, used to pick its position
+		std::function<void(int i)> op;
+	};
+
+	// The feature benches, one file per module. Cases that draw or use jobs() share the bench's engine.
+	void add_spatial_hash_cases(std::vector<bench_case>& cases);
+	void add_ecs_cases(std::vector<bench_case>& cases);
+	void add_particle_cases(bench_engine& engine, std::vector<bench_case>& cases);
+	void add_tilemap_cases(bench_engine& engine, std::vector<bench_case>& cases);
+	void add_snapshot_cases(std::vector<bench_case>& cases);
+	void add_pathfinding_cases(std::vector<bench_case>& cases);
+	void add_lighting_cases(std::vector<bench_case>& cases);
+	void add_noise_cases(std::vector<bench_case>& cases);
+	void add_physics_cases(bench_engine& engine, std::vector<bench_case>& cases);
+}
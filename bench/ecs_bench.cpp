@@ -0,0 +1,38 @@
+#include "bench.h"
+#include "ecs.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// The position + velocity integration every game with moving things runs each frame
+	//
+	void add_ecs_cases(vector<bench_case>& cases)
+	{
+		struct position
+		{
+			float x, y;
+		};
+		struct velocity
+		{
+			float x, y;
+		};
+
+		const int counts[] = { 10000, 100000, 1000000 };
+		for (int n : counts) {
+			auto w = make_shared<ecs::world>();
+			for (int i = 0; i < n; ++i) {
+				w->create(position{ float(i % 160), float(i % 100) }, velocity{ 1.0f, 0.5f });
+			}
+			cases.push_back({ "ecs_each", n, clip_t::inside, double(n), [w](int) {
+				w->each<position, const velocity>([](position& p, const velocity& v) {
+					p.x += v.x * (1.0f / 60.0f);
+					p.y += v.y * (1.0f / 60.0f);
+				});
+			} });
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#include "bench.h"
+#include "fov.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	// field of view by radius and lighting by number of moving lights, on a 256x256 map walled like the pathfinding maps
+	void add_lighting_cases(vector<bench_case>& cases)
+	{
+		constexpr int side = 256;
+		struct scene
+		{
+			scene() : map(side, side) {}
+
+			grid_map map;
+			field_of_view sight{ map };
+			vector<grid_point> spots;
+			uint64_t seen{ 0 };
+		};
+		auto s = make_shared<scene>();
+		uint32_t seed = 0x9e3779b9u;
+		auto next = [&seed](int range) {
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			return static_cast<int>(seed % static_cast<uint32_t>(range));
+		};
+		for (int i = 0; i < side * side / 10 / 8; ++i) {
+			int x = next(side);
+			int y = next(side);
+			bool vertical = next(2) == 0;
+			for (int k = 0; k < 8; ++k) {
+				s->map.set_passable(vertical ? x : x + k, vertical ? y + k : y, false);
+			}
+		}
+		// open cells with an open neighbour to the east, so lights can step back and forth
+		while (s->spots.size() < g_num_positions) {
+			grid_point p{ next(side - 1), next(side) };
+			if (s->map.passable(p.x, p.y) && s->map.passable(p.x + 1, p.y)) {
+				s->spots.push_back(p);
+			}
+		}
+
+		const int radii[] = { 8, 16, 32 };
+		for (int radius : radii) {
+			cases.push_back({ "fov", radius, clip_t::inside, 1.0, [s, radius](int i) {
+				s->sight.compute(s->spots[i % g_num_positions], radius);
+				s->seen += s->sight.visible().size();
+			} });
+		}
+
+		const int light_counts[] = { 8, 32, 128 };
+		for (int count : light_counts) {
+			// every light moves every op, the worst case for the light map
+			auto light = make_shared<light_map>(s->map);
+			for (int i = 0; i < count; ++i) {
+				light->add(s->spots[i % g_num_positions], 10, { 1.0f, 0.8f, 0.6f });
+			}
+			cases.push_back({ "light_map", count, clip_t::inside, 1.0, [s, light, count](int i) {
+				for (int l = 0; l < count; ++l) {
+					auto p = s->spots[l % g_num_positions];
+					light->move(l, { p.x + (i & 1), p.y });
+				}
+				light->update();
+			} });
+		}
+	}
+}
@@ -0,0 +1,286 @@
+#include "bench.h"
+#include "alloc_tracker.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//
+// Microbenchmarks for the cmd_engine draw primitives, the spatial hash, the ECS, the particle system, the tilemap,
+// snapshots, pathfinding, field of view and lighting, noise and physics. The draw primitive cases and the runner are
+// here, the feature cases are in <module>_bench.cpp.
+//
+// Every primitive is run on a headless engine for a range of sizes, fully on screen, straddling the screen edge
+// and fully off screen. The spatial hash, ECS and particle cases run with up to 100k and 1M entities, their size
+// column is the entity count. The tilemap cases pan a full screen view over maps of growing size, their size column
+// is the map side in tiles. The snapshot cases save and restore a full screen with game state of growing size.
+// The pathfinding cases search between random cells of maps with scattered walls, their size column is the map side.
+// Results go to stdout as a table, and with --csv <file> to a csv file that can be diffed between commits.
+//
+// usage: bench [--csv <file>] [--filter <substring>] [--min-time <ms per case>]
+//
+namespace olc
+{
+	const char* to_string(clip_t clip)
+	{
+		switch (clip) {
+		case clip_t::inside: return "inside";
+		case clip_t::partial: return "partial";
+		default: return "outside";
+		}
+	}
+
+	struct bench_result
+	{
+		double ns_per_op;
+		double pixels_per_sec;
+		double allocs_per_op;
+	};
+
+	//
+	// Top left corners of a size x size box, for the given clipping scenario
+	//
+	vector<pair<int, int>> make_positions(int size, clip_t clip)
+	{
+		// fixed seed, every run benchmarks the same positions
+		uint32_t seed = 0x2545f491u;
+		auto next = [&seed](int n) {
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+			return static_cast<int>(seed % static_cast<uint32_t>(max(n, 1)));
+		};
+
+		vector<pair<int, int>> positions(g_num_positions);
+		for (int i = 0; i < g_num_positions; ++i) {
+			auto& [x, y] = positions[i];
+			switch (clip) {
+			case clip_t::inside:
+				// up to flush with the right and bottom edges
+				x = next(g_screen_w - size + 1);
+				y = next(g_screen_h - size + 1);
+				break;
+			case clip_t::partial:
+				// half the box hangs over one of the four edges
+				x = next(g_screen_w - size);
+				y = next(g_screen_h - size);
+				switch (i % 4) {
+				case 0: x = -size / 2; break;
+				case 1: x = g_screen_w - size / 2; break;
+				case 2: y = -size / 2; break;
+				default: y = g_screen_h - size / 2; break;
+				}
+				break;
+			case clip_t::outside:
+				x = (i % 2) ? g_screen_w + next(size) : -size - next(size) - 1;
+				y = next(g_screen_h);
+				break;
+			}
+		}
+		return positions;
+	}
+
+	vector<bench_case> make_cases(bench_engine& engine)
+	{
+		constexpr float pi = 3.14159265f;
+		const int sizes[] = { 4, 16, 64 };
+		const clip_t clips[] = { clip_t::inside, clip_t::partial, clip_t::outside };
+
+		vector<bench_case> cases;
+		auto& e = engine;
+		for (int s : sizes) {
+			for (clip_t clip : clips) {
+				auto pos = make_positions(s, clip);
+				int r = s / 2;
+
+				auto sprite_ptr = make_shared<sprite>(s, s);
+				for (int x = 0; x < s; ++x) {
+					for (int y = 0; y < s; ++y) {
+						// a few transparent cells like a real sprite
+						sprite_ptr->set_glyph(x, y, ((x + y) % 5 == 0) ? L' ' : pixel_type::solid);
+						sprite_ptr->set_color(x, y, static_cast<short>((x * s + y) & 0xff));
+					}
+				}
+
+				vector<pair<float, float>> polygon;
+				for (int k = 0; k < 8; ++k) {
+					polygon.emplace_back(cosf(k * pi / 4) * r, sinf(k * pi / 4) * r);
+				}
+
+				wstring text(s, L'x');
+
+				cases.push_back({ "draw", s, clip, 1.0, [&e, pos, s](int i) {
+					// single cells spread over the box
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw(x + i % s, y + (i / s) % s);
+				} });
+				cases.push_back({ "fill", s, clip, double(s) * s, [&e, pos, s](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.fill(x, y, x + s - 1, y + s - 1);
+				} });
+				cases.push_back({ "draw_line", s, clip, double(s), [&e, pos, s](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw_line(x, y + (i * 7) % s, x + s - 1, y + (i * 3) % s);
+				} });
+				cases.push_back({ "draw_triangle", s, clip, 3.0 * s, [&e, pos, s](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw_triangle(x, y, x + s - 1, y, x + (i % s), y + s - 1);
+				} });
+				cases.push_back({ "draw_circle", s, clip, 2.0 * pi * r, [&e, pos, r](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw_circle(x + r, y + r, r);
+				} });
+				cases.push_back({ "fill_circle", s, clip, pi * r * r, [&e, pos, r](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.fill_circle(x + r, y + r, r);
+				} });
+				cases.push_back({ "draw_sprite", s, clip, double(s) * s, [&e, pos, sprite_ptr](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw_sprite(x, y, *sprite_ptr);
+				} });
+				cases.push_back({ "draw_shader", s, clip, double(s) * s, [&e, pos, s](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw_shader(x, y, x + s - 1, y + s - 1, [i](int cx, int cy) {
+						return shader_cell{ ((cx ^ cy) & 1) ? L' ' : static_cast<wchar_t>(pixel_type::solid), static_cast<short>((cx + cy + i) & 0xff) };
+					});
+				} });
+				cases.push_back({ "draw_partial_sprite", s, clip, double(r) * r, [&e, pos, sprite_ptr, r](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					int sx = (i % 2) * (r - 1);
+					e.draw_partial_sprite(x, y, *sprite_ptr, sx, sx, r, r);
+				} });
+				cases.push_back({ "draw_wire_polygon", s, clip, 2.0 * pi * r, [&e, pos, polygon, r](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw_wire_polygon(polygon, float(x + r), float(y + r), i * 0.01f);
+				} });
+				cases.push_back({ "draw_string", s, clip, double(s), [&e, pos, text](int i) {
+					auto [x, y] = pos[i % g_num_positions];
+					e.draw_string(x, y, text);
+				} });
+			}
+		}
+		return cases;
+	}
+
+	//
+	// Runs the case in batches for about min_time and keeps the fastest batch, which is the least disturbed by
+	// the rest of the system. Allocations are averaged over every op.
+	//
+	bench_result run_case(const bench_case& c, chrono::milliseconds min_time)
+	{
+		using clock = chrono::steady_clock;
+		constexpr int num_batches = 5;
+
+		// warm up and find a batch size that runs for at least 1/num_batches of min_time
+		int64_t batch = 16;
+		for (;;) {
+			auto t0 = clock::now();
+			for (int64_t i = 0; i < batch; ++i) {
+				c.op(static_cast<int>(i));
+			}
+			if (clock::now() - t0 >= min_time / num_batches || batch >= (int64_t(1) << 30)) {
+				break;
+			}
+			batch *= 2;
+		}
+
+		double best_ns = 1e300;
+		auto allocs_before = alloc_tracker::thread_counters();
+		for (int b = 0; b < num_batches; ++b) {
+			auto t0 = clock::now();
+			for (int64_t i = 0; i < batch; ++i) {
+				c.op(static_cast<int>(i));
+			}
+			double ns = chrono::duration<double, nano>(clock::now() - t0).count();
+			best_ns = min(best_ns, ns / batch);
+		}
+		auto allocs_after = alloc_tracker::thread_counters();
+
+		bench_result result;
+		result.ns_per_op = best_ns;
+		result.pixels_per_sec = c.pixels_per_op * 1e9 / best_ns;
+		result.allocs_per_op = double(allocs_after.count - allocs_before.count) / (double(batch) * num_batches);
+		return result;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	string csv_path;
+	string filter;
+	chrono::milliseconds min_time{ 200 };
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg == "--csv" && i + 1 < argc) {
+			csv_path = argv[++i];
+		}
+		else if (arg == "--filter" && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else if (arg == "--min-time" && i + 1 < argc) {
+			min_time = chrono::milliseconds(atoi(argv[++i]));
+		}
+		else {
+			cerr << "usage: bench [--csv <file>] [--filter <substring>] [--min-time <ms per case>]" << endl;
+			return 1;
+		}
+	}
+
+	olc::bench_engine engine;
+	engine.construct_headless(olc::g_screen_w, olc::g_screen_h);
+	// Headless engines default to a pool without workers, the shader and _jobs cases need every core.
+	engine.set_job_workers(max(thread::hardware_concurrency(), 2u) - 1);
+	auto cases = olc::make_cases(engine);
+	olc::add_spatial_hash_cases(cases);
+	olc::add_ecs_cases(cases);
+	olc::add_particle_cases(engine, cases);
+	olc::add_tilemap_cases(engine, cases);
+	olc::add_snapshot_cases(cases);
+	olc::add_pathfinding_cases(cases);
+	olc::add_lighting_cases(cases);
+	olc::add_noise_cases(cases);
+	olc::add_physics_cases(engine, cases);
+
+	ofstream csv;
+	if (!csv_path.empty()) {
+		csv.open(csv_path);
+		if (!csv) {
+			cerr << "can't open " << csv_path << endl;
+			return 1;
+		}
+		csv << "primitive,size,clip,ns_per_op,mpixels_per_sec,allocs_per_op\n";
+	}
+
+	if (!olc::alloc_tracker::enabled()) {
+		cout << "allocation tracking not compiled in, allocs/op is always 0\n";
+	}
+	cout << left << setw(22) << "primitive" << right << setw(8) << "size" << setw(9) << "clip"
+		<< setw(12) << "ns/op" << setw(14) << "Mpixels/s" << setw(12) << "allocs/op" << "\n";
+
+	for (const auto& c : cases) {
+		string name = c.primitive + "/" + to_string(c.size) + "/" + olc::to_string(c.clip);
+		if (!filter.empty() && name.find(filter) == string::npos) {
+			continue;
+		}
+		auto r = olc::run_case(c, min_time);
+		cout << left << setw(22) << c.primitive << right << setw(8) << c.size << setw(9) << olc::to_string(c.clip)
+			<< fixed << setprecision(1) << setw(12) << r.ns_per_op << setw(14) << r.pixels_per_sec / 1e6
+			<< setprecision(3) << setw(12) << r.allocs_per_op << "\n";
+		if (csv) {
+			csv << c.primitive << "," << c.size << "," << olc::to_string(c.clip) << ","
+				<< fixed << setprecision(2) << r.ns_per_op << "," << r.pixels_per_sec / 1e6 << ","
+				<< setprecision(4) << r.allocs_per_op << "\n";
+		}
+	}
+	return 0;
+}
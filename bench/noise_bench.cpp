@@ -0,0 +1,37 @@
+#include "bench.h"
+#include "noise.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	// filling a square of noise samples, the offset moves every op so it's never the same square twice
+	void add_noise_cases(vector<bench_case>& cases)
+	{
+		struct field
+		{
+			noise gen{ 1 };
+			vector<float> samples;
+		};
+		const int sides[] = { 64, 256 };
+		for (int side : sides) {
+			auto f = make_shared<field>();
+			f->samples.resize(static_cast<size_t>(side) * side);
+			double pixels = double(side) * side;
+			cases.push_back({ "noise_value2", side, clip_t::inside, pixels, [f, side](int i) {
+				f->gen.fill(f->samples.data(), side, side, i * 0.5f, 0.0f, 0.05f, noise_type::value);
+			} });
+			cases.push_back({ "noise_simplex2", side, clip_t::inside, pixels, [f, side](int i) {
+				f->gen.fill(f->samples.data(), side, side, i * 0.5f, 0.0f, 0.05f, noise_type::simplex);
+			} });
+			cases.push_back({ "noise_simplex3", side, clip_t::inside, pixels, [f, side](int i) {
+				f->gen.fill(f->samples.data(), side, side, 0.0f, 0.0f, i * 0.05f, 0.05f, noise_type::simplex);
+			} });
+			cases.push_back({ "noise_fbm4", side, clip_t::inside, pixels, [f, side](int i) {
+				f->gen.fill(f->samples.data(), side, side, i * 0.5f, 0.0f, 0.05f, noise_type::simplex, { 4 });
+			} });
+		}
+	}
+}
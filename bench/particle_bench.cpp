@@ -0,0 +1,36 @@
+#include "bench.h"
+#include "particle_system.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// Particles that never die, so every op updates or draws the full count
+	//
+	void add_particle_cases(bench_engine& engine, vector<bench_case>& cases)
+	{
+		const int counts[] = { 10000, 100000 };
+		for (int n : counts) {
+			auto moving = make_shared<particle_system>(n);
+			moving->set_gravity(0.0f, 0.01f);
+			auto still = make_shared<particle_system>(n);
+			for (int i = 0; i < n; ++i) {
+				float x = float(i % (g_screen_w + 20) - 10);
+				float y = float(i / (g_screen_w + 20) % (g_screen_h + 20) - 10);
+				moving->emit(x, y, 0.1f, -0.1f, 1e9f, static_cast<short>(i & 0xff));
+				still->emit(x, y, 0.0f, 0.0f, 1.0f + (i % 4), static_cast<short>(i & 0xff));
+			}
+
+			cases.push_back({ "particles_update", n, clip_t::inside, double(n), [moving](int) {
+				moving->update(1.0f / 60.0f);
+			} });
+			// about a tenth of them off screen, like a burst near the edge
+			cases.push_back({ "particles_render", n, clip_t::partial, double(n), [&engine, still](int) {
+				still->render(engine);
+			} });
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#include "bench.h"
+#include "pathfinding.h"
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// Maps with short wall segments over a tenth of the cells, roughly a level with rooms rather than noise
+	//
+	void add_pathfinding_cases(vector<bench_case>& cases)
+	{
+		const int sides[] = { 64, 256, 1024 };
+		for (int side : sides) {
+			struct search
+			{
+				// built in place, the searches keep a reference to the map
+				explicit search(int side) : map(side, side) {}
+
+				grid_map map;
+				path_finder paths{ map };
+				flow_field flow{ map };
+				vector<pair<grid_point, grid_point>> ends;
+				vector<grid_point> targets;
+				vector<grid_point> path;
+				uint64_t found{ 0 };
+			};
+			auto s = make_shared<search>(side);
+			uint32_t seed = 0x9e3779b9u;
+			auto next = [&seed](int range) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				return static_cast<int>(seed % static_cast<uint32_t>(range));
+			};
+			for (int i = 0; i < side * side / 10 / 8; ++i) {
+				int x = next(side);
+				int y = next(side);
+				bool vertical = next(2) == 0;
+				for (int k = 0; k < 8; ++k) {
+					s->map.set_passable(vertical ? x : x + k, vertical ? y + k : y, false);
+				}
+			}
+			auto open_cell = [&]() {
+				for (;;) {
+					grid_point p{ next(side), next(side) };
+					if (s->map.passable(p.x, p.y)) {
+						return p;
+					}
+				}
+			};
+			for (int i = 0; i < g_num_positions; ++i) {
+				s->ends.emplace_back(open_cell(), open_cell());
+			}
+			for (int i = 0; i < 16; ++i) {
+				s->targets.push_back(open_cell());
+			}
+
+			cases.push_back({ "path_astar", side, clip_t::inside, 1.0, [s](int i) {
+				auto [from, to] = s->ends[i % g_num_positions];
+				s->found += s->paths.find_path(from, to, s->path);
+			} });
+			cases.push_back({ "path_jps", side, clip_t::inside, 1.0, [s](int i) {
+				auto [from, to] = s->ends[i % g_num_positions];
+				s->found += s->paths.find_path_jps(from, to, s->path);
+			} });
+			cases.push_back({ "flow_field", side, clip_t::inside, double(side) * side, [s](int) {
+				s->flow.build(s->targets);
+			} });
+		}
+	}
+}
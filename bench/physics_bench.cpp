@@ -0,0 +1,51 @@
+#include "bench.h"
+#include "physics.h"
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	// One physics step of 8 heaps settled on a floor, on the calling thread and with the islands on the job system.
+	// Each heap is walled in, so none of it rolls away and the heaps stay separate islands.
+	void add_physics_cases(bench_engine& engine, vector<bench_case>& cases)
+	{
+		constexpr int num_heaps = 8;
+		const int counts[] = { 250, 1000 };
+		for (int n : counts) {
+			auto world = make_shared<physics_world>();
+			world->set_gravity(0.0f, 30.0f);
+			float heap_w = 60.0f;
+			float wall_h = 150.0f;
+			world->add_polygon({ { 0.0f, 0.0f }, { heap_w * num_heaps, 0.0f }, { heap_w * num_heaps, 4.0f }, { 0.0f, 4.0f } }, 0.0f, 0.0f, 0.0f, 0.0f);
+			for (int i = 0; i <= num_heaps; ++i) {
+				world->add_polygon({ { -1.0f, -wall_h }, { 1.0f, -wall_h }, { 1.0f, 0.0f }, { -1.0f, 0.0f } }, i * heap_w, 0.0f, 0.0f, 0.0f);
+			}
+			int per_row = 6;
+			for (int i = 0; i < n; ++i) {
+				int heap = i % num_heaps;
+				int k = i / num_heaps;
+				float x = heap * heap_w + 15.0f + (k % per_row) * 6.0f;
+				float y = -4.0f - (k / per_row) * 6.0f;
+				if (i % 2 == 0) {
+					world->add_circle(x, y, 1.5f);
+				}
+				else {
+					world->add_polygon({ { -1.5f, -1.5f }, { 1.5f, -1.5f }, { 1.5f, 1.5f }, { -1.5f, 1.5f } }, x, y, 0.1f * k);
+				}
+			}
+			for (int s = 0; s < 300; ++s) {
+				world->step();
+			}
+			cases.push_back({ "physics", n, clip_t::inside, double(n), [world](int) {
+				world->set_job_system(nullptr);
+				world->step();
+			} });
+			cases.push_back({ "physics_jobs", n, clip_t::inside, double(n), [world, &engine](int) {
+				world->set_job_system(&engine.jobs());
+				world->step();
+			} });
+		}
+	}
+}
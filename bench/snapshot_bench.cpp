@@ -0,0 +1,44 @@
+#include "bench.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// A full screen plus game state of growing size, the size column is the state in KB. Each size gets an engine
+	// of its own with the state registered.
+	//
+	void add_snapshot_cases(vector<bench_case>& cases)
+	{
+		const int sizes_kb[] = { 1, 64, 1024 };
+		for (int kb : sizes_kb) {
+			auto engine = make_shared<bench_engine>();
+			engine->construct_headless(g_screen_w, g_screen_h);
+			auto state = make_shared<vector<uint8_t>>(size_t(kb) * 1024);
+			for (size_t i = 0; i < state->size(); ++i) {
+				(*state)[i] = static_cast<uint8_t>((i * 7) >> 5);
+			}
+			engine->register_snapshot_state(state->data(), state->size());
+			for (int i = 0; i < g_screen_w * g_screen_h; ++i) {
+				engine->draw(i % g_screen_w, i / g_screen_w, pixel_type::solid, static_cast<short>((i / 37) & 0xf));
+			}
+			auto snap = make_shared<snapshot>();
+			engine->save_snapshot(*snap);
+
+			cases.push_back({ "snapshot_save", kb, clip_t::inside, double(g_screen_w) * g_screen_h, [engine, state, snap](int) {
+				engine->save_snapshot(*snap);
+			} });
+			cases.push_back({ "snapshot_restore", kb, clip_t::inside, double(g_screen_w) * g_screen_h, [engine, state, snap](int) {
+				engine->restore_snapshot(*snap);
+			} });
+			// off the game thread in a game, measured inline here
+			cases.push_back({ "snapshot_compress", kb, clip_t::inside, double(g_screen_w) * g_screen_h, [engine, state, snap](int) {
+				engine->save_snapshot(*snap);
+				snap->compressed();
+			} });
+		}
+	}
+}
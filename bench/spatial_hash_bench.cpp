@@ -0,0 +1,67 @@
+#include "bench.h"
+#include "spatial_hash.h"
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// Entities spread over a world sized for about 4 per cell, moving a little every op like a real frame
+	//
+	void add_spatial_hash_cases(vector<bench_case>& cases)
+	{
+		constexpr float cell = 8.0f;
+		const int counts[] = { 1000, 10000, 100000 };
+
+		for (int n : counts) {
+			struct world
+			{
+				spatial_hash hash;
+				vector<pair<float, float>> pos;
+				uint64_t found{ 0 };
+			};
+			float extent = sqrtf(float(n) / 4.0f) * cell;
+			auto w = make_shared<world>(world{ spatial_hash(cell, n) });
+			uint32_t seed = 0x9e3779b9u;
+			auto next = [&seed](float range) {
+				seed ^= seed << 13;
+				seed ^= seed >> 17;
+				seed ^= seed << 5;
+				return (seed & 0xffffff) / float(0x1000000) * range;
+			};
+			for (int i = 0; i < n; ++i) {
+				w->pos.emplace_back(next(extent), next(extent));
+				w->hash.insert(i, w->pos[i].first, w->pos[i].second);
+			}
+
+			cases.push_back({ "spatial_rebuild", n, clip_t::inside, double(n), [w, n](int) {
+				w->hash.clear();
+				for (int i = 0; i < n; ++i) {
+					w->hash.insert(i, w->pos[i].first, w->pos[i].second);
+				}
+			} });
+			cases.push_back({ "spatial_move", n, clip_t::inside, 1.0, [w, n, extent](int i) {
+				// a nudge that crosses a cell now and then, wrapping around the world
+				int id = static_cast<int>(static_cast<uint32_t>(i) * 7919u % n);
+				auto& [x, y] = w->pos[id];
+				x = fmodf(x + 1.5f, extent);
+				y = fmodf(y + 0.5f, extent);
+				w->hash.move(id, x, y);
+			} });
+			cases.push_back({ "spatial_query_radius", n, clip_t::inside, 1.0, [w, n, extent](int i) {
+				auto [x, y] = w->pos[static_cast<uint32_t>(i) * 104729u % n];
+				w->hash.query_radius(x, y, 2.0f * cell, [&w](uint32_t id) { w->found += id; });
+			} });
+			cases.push_back({ "spatial_query_rect", n, clip_t::inside, 1.0, [w, n](int i) {
+				auto [x, y] = w->pos[static_cast<uint32_t>(i) * 104729u % n];
+				w->hash.query_rect(x - 4.0f * cell, y - 2.0f * cell, x + 4.0f * cell, y + 2.0f * cell,
+					[&w](uint32_t id) { w->found += id; });
+			} });
+		}
+	}
+}
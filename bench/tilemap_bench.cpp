@@ -0,0 +1,35 @@
+#include "bench.h"
+#include "tilemap.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// The view moves every op, the cost should stay flat as the map grows
+	//
+	void add_tilemap_cases(bench_engine& engine, vector<bench_case>& cases)
+	{
+		const int sides[] = { 1000, 100000 };
+		for (int n : sides) {
+			auto map = make_shared<tilemap>(n, n);
+			map->define_tile(1, pixel_type::solid, color_t::fg_green);
+			map->define_tile(2, pixel_type::half, color_t::fg_dark_green);
+			// sparse, about one chunk in four has something in it
+			for (uint32_t i = 0; i < 100000; ++i) {
+				uint32_t x = (i * 7919u) % static_cast<uint32_t>(n);
+				uint32_t y = (i * 104729u) % static_cast<uint32_t>(n);
+				map->set(static_cast<int>(x), static_cast<int>(y), static_cast<tilemap::tile_id>(1 + (i & 1)));
+			}
+
+			cases.push_back({ "tilemap_render", n, clip_t::inside, double(g_screen_w) * g_screen_h, [&engine, map, n](int i) {
+				uint32_t span = static_cast<uint32_t>(n - g_screen_w);
+				camera cam{ float((static_cast<uint32_t>(i) * 37u) % span), float((static_cast<uint32_t>(i) * 91u) % span) };
+				map->render(engine, cam);
+			} });
+		}
+	}
+}
@@ -0,0 +1,127 @@
+#include "alloc_tracker.h"
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+#if defined(_DEBUG) && !defined(OLC_TRACK_ALLOCATIONS)
+#define OLC_TRACK_ALLOCATIONS
+#endif
+
+namespace olc
+{
+	namespace alloc_tracker
+	{
+#ifdef OLC_TRACK_ALLOCATIONS
+		namespace
+		{
+			// plain thread_local PODs, no constructor so operator new can use them before anything else is set up
+			thread_local uint64_t t_count = 0;
+			thread_local uint64_t t_bytes = 0;
+		}
+
+		bool enabled()
+		{
+			return true;
+		}
+
+		counters thread_counters()
+		{
+			return { t_count, t_bytes };
+		}
+
+		void* tracked_malloc(size_t size)
+		{
+			++t_count;
+			t_bytes += size;
+			return malloc(size ? size : 1);
+		}
+
+		void* tracked_aligned_malloc(size_t size, size_t alignment)
+		{
+			++t_count;
+			t_bytes += size;
+			return _aligned_malloc(size ? size : 1, alignment);
+		}
+#else
+		bool enabled()
+		{
+			return false;
+		}
+
+		counters thread_counters()
+		{
+			return { 0, 0 };
+		}
+#endif
+	}
+}
+
+#ifdef OLC_TRACK_ALLOCATIONS
+//
+// Global allocation functions. This translation unit is linked in because cmd_engine calls thread_counters(),
+// and the definitions here then take precedence over the ones in the CRT.
+//
+using olc::alloc_tracker::tracked_malloc;
+using olc::alloc_tracker::tracked_aligned_malloc;
+
+void* operator new(size_t size)
+{
+	if (void* p = tracked_malloc(size)) {
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return tracked_malloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return tracked_malloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* p = tracked_aligned_malloc(size, static_cast<size_t>(alignment))) {
+		return p;
+	}
+	throw std::bad_alloc{};
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return tracked_aligned_malloc(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	return tracked_aligned_malloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { free(p); }
+
+// aligned blocks come from _aligned_malloc and must go back through _aligned_free
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { _aligned_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { _aligned_free(p); }
+#endif
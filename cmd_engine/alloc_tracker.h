@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+namespace olc
+{
+	//
+	// Counts heap allocations per thread by replacing the global operator new.
+	//
+	// The replacement is only compiled into debug builds, or any build defining OLC_TRACK_ALLOCATIONS, so release
+	// builds keep the CRT allocator untouched. cmd_engine uses it to report allocations made during on_user_update.
+	//
+	namespace alloc_tracker
+	{
+		struct counters
+		{
+			uint64_t count;
+			uint64_t bytes;
+		};
+
+		// true if operator new is instrumented in this build
+		bool enabled();
+
+		// allocations made by the calling thread since it started, all zero if not enabled
+		counters thread_counters();
+	}
+}
@@ -0,0 +1,434 @@
+#include "audio.h"
+#include "cmd_engine.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numbers>
+
+#pragma comment(lib, "winmm.lib")
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		// frames the mixer makes at a time, ~6 ms
+		constexpr size_t g_mix_frames = 256;
+
+		uint32_t read32(const uint8_t* p)
+		{
+			uint32_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		uint16_t read16(const uint8_t* p)
+		{
+			uint16_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		void write32(FILE* f, uint32_t v)
+		{
+			fwrite(&v, sizeof(v), 1, f);
+		}
+
+		void write16(FILE* f, uint16_t v)
+		{
+			fwrite(&v, sizeof(v), 1, f);
+		}
+	}
+
+	//
+	// sound class
+	//
+	sound::sound(const wstring& file)
+	{
+		FILE* f{ nullptr };
+		_wfopen_s(&f, file.c_str(), L"rb");
+		if (!f) {
+			throw olc_exception(L"Can't open sound "s + file);
+		}
+		vector<uint8_t> data;
+		uint8_t buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+			data.insert(data.end(), buf, buf + n);
+		}
+		fclose(f);
+
+		if (data.size() < 12 || memcmp(data.data(), "RIFF", 4) != 0 || memcmp(data.data() + 8, "WAVE", 4) != 0) {
+			throw olc_exception(L"Not a .wav file "s + file);
+		}
+
+		// walk the chunks for the format and the data
+		int channels = 0;
+		int bits = 0;
+		uint32_t rate = 0;
+		const uint8_t* pcm = nullptr;
+		size_t pcm_bytes = 0;
+		size_t pos = 12;
+		while (pos + 8 <= data.size()) {
+			const uint8_t* chunk = data.data() + pos;
+			size_t size = min<size_t>(read32(chunk + 4), data.size() - pos - 8);
+			if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+				if (read16(chunk + 8) != 1) {
+					throw olc_exception(L"Only PCM .wav files are supported "s + file);
+				}
+				channels = read16(chunk + 10);
+				rate = read32(chunk + 12);
+				bits = read16(chunk + 22);
+			}
+			else if (memcmp(chunk, "data", 4) == 0) {
+				pcm = chunk + 8;
+				pcm_bytes = size;
+			}
+			// chunks are word aligned
+			pos += 8 + size + (size & 1);
+		}
+		if ((channels != 1 && channels != 2) || (bits != 8 && bits != 16) || rate == 0 || !pcm) {
+			throw olc_exception(L"Only 8 or 16 bit mono or stereo .wav files are supported "s + file);
+		}
+
+		size_t nsamples = pcm_bytes / (bits / 8);
+		nsamples -= nsamples % channels;
+		vector<int16_t> samples(nsamples);
+		for (size_t i = 0; i < nsamples; ++i) {
+			samples[i] = bits == 8
+				? static_cast<int16_t>((static_cast<int>(pcm[i]) - 128) << 8)
+				: static_cast<int16_t>(read16(pcm + i * 2));
+		}
+
+		_channels = channels;
+		if (rate == static_cast<uint32_t>(audio_mixer::g_rate)) {
+			_samples = move(samples);
+			return;
+		}
+
+		// linear resampling, good enough for effects
+		size_t in_frames = nsamples / channels;
+		size_t out_frames = in_frames ? static_cast<size_t>(static_cast<double>(in_frames) * audio_mixer::g_rate / rate) : 0;
+		_samples.resize(out_frames * channels);
+		double step = static_cast<double>(rate) / audio_mixer::g_rate;
+		for (size_t i = 0; i < out_frames; ++i) {
+			double at = i * step;
+			size_t i0 = min(static_cast<size_t>(at), in_frames - 1);
+			size_t i1 = min(i0 + 1, in_frames - 1);
+			float t = static_cast<float>(at - static_cast<double>(i0));
+			for (int c = 0; c < channels; ++c) {
+				float a = samples[i0 * channels + c];
+				float b = samples[i1 * channels + c];
+				_samples[i * channels + c] = static_cast<int16_t>(lrintf(a + (b - a) * t));
+			}
+		}
+	}
+
+	sound sound::tone(float hz, float seconds, float volume)
+	{
+		sound s;
+		auto n = static_cast<size_t>(max(seconds, 0.0f) * audio_mixer::g_rate);
+		s._samples.resize(n);
+		float amplitude = clamp(volume, 0.0f, 1.0f) * 32767.0f;
+		for (size_t i = 0; i < n; ++i) {
+			float t = static_cast<float>(i) / audio_mixer::g_rate;
+			float fade = 1.0f - static_cast<float>(i) / n;
+			s._samples[i] = static_cast<int16_t>(lrintf(amplitude * fade * sinf(2.0f * numbers::pi_v<float> * hz * t)));
+		}
+		return s;
+	}
+
+	//
+	// waveout_sink class
+	//
+	waveout_sink::waveout_sink()
+		: _memory(g_blocks * g_block_frames * 2)
+	{
+		WAVEFORMATEX format{};
+		format.wFormatTag = WAVE_FORMAT_PCM;
+		format.nChannels = 2;
+		format.nSamplesPerSec = audio_mixer::g_rate;
+		format.wBitsPerSample = 16;
+		format.nBlockAlign = format.nChannels * format.wBitsPerSample / 8;
+		format.nAvgBytesPerSec = format.nSamplesPerSec * format.nBlockAlign;
+
+		_done = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+		if (waveOutOpen(&_device, WAVE_MAPPER, &format, reinterpret_cast<DWORD_PTR>(_done), 0, CALLBACK_EVENT) != MMSYSERR_NOERROR) {
+			CloseHandle(_done);
+			throw olc_exception(L"Can't open the audio output device");
+		}
+		for (int i = 0; i < g_blocks; ++i) {
+			auto& h = _headers[i];
+			h.lpData = reinterpret_cast<LPSTR>(_memory.data() + i * g_block_frames * 2);
+			h.dwBufferLength = static_cast<DWORD>(g_block_frames * 2 * sizeof(int16_t));
+			waveOutPrepareHeader(_device, &h, sizeof(h));
+			// free until first written
+			h.dwFlags |= WHDR_DONE;
+		}
+	}
+
+	waveout_sink::~waveout_sink()
+	{
+		waveOutReset(_device);
+		for (auto& h : _headers) {
+			waveOutUnprepareHeader(_device, &h, sizeof(h));
+		}
+		waveOutClose(_device);
+		CloseHandle(_done);
+	}
+
+	void waveout_sink::write(const int16_t* frames, size_t nframes)
+	{
+		while (nframes > 0) {
+			auto& h = _headers[_current];
+			// the device sets WHDR_DONE and signals the event when it hands a block back
+			while (!(h.dwFlags & WHDR_DONE)) {
+				WaitForSingleObject(_done, INFINITE);
+			}
+			size_t n = min(nframes, g_block_frames - _filled);
+			memcpy(_memory.data() + (_current * g_block_frames + _filled) * 2, frames, n * 2 * sizeof(int16_t));
+			_filled += n;
+			frames += n * 2;
+			nframes -= n;
+			if (_filled == g_block_frames) {
+				h.dwFlags &= ~WHDR_DONE;
+				waveOutWrite(_device, &h, sizeof(h));
+				_current = (_current + 1) % g_blocks;
+				_filled = 0;
+			}
+		}
+	}
+
+	//
+	// wav_sink class
+	//
+	wav_sink::wav_sink(const wstring& file)
+	{
+		_wfopen_s(&_file, file.c_str(), L"wb");
+		if (!_file) {
+			throw olc_exception(L"Can't create "s + file);
+		}
+		// the sizes are patched in once the length is known
+		fwrite("RIFF", 1, 4, _file);
+		write32(_file, 0);
+		fwrite("WAVEfmt ", 1, 8, _file);
+		write32(_file, 16);
+		write16(_file, 1);
+		write16(_file, 2);
+		write32(_file, audio_mixer::g_rate);
+		write32(_file, audio_mixer::g_rate * 4);
+		write16(_file, 4);
+		write16(_file, 16);
+		fwrite("data", 1, 4, _file);
+		write32(_file, 0);
+	}
+
+	wav_sink::~wav_sink()
+	{
+		fseek(_file, 4, SEEK_SET);
+		write32(_file, 36 + _data_bytes);
+		fseek(_file, 40, SEEK_SET);
+		write32(_file, _data_bytes);
+		fclose(_file);
+	}
+
+	void wav_sink::write(const int16_t* frames, size_t nframes)
+	{
+		fwrite(frames, sizeof(int16_t) * 2, nframes, _file);
+		_data_bytes += static_cast<uint32_t>(nframes * 2 * sizeof(int16_t));
+	}
+
+	//
+	// audio_mixer class
+	//
+	audio_mixer::audio_mixer(unique_ptr<audio_sink> sink)
+		: _sink{ move(sink) }, _accum(g_mix_frames * 2), _block(g_mix_frames * 2)
+	{
+		if (_sink->realtime()) {
+			_thread = thread(&audio_mixer::mixer_thread, this);
+		}
+	}
+
+	audio_mixer::~audio_mixer()
+	{
+		_stop = true;
+		if (_thread.joinable()) {
+			_thread.join();
+		}
+	}
+
+	audio_mixer::voice_id audio_mixer::play(const sound& s, float volume, float pan, bool loop)
+	{
+		voice_id id = ++_next_id;
+		if (id == 0) {
+			id = ++_next_id;
+		}
+		return push({ command::play, loop, id, &s, volume, pan }) ? id : 0;
+	}
+
+	void audio_mixer::stop(voice_id v)
+	{
+		push({ command::stop, false, v, nullptr, 0.0f, 0.0f });
+	}
+
+	void audio_mixer::set_volume(voice_id v, float volume, float pan)
+	{
+		push({ command::set_volume, false, v, nullptr, volume, pan });
+	}
+
+	void audio_mixer::stop_all()
+	{
+		push({ command::stop_all, false, 0, nullptr, 0.0f, 0.0f });
+	}
+
+	void audio_mixer::set_master_volume(float volume)
+	{
+		push({ command::master_volume, false, 0, nullptr, volume, 0.0f });
+	}
+
+	bool audio_mixer::push(const command& c)
+	{
+		size_t tail = _queue_tail.load(memory_order_relaxed);
+		if (tail - _queue_head.load(memory_order_acquire) == g_queue_size) {
+			OutputDebugString(L"audio command queue full, command dropped\n");
+			return false;
+		}
+		_queue[tail % g_queue_size] = c;
+		_queue_tail.store(tail + 1, memory_order_release);
+		return true;
+	}
+
+	void audio_mixer::apply(const command& c)
+	{
+		auto set_gains = [&c](voice& v) {
+			float pan = clamp(c.pan, -1.0f, 1.0f);
+			v.gain_l = c.volume * min(1.0f, 1.0f - pan);
+			v.gain_r = c.volume * min(1.0f, 1.0f + pan);
+		};
+
+		switch (c.kind) {
+		case command::play: {
+			auto it = find_if(_voices.begin(), _voices.end(), [](const voice& v) { return !v.s; });
+			if (it == _voices.end()) {
+				it = min_element(_voices.begin(), _voices.end(), [](const voice& a, const voice& b) { return a.started < b.started; });
+			}
+			it->id = c.id;
+			it->s = c.s;
+			it->pos = 0;
+			it->loop = c.loop;
+			it->started = _blocks;
+			set_gains(*it);
+			break;
+		}
+		case command::stop:
+		case command::set_volume:
+			for (auto& v : _voices) {
+				if (v.s && v.id == c.id) {
+					if (c.kind == command::stop) {
+						v.s = nullptr;
+					}
+					else {
+						set_gains(v);
+					}
+				}
+			}
+			break;
+		case command::stop_all:
+			for (auto& v : _voices) {
+				v.s = nullptr;
+			}
+			break;
+		case command::master_volume:
+			_master = max(c.volume, 0.0f);
+			break;
+		}
+	}
+
+	void audio_mixer::mix(int16_t* out, size_t nframes)
+	{
+		size_t head = _queue_head.load(memory_order_relaxed);
+		size_t tail = _queue_tail.load(memory_order_acquire);
+		for (; head != tail; ++head) {
+			apply(_queue[head % g_queue_size]);
+		}
+		_queue_head.store(head, memory_order_release);
+
+		if (_accum.size() < nframes * 2) {
+			_accum.resize(nframes * 2);
+		}
+		fill_n(_accum.begin(), nframes * 2, 0.0f);
+
+		for (auto& v : _voices) {
+			if (!v.s) {
+				continue;
+			}
+			const int16_t* src = v.s->samples();
+			size_t len = v.s->length();
+			bool stereo = v.s->channels() == 2;
+			float* dst = _accum.data();
+			size_t left = nframes;
+			while (left > 0 && v.s) {
+				size_t run = min(left, len - v.pos);
+				if (stereo) {
+					const int16_t* p = src + v.pos * 2;
+					for (size_t k = 0; k < run; ++k) {
+						dst[k * 2] += p[k * 2] * v.gain_l;
+						dst[k * 2 + 1] += p[k * 2 + 1] * v.gain_r;
+					}
+				}
+				else {
+					const int16_t* p = src + v.pos;
+					for (size_t k = 0; k < run; ++k) {
+						dst[k * 2] += p[k] * v.gain_l;
+						dst[k * 2 + 1] += p[k] * v.gain_r;
+					}
+				}
+				dst += run * 2;
+				left -= run;
+				v.pos += run;
+				if (v.pos == len) {
+					if (v.loop && len > 0) {
+						v.pos = 0;
+					}
+					else {
+						v.s = nullptr;
+					}
+				}
+			}
+		}
+
+		for (size_t i = 0; i < nframes * 2; ++i) {
+			out[i] = static_cast<int16_t>(clamp(lrintf(_accum[i] * _master), -32768L, 32767L));
+		}
+		++_blocks;
+	}
+
+	void audio_mixer::advance(float elapsed)
+	{
+		if (_sink->realtime()) {
+			return;
+		}
+		_pending_frames += static_cast<double>(elapsed) * g_rate;
+		auto n = static_cast<size_t>(_pending_frames);
+		_pending_frames -= static_cast<double>(n);
+		while (n > 0) {
+			size_t m = min(n, g_mix_frames);
+			mix(_block.data(), m);
+			_sink->write(_block.data(), m);
+			n -= m;
+		}
+	}
+
+	void audio_mixer::mixer_thread()
+	{
+		OLC_TRACE_THREAD_NAME("audio mixer");
+		while (!_stop) {
+			mix(_block.data(), g_mix_frames);
+			// blocks until the device has room
+			_sink->write(_block.data(), g_mix_frames);
+		}
+	}
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <windows.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace olc
+{
+	//
+	// PCM audio preloaded at the mixer's rate, 16 bit mono or stereo
+	//
+	class sound
+	{
+	public:
+		sound() = default;
+
+		// Loads a 8 or 16 bit PCM .wav, resampled to the mixer's rate. Throws olc_exception if it can't.
+		explicit sound(const std::wstring& file);
+		// A short tone, for effects without asset files: a sine at hz fading out over seconds
+		static sound tone(float hz, float seconds, float volume = 0.5f);
+
+		int channels() const { return _channels; }
+		// in frames, one sample per channel
+		size_t length() const { return _samples.size() / _channels; }
+		const int16_t* samples() const { return _samples.data(); }
+
+	private:
+		int _channels{ 1 };
+		std::vector<int16_t> _samples;
+	};
+
+	//
+	// Where the mixed audio goes, interleaved 16 bit stereo at audio_mixer::g_rate.
+	//
+	class audio_sink
+	{
+	public:
+		virtual ~audio_sink() = default;
+
+		// A realtime sink blocks in write until the device wants more; the mixer then runs on a thread of its own.
+		// Other sinks are fed by the game thread, the frame's elapsed time of audio every frame.
+		virtual bool realtime() const = 0;
+		virtual void write(const int16_t* frames, size_t nframes) = 0;
+	};
+
+	// The default output device through waveOut
+	class waveout_sink : public audio_sink
+	{
+	public:
+		// Throws olc_exception if there's no output device
+		waveout_sink();
+		~waveout_sink();
+
+		virtual bool realtime() const override { return true; }
+		virtual void write(const int16_t* frames, size_t nframes) override;
+
+	private:
+		static constexpr int g_blocks = 4;
+		static constexpr size_t g_block_frames = 512;
+
+		HWAVEOUT _device{ nullptr };
+		HANDLE _done{ nullptr };
+		std::array<WAVEHDR, g_blocks> _headers{};
+		std::vector<int16_t> _memory;
+		int _current{ 0 };
+		size_t _filled{ 0 };
+	};
+
+	// Writes everything to a .wav file, for headless runs and tests
+	class wav_sink : public audio_sink
+	{
+	public:
+		// Throws olc_exception if the file can't be created
+		explicit wav_sink(const std::wstring& file);
+		~wav_sink();
+
+		virtual bool realtime() const override { return false; }
+		virtual void write(const int16_t* frames, size_t nframes) override;
+
+	private:
+		FILE* _file{ nullptr };
+		uint32_t _data_bytes{ 0 };
+	};
+
+	// Drops everything
+	class null_sink : public audio_sink
+	{
+	public:
+		virtual bool realtime() const override { return false; }
+		virtual void write(const int16_t* frames, size_t nframes) override { _frames += nframes; }
+
+		uint64_t frames() const { return _frames; }
+
+	private:
+		uint64_t _frames{ 0 };
+	};
+
+	//
+	// Mixes sounds playing on a fixed pool of voices into a sink.
+	//
+	// The game thread only ever pushes commands into a lock free ring, the mixer picks them up at the start of every
+	// block it mixes; no lock is taken on either side. A command that finds the ring full is dropped rather than
+	// waited on, the ring holds far more than a frame issues between two blocks.
+	//
+	// Sounds are referred to by pointer and must stay loaded while they may be playing.
+	//
+	class audio_mixer
+	{
+	public:
+		static constexpr int g_rate = 44100;
+		static constexpr int g_voices = 32;
+
+		// returned by play, 0 is never a voice
+		using voice_id = uint32_t;
+
+	public:
+		explicit audio_mixer(std::unique_ptr<audio_sink> sink);
+		~audio_mixer();
+
+		audio_mixer(const audio_mixer&) = delete;
+		audio_mixer& operator=(const audio_mixer&) = delete;
+
+		//
+		// Game thread
+		//
+		// Starts s on a free voice, or on the one that has played longest if all are busy. pan is -1 left to 1 right.
+		voice_id play(const sound& s, float volume = 1.0f, float pan = 0.0f, bool loop = false);
+		void stop(voice_id v);
+		void set_volume(voice_id v, float volume, float pan = 0.0f);
+		void stop_all();
+		void set_master_volume(float volume);
+
+		// Feeds a non realtime sink elapsed seconds of audio, done by the engine every frame
+		void advance(float elapsed);
+
+		//
+		// Mixer side, called by the mixer thread or advance
+		//
+		// Applies the pending commands and mixes nframes stereo frames into out
+		void mix(int16_t* out, size_t nframes);
+
+	private:
+		struct command
+		{
+			enum kind_t : uint8_t
+			{
+				play,
+				stop,
+				set_volume,
+				stop_all,
+				master_volume,
+			};
+
+			kind_t kind;
+			bool loop;
+			voice_id id;
+			const sound* s;
+			float volume;
+			float pan;
+		};
+
+		struct voice
+		{
+			voice_id id{ 0 };
+			const sound* s{ nullptr };
+			size_t pos{ 0 };
+			float gain_l{ 0.0f };
+			float gain_r{ 0.0f };
+			bool loop{ false };
+			// mixer blocks since it started, the oldest is taken over when no voice is free
+			uint64_t started{ 0 };
+		};
+
+		bool push(const command& c);
+		void apply(const command& c);
+		void mixer_thread();
+
+	private:
+		std::unique_ptr<audio_sink> _sink;
+
+		// single producer, single consumer
+		static constexpr size_t g_queue_size = 256;
+		std::array<command, g_queue_size> _queue{};
+		alignas(64) std::atomic<size_t> _queue_head{ 0 };
+		alignas(64) std::atomic<size_t> _queue_tail{ 0 };
+		voice_id _next_id{ 0 };
+
+		// owned by the mixer side
+		std::array<voice, g_voices> _voices{};
+		float _master{ 1.0f };
+		uint64_t _blocks{ 0 };
+		std::vector<float> _accum;
+		std::vector<int16_t> _block;
+		// fraction of a frame carried between advance calls
+		double _pending_frames{ 0.0 };
+
+		std::atomic<bool> _stop{ false };
+		std::thread _thread;
+	};
+}
@@ -1,701 +1,1246 @@
-#include "cmd_engine.h"
-#include <array>
-#include <stdexcept>
-#include <thread>
-#include <iostream>
-#include <boost/format.hpp>
-#include <cstdio>
-#include <cassert>
-
-
-using namespace std;
-
-namespace olc {
-	//
-	// Utility functions
-	//
-	void pause()
-	{
-		cout << "Press enter to quit";
-		cin.ignore();
-	}
-
-	//
-	// sprite class
-	//
-	sprite::sprite(int w, int h)
-	{
-		create(w, h);
-	}
-
-	sprite::sprite(const std::wstring& file)
-	{
-		if (!load(file)) {
-			create(8, 8);
-		}
-	}
-
-	void sprite::create(int w, int h)
-	{
-		_width = w;
-		_height = h;
-		_glyphs.resize(w * h, L' ');
-		_colors.resize(w * h, color_t::fg_black);
-	}
-
-	bool sprite::save(const std::wstring& file) const
-	{
-		FILE* f{ nullptr };
-		_wfopen_s(&f, file.c_str(), L"wb");
-		if (!f) {
-			return false;
-		}
-
-		fwrite(&_width, sizeof(_width), 1, f);
-		fwrite(&_height, sizeof(_height), 1, f);
-		fwrite(_glyphs.data(), sizeof(wchar_t), _width * _height, f);
-		fwrite(_colors.data(), sizeof(color_t::enum_t), _width * _height, f);
-
-		fclose(f);
-		return true;
-	}
-
-    bool sprite::load(const std::wstring& file)
-    {
-        _width = 0;
-        _height = 0;
-        _glyphs.clear();
-        _colors.clear();
-
-        FILE* f{ nullptr };
-        _wfopen_s(&f, file.c_str(), L"rb");
-        if (!f) {
-            return false;
-        }
-
-        fread(&_width, sizeof(_width), 1, f);
-        fread(&_height, sizeof(_height), 1, f);
-        create(_width, _height);
-        fread(_glyphs.data(), sizeof(wchar_t), _width * _height, f);
-        fread(_colors.data(), sizeof(color_t::enum_t), _width * _height, f);
-
-        fclose(f);
-        return true;
-    }
-
-    bool sprite::load_from_resource(uint32_t id)
-    {
-        // RT_RCDATA is resource type raw cdata.
-        HRSRC resinfo = FindResource(nullptr, MAKEINTRESOURCE(id), RT_RCDATA);
-        if (!resinfo) {
-            return false;
-        }
-        HGLOBAL res = LoadResource(nullptr, resinfo);
-        if (!res) {
-            return false;
-        }
-        char *res_data = (char*)LockResource(res);
-        DWORD res_size = SizeofResource(nullptr, resinfo);
-
-        _width = 0;
-        _height = 0;
-        _glyphs.clear();
-        _colors.clear();
-
-        int *res_dimension = reinterpret_cast<int*>(res_data);
-        std::copy_n(res_dimension, 1, &_width);
-        std::copy_n(res_dimension + 1, 1, &_height);
-        create(_width, _height);
-        wchar_t *res_glyphs = reinterpret_cast<wchar_t*>(res_data + sizeof(int) * 2);
-        std::copy_n(res_glyphs, _width * _height, _glyphs.begin());
-        short *res_color = reinterpret_cast<short*>(res_glyphs + _width * _height);
-        std::copy_n(res_color, _width * _height, _colors.begin());
-
-        return true;
-    }
-
-	void sprite::set_glyph(int x, int y, wchar_t c)
-	{
-		if (!out_of_bound(x, y)) {
-			_glyphs[y * _width + x] = c;
-		}
-	}
-
-	void sprite::set_color(int x, int y, short c)
-	{
-		if (!out_of_bound(x, y)) {
-			_colors[y * _width + x] = c;
-		}
-	}
-
-	wchar_t sprite::get_glyph(int x, int y) const
-	{
-		if (!out_of_bound(x, y)) {
-			return _glyphs[y * _width + x];
-		}
-		else {
-			return L' ';
-		}
-	}
-
-	short sprite::get_color(int x, int y) const
-	{
-		if (!out_of_bound(x, y)) {
-			return _colors[y * _width + x];
-		}
-		else {
-			return color_t::fg_black;
-		}
-	}
-
-	wchar_t sprite::sample_glyph(float x, float y) const
-	{
-		int sx = static_cast<int>(x * _width);
-		int sy = static_cast<int>(y * _height);
-		return get_glyph(sx, sy);
-	}
-
-	short sprite::sample_color(float x, float y) const
-	{
-		int sx = static_cast<int>(x * _width);
-		int sy = static_cast<int>(y * _height);
-		return get_color(sx, sy);
-	}
-
-	bool sprite::out_of_bound(int x, int y) const
-	{
-		return x < 0 || x >= _width || y < 0 || y >= _height;
-	}
-
-
-	//
-	// cmd_engine class
-	//
-	std::atomic<bool> cmd_engine::_active{ false };
-	std::condition_variable cmd_engine::_gamethread_ended_cv;
-	std::mutex cmd_engine::_gamethread_mutex;
-
-	cmd_engine::~cmd_engine()
-	{
-		OutputDebugString(L"~cmd_engine()\n");
-		close();
-	}
-
-	void cmd_engine::close()
-	{
-		OutputDebugString(L"close()\n");
-		// TODO: sound clean up
-
-		if (_console != INVALID_HANDLE_VALUE) {
-            if (_orig_console != INVALID_HANDLE_VALUE) {
-                SetConsoleActiveScreenBuffer(_orig_console);
-            }
-			CloseHandle(_console);
-			_console = INVALID_HANDLE_VALUE;
-		}
-	}
-
-	bool cmd_engine::console_close_handler(DWORD ctrl_type)
-	{
-		// handles notifications from windows similar to windows app
-		// we're only interested in the event when user closes the console window
-		if (ctrl_type == CTRL_CLOSE_EVENT) {
-			OutputDebugString(L"console_close_handler() begin\n");
-			// init shutdown sequence
-			_active = false;
-
-			// wait for game thread to be exited (to a max of 15 sec)
-			unique_lock<mutex> lk(_gamethread_mutex);
-			_gamethread_ended_cv.wait(lk);
-			OutputDebugString(L"console_close_handler() end\n");
-		}
-		// return true marks the event as processed so events like Ctrl-C won't kill our game.
-		return true;
-	}
-
-	void cmd_engine::construct_console(int w, int h, int fontw, int fonth)
-	{
-		_width = w;
-		_height = h;
-		_rect = { 0, 0, (short)w - 1, (short)h - 1 };
-
-		_stdin = GetStdHandle(STD_INPUT_HANDLE);
-		_orig_console = GetStdHandle(STD_OUTPUT_HANDLE);
-		_console = CreateConsoleScreenBuffer(GENERIC_WRITE | GENERIC_READ, 0, nullptr, CONSOLE_TEXTMODE_BUFFER, nullptr);
-		try {
-			if (_console == INVALID_HANDLE_VALUE) {
-				throw olc_exception(format_error(L"CreateConsoleScreenBuffer"));
-			}
-
-			//
-			// Screen buffer must be >= windows size.
-			// Shrink window to minimal size so that we can freely set the screen buffer size.
-			// After we resize screen buffer, we can resize window.
-			//
-
-			// make the new console active first. Or changing font size have no effect.
-			bool b = SetConsoleActiveScreenBuffer(_console);
-			if (!b) {
-				throw olc_exception(L"SetConsoleActiveScreenBuffer");
-			}
-
-			// Update fonts first so that it correctly determine windows size.
-			CONSOLE_FONT_INFOEX font_info{ sizeof(CONSOLE_FONT_INFOEX) };
-			font_info.nFont = 0;
-			font_info.dwFontSize = { (short)fontw, (short)fonth };
-			font_info.FontFamily = FF_DONTCARE;
-			font_info.FontWeight = FW_NORMAL;
-			wcscpy_s(font_info.FaceName, sizeof(font_info.FaceName) / sizeof(font_info.FaceName[0]), L"Consolas");
-			b = SetCurrentConsoleFontEx(_console, false, &font_info);
-			if (!b) {
-				throw olc_exception(L"SetCurrentConsoleFontEx");
-			}
-
-			// minimize window
-			SMALL_RECT minrect = { (short)0, (short)0, (short)1, (short)1 };
-			b = SetConsoleWindowInfo(_console, true, &minrect);
-			if (!b) {
-				throw olc_exception(L"SetConsoleWindowInfo when minimize window");
-			}
-
-			// set screen buffer size
-			b = SetConsoleScreenBufferSize(_console, { (short)w, (short)h });
-			if (!b) {
-				throw olc_exception(L"SetConsoleScreenBufferSize");
-			}
-
-			// check max allowed window size. throw if exceeded
-			CONSOLE_SCREEN_BUFFER_INFO info;
-			b = GetConsoleScreenBufferInfo(_console, &info);
-			if (!b) {
-				throw olc_exception(L"GetConsoleScreenBufferInfo");
-			}
-			if (w > info.dwMaximumWindowSize.X) {
-				throw olc_exception(L"Screen width / font width too big. Allowed max width="s + to_wstring(info.dwMaximumWindowSize.X));
-			}
-			if (h > info.dwMaximumWindowSize.Y) {
-				throw olc_exception(L"Screen height / font height too big. Allowed max height="s + to_wstring(info.dwMaximumWindowSize.Y));
-			}
-
-			// set console window size
-			b = SetConsoleWindowInfo(_console, true, &_rect);
-			if (!b) {
-				throw olc_exception(L"SetConsoleWindowInfo");
-			}
-
-			// set console mode to allow mouse input
-			b = SetConsoleMode(_stdin, ENABLE_EXTENDED_FLAGS | ENABLE_WINDOW_INPUT | ENABLE_MOUSE_INPUT);
-			if (!b) {
-				throw olc_exception(L"SetConsoleMode");
-			}
-
-			// allocate memory for screen buffer
-			_screen_buf.resize(w * h, { 0,0 });
-
-			// set console event handler
-			SetConsoleCtrlHandler((PHANDLER_ROUTINE) console_close_handler, true);
-		}
-		catch (std::exception&) {
-			close();
-			throw;
-		}
-	}
-
-	void cmd_engine::start()
-	{
-		_active = true;
-		auto t = thread(&cmd_engine::gamethread, this);
-		t.join();
-	}
-
-	void cmd_engine::gamethread()
-	{
-		constexpr short keydown = 0x8000;
-
-		// init user resources
-		if (!on_user_init()) {
-			_active = false;
-		}
-
-
-		// TODO: sound
-
-		// init time
-		auto prev_time = chrono::system_clock::now();
-		auto curr_time = chrono::system_clock::now();
-
-		while (_active) {
-			//
-			// handle timing
-			//
-			curr_time = chrono::system_clock::now();
-			float elapsed = chrono::duration<float>(curr_time - prev_time).count();
-			prev_time = curr_time;
-
-			//
-			// handle input
-			//
-
-			// keyboard
-			for (int i = 0; i < g_num_keys; ++i) {
-				_key_new_state[i] = GetAsyncKeyState(i);
-
-				// pressed is only true if the key changes from not down to down
-				// released is only true if the key changes from down to not down
-				_keys[i].pressed = false;
-				_keys[i].released = false;
-
-				if (_key_new_state[i] != _key_old_state[i]) {
-					// 0x8000 is key down
-					if (_key_new_state[i] & keydown) {
-						_keys[i].pressed = !_keys[i].held;
-						_keys[i].held = true;
-						//OutputDebugString(boost::str(boost::wformat(L"key %1% pressed\n") % i).c_str());
-					}
-					else {
-						_keys[i].released = true;
-						_keys[i].held = false;
-						//OutputDebugString(boost::str(boost::wformat(L"key %1% released\n") % i).c_str());
-					}
-				}
-				_key_old_state[i] = _key_new_state[i];
-			}
-
-			// mouse
-			array<INPUT_RECORD, 32> inevents;
-			DWORD nevents;
-			GetNumberOfConsoleInputEvents(_stdin, &nevents);
-			if (nevents > 0) {
-				ReadConsoleInput(_stdin, inevents.data(), inevents.size(), &nevents);
-			}
-			for (DWORD i = 0; i < nevents; ++i) {
-				switch (inevents[i].EventType) {
-				case FOCUS_EVENT:
-				{
-					_in_focus = inevents[i].Event.FocusEvent.bSetFocus;
-					OutputDebugString(boost::str(boost::wformat(L"In focus = %1%\n") % _in_focus).c_str());
-					break;
-				}
-				case MOUSE_EVENT:
-				{
-					const auto& mouseevent = inevents[i].Event.MouseEvent;
-					switch (mouseevent.dwEventFlags) {
-					case 0:		// button is clicked
-					{
-						for (int m = 0; m < g_num_mouse_buttons; ++m) {
-							_mouse_new_state[m] = (mouseevent.dwButtonState & (1 << m)) > 0;
-						}
-						break;
-					}
-					case MOUSE_MOVED:
-					{
-						_mousex = mouseevent.dwMousePosition.X;
-						_mousey = mouseevent.dwMousePosition.Y;
-						//OutputDebugString(boost::str(boost::wformat(L"mouse (%1%, %2%)\n") % _mousex % _mousey).c_str());
-						break;
-					}
-					default:
-						break;
-					}
-					break;
-				}
-				default:
-					break;
-				}
-			}
-			for (int m = 0; m < g_num_mouse_buttons; ++m) {
-				_mouse[m].pressed = false;
-				_mouse[m].released = false;
-
-				if (_mouse_new_state[m] != _mouse_old_state[m]) {
-					if (_mouse_new_state[m]) {
-						_mouse[m].pressed = !_mouse[m].held;
-						_mouse[m].held = true;
-						//OutputDebugString(boost::str(boost::wformat(L"mouse %1% pressed\n") % m).c_str());
-					}
-					else {
-						_mouse[m].released = true;
-						_mouse[m].held = false;
-						//OutputDebugString(boost::str(boost::wformat(L"mouse %1% released\n") % m).c_str());
-					}
-				}
-
-				_mouse_old_state[m] = _mouse_new_state[m];
-			}
-
-			//
-			// handle update
-			//
-			if (!on_user_update(elapsed)) {
-				_active = false;
-			}
-
-			//
-			// present screen buffer
-			//
-			auto title = boost::str(boost::wformat(L"OLC - Console Game Engine - %1% - FPS: %2$+3.2f") % _app_name % (1.0f / elapsed));
-			SetConsoleTitle(title.c_str());
-			WriteConsoleOutput(_console, _screen_buf.data(), { (short)_width, (short)_height }, { 0, 0 }, &_rect);
-		}
-
-		// clean up
-		on_user_destroy();
-		close();
-		// notify the gamethread ends
-		_gamethread_ended_cv.notify_all();
-	}
-
-	//
-	// Draw methods
-	//
-	void cmd_engine::draw(int x, int y, wchar_t c, short color)
-	{
-		if (out_of_bound(x, y)) {
-			return;
-		}
-		draw_no_bound_check(x, y, c, color);
-	}
-
-	void cmd_engine::draw_no_bound_check(int x, int y, wchar_t c, short color)
-	{
-		_screen_buf[screen_index(x, y)].Char.UnicodeChar = c;
-		_screen_buf[screen_index(x, y)].Attributes = color;
-	}
-
-	// x2, y2, is inclusive
-	void cmd_engine::fill(int x1, int y1, int x2, int y2, wchar_t c, short color)
-	{
-		clip(x1, y1);
-		clip(x2, y2);
-		for (auto x = x1; x <= x2; ++x) {
-			for (auto y = y1; y < y2; ++y) {
-				draw_no_bound_check(x, y, c, color);
-			}
-		}
-	}
-
-	void cmd_engine::draw_string(int x, int y, const std::wstring& s, short color)
-	{
-		if (out_of_bound(x, y)) {
-			return;
-		}
-		if (out_of_bound(x + s.length(), y)) {
-			return;
-		}
-		for (auto i = 0; i < s.length(); ++i) {
-			draw_no_bound_check(x + i, y, s[i]);
-		}
-	}
-
-	void cmd_engine::draw_string_alpha(int x, int y, const std::wstring& s, short color)
-	{
-		if (out_of_bound(x, y)) {
-			return;
-		}
-		if (out_of_bound(x + s.length(), y)) {
-			return;
-		}
-		for (auto i = 0; i < s.length(); ++i) {
-			auto c = s[i];
-			if (!iswblank(c)) {
-				draw_no_bound_check(x + i, y, c);
-			}
-		}
-	}
-
-	// x, y are inclusive
-	// Bresenham's line algorithm
-	// https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm for integer arithmetic
-	void cmd_engine::draw_line(int x1, int y1, int x2, int y2, wchar_t c, short color)
-	{
-		int x, y, dx, dy, dx_abs, dy_abs, Dx, Dy, xe, ye;
-		dx = x2 - x1;
-		dy = y2 - y1;
-		dx_abs = abs(dx);
-		dy_abs = abs(dy);
-		Dx = 2 * dy_abs - dx_abs;
-		Dy = 2 * dx_abs - dy_abs;
-		if (dy_abs <= dx_abs) {
-			// horizontal-ish line
-			if (dx >= 0) {
-				x = x1; y = y1; xe = x2;
-			}
-			else {
-				x = x2; y = y2; xe = x1;
-			}
-			draw(x, y, c, color);
-			for (x = x + 1; x <= xe; ++x) {
-				if (Dx >= 0) {
-					// y has gone from middle of a pixel to the edge of the next one
-					y += (dx < 0 && dy < 0 || dx > 0 && dy > 0) ? 1 : -1;
-					Dx -= 2 * dx_abs;
-				}
-				Dx += 2 * dy_abs;
-				draw(x, y, c, color);
-			}
-		}
-		else
-		{
-			// verical-ish line
-			if (dy >= 0) {
-				x = x1; y = y1; ye = y2;
-			}
-			else {
-				x = x2; y = y2; ye = y1;
-			}
-			draw(x, y, c, color);
-			for (y = y + 1; y <= ye; ++y) {
-				if (Dy >= 0) {
-					// x has gone from middle of a pixel to the edge of the next one
-					x += (dx < 0 && dy < 0 || dx > 0 && dy > 0) ? 1 : -1;
-					Dy -= 2 * dy_abs;
-				}
-				Dy += 2 * dx_abs;
-				draw(x, y, c, color);
-			}
-		}
-	}
-
-	void cmd_engine::draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, wchar_t c, short color)
-	{
-		draw_line(x1, y1, x2, y2, c, color);
-		draw_line(x1, y1, x3, y3, c, color);
-		draw_line(x2, y2, x3, y3, c, color);
-	}
-
-	// Bresenhams circle drawing algorithm
-	// https://www.geeksforgeeks.org/bresenhams-circle-drawing-algorithm/
-	void cmd_engine::draw_circle(int xc, int yc, int r, wchar_t c, short color)
-	{
-		if (r <= 0) {
-			return;
-		}
-		int x = 0, y = r;
-		int d = 3 - 2 * r;
-		// loop through 1/8 of a circle
-		while (y >= x) {
-			draw(xc + x, yc + y, c, color);
-			draw(xc + x, yc - y, c, color);
-			draw(xc - x, yc + y, c, color);
-			draw(xc - x, yc - y, c, color);
-			draw(xc + y, yc + x, c, color);
-			draw(xc + y, yc - x, c, color);
-			draw(xc - y, yc + x, c, color);
-			draw(xc - y, yc - x, c, color);
-			if (d < 0) {
-				d += 4 * x++ + 6;
-			}
-			else {
-				d += 4 * (x++ - y--) + 10;
-			}
-		}
-	}
-
-	void cmd_engine::fill_circle(int xc, int yc, int r, wchar_t c, short color)
-	{
-		if (r <= 0) {
-			return;
-		}
-		int x = 0, y = r;
-		int d = 3 - 2 * r;
-
-		auto draw_scanline = [this, c, color](int sx, int sy, int ex) {
-			for (int x = sx; x <= ex; ++x) {
-				draw(x, sy, c, color);
-			}
-		};
-
-		// loop through 1/8 of a circle
-		while (y >= x) {
-			// modified to draw scan lines instead
-			draw_scanline(xc - x, yc + y, xc + x);
-			draw_scanline(xc - x, yc - y, xc + x);
-			draw_scanline(xc - y, yc + x, xc + y);
-			draw_scanline(xc - y, yc - x, xc + y);
-			if (d < 0) {
-				d += 4 * x++ + 6;
-			}
-			else {
-				d += 4 * (x++ - y--) + 10;
-			}
-		}
-	}
-
-	void cmd_engine::draw_sprite(int x, int y, const sprite& sprite)
-	{
-		for (int i = 0; i < sprite.width(); ++i) {
-			if (x + i >= _width) {
-				break;
-			}
-			for (int j = 0; j < sprite.height(); ++j) {
-				if (y + j >= _height) {
-					break;
-				}
-				wchar_t glyph = sprite.get_glyph(i, j);
-				if (glyph != L' ') {
-					draw(x + i, y + j, glyph, sprite.get_color(i, j));
-				}
-			}
-		}
-	}
-
-	// Draws part of the sprite
-	void cmd_engine::draw_partial_sprite(int x, int y, const sprite& sprite, int sx, int sy, int w, int h)
-	{
-		assert("assert: sprite.width() > sx + w" && sprite.width() > sx + w);
-		assert("assert: (sprite.height() > sy + h" && sprite.height() > sy + h);
-		for (int i = 0; i < w; ++i) {
-			if (x + i >= _width) {
-				break;
-			}
-			for (int j = 0; j < h; ++j) {
-				if (y + j >= _height) {
-					break;
-				}
-				wchar_t glyph = sprite.get_glyph(sx + i, sy + j);
-				if (glyph != L' ') {
-					draw(x + i, y + j, glyph, sprite.get_color(sx + i, sy + j));
-				}
-			}
-		}
-	}
-
-    // r is rotation of the model, rotation is base on (0,0) of the model; s is scale
-    void cmd_engine::draw_wire_polygon(const std::vector<std::pair<float, float>>& model, float x, float y, float r, float s,
-        wchar_t c, short color)
-    {
-        // rotate -> scale -> translate -> draw
-        auto transformed{ model };
-        for (auto &vert : transformed) {
-            // rotate
-            // note the rotation equation is diff from typical math book as our y-axis is inverted
-            auto xr = vert.first * cosf(r) - vert.second * sinf(r);
-            auto yr = -vert.first * sinf(r) - vert.second * cosf(r);
-            vert.first = xr;
-            vert.second = yr;
-            // scale
-            vert.first *= s;
-            vert.second *= s;
-            // translate
-            vert.first += x;
-            vert.second += y;
-        }
-
-        // draw closed polygon
-        size_t nverts = model.size();
-        for (size_t i = 0; i < nverts; ++i) {
-            auto j = i + 1;
-            draw_line((int)transformed[i % nverts].first, (int)transformed[i % nverts].second,
-                (int)transformed[j % nverts].first, (int)transformed[j % nverts].second, c, color);
-        }
-    }
-    
-    wstring cmd_engine::format_error(wstring_view msg) const
-	{
-		array<wchar_t, 256> buf;
-		FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, nullptr, GetLastError(), MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), buf.data(), static_cast<DWORD>(buf.size()), nullptr);
-		wstring s(L"ERROR: ");
-		s.append(msg).append(L"\n\t").append(buf.data());
-		return s;
-	}
+#include "cmd_engine.h"
+#include "spectator.h"
+#include "job_system.h"
+#include "script.h"
+#include "audio.h"
+#include "alloc_tracker.h"
+#include "trace.h"
+#include <array>
+#include <stdexcept>
+#include <thread>
+#include <iostream>
+#include <boost/format.hpp>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+
+
+using namespace std;
+
+namespace olc {
+	//
+	// Utility functions
+	//
+	void pause()
+	{
+		cout << "Press enter to quit";
+		cin.ignore();
+	}
+
+	//
+	// sprite class
+	//
+	sprite::sprite(int w, int h)
+	{
+		create(w, h);
+	}
+
+	sprite::sprite(const std::wstring& file)
+	{
+		if (!load(file)) {
+			create(8, 8);
+		}
+	}
+
+	void sprite::create(int w, int h)
+	{
+		_width = w;
+		_height = h;
+		_glyphs.resize(w * h, L' ');
+		_colors.resize(w * h, color_t::fg_black);
+	}
+
+	bool sprite::save(const std::wstring& file) const
+	{
+		FILE* f{ nullptr };
+		_wfopen_s(&f, file.c_str(), L"wb");
+		if (!f) {
+			return false;
+		}
+
+		fwrite(&_width, sizeof(_width), 1, f);
+		fwrite(&_height, sizeof(_height), 1, f);
+		fwrite(_glyphs.data(), sizeof(wchar_t), _width * _height, f);
+		fwrite(_colors.data(), sizeof(color_t::enum_t), _width * _height, f);
+
+		fclose(f);
+		return true;
+	}
+
+    bool sprite::load(const std::wstring& file)
+    {
+        _width = 0;
+        _height = 0;
+        _glyphs.clear();
+        _colors.clear();
+
+        FILE* f{ nullptr };
+        _wfopen_s(&f, file.c_str(), L"rb");
+        if (!f) {
+            return false;
+        }
+
+        fread(&_width, sizeof(_width), 1, f);
+        fread(&_height, sizeof(_height), 1, f);
+        create(_width, _height);
+        fread(_glyphs.data(), sizeof(wchar_t), _width * _height, f);
+        fread(_colors.data(), sizeof(color_t::enum_t), _width * _height, f);
+
+        fclose(f);
+        return true;
+    }
+
+    bool sprite::load_from_resource(uint32_t id)
+    {
+        // RT_RCDATA is resource type raw cdata.
+        HRSRC resinfo = FindResource(nullptr, MAKEINTRESOURCE(id), RT_RCDATA);
+        if (!resinfo) {
+            return false;
+        }
+        HGLOBAL res = LoadResource(nullptr, resinfo);
+        if (!res) {
+            return false;
+        }
+        char *res_data = (char*)LockResource(res);
+        DWORD res_size = SizeofResource(nullptr, resinfo);
+
+        _width = 0;
+        _height = 0;
+        _glyphs.clear();
+        _colors.clear();
+
+        int *res_dimension = reinterpret_cast<int*>(res_data);
+        std::copy_n(res_dimension, 1, &_width);
+        std::copy_n(res_dimension + 1, 1, &_height);
+        create(_width, _height);
+        wchar_t *res_glyphs = reinterpret_cast<wchar_t*>(res_data + sizeof(int) * 2);
+        std::copy_n(res_glyphs, _width * _height, _glyphs.begin());
+        short *res_color = reinterpret_cast<short*>(res_glyphs + _width * _height);
+        std::copy_n(res_color, _width * _height, _colors.begin());
+
+        return true;
+    }
+
+	void sprite::set_glyph(int x, int y, wchar_t c)
+	{
+		if (!out_of_bound(x, y)) {
+			_glyphs[y * _width + x] = c;
+		}
+	}
+
+	void sprite::set_color(int x, int y, short c)
+	{
+		if (!out_of_bound(x, y)) {
+			_colors[y * _width + x] = c;
+		}
+	}
+
+	wchar_t sprite::get_glyph(int x, int y) const
+	{
+		if (!out_of_bound(x, y)) {
+			return _glyphs[y * _width + x];
+		}
+		else {
+			return L' ';
+		}
+	}
+
+	short sprite::get_color(int x, int y) const
+	{
+		if (!out_of_bound(x, y)) {
+			return _colors[y * _width + x];
+		}
+		else {
+			return color_t::fg_black;
+		}
+	}
+
+	wchar_t sprite::sample_glyph(float x, float y) const
+	{
+		int sx = static_cast<int>(x * _width);
+		int sy = static_cast<int>(y * _height);
+		return get_glyph(sx, sy);
+	}
+
+	short sprite::sample_color(float x, float y) const
+	{
+		int sx = static_cast<int>(x * _width);
+		int sy = static_cast<int>(y * _height);
+		return get_color(sx, sy);
+	}
+
+	bool sprite::out_of_bound(int x, int y) const
+	{
+		return x < 0 || x >= _width || y < 0 || y >= _height;
+	}
+
+
+	//
+	// cmd_engine class
+	//
+	namespace
+	{
+		// engines owning a console, to be shut down when the console window is closed
+		mutex g_console_engines_mutex;
+		vector<cmd_engine*> g_console_engines;
+		bool g_ctrl_handler_installed{ false };
+
+		// row hash that forces a present, as no real row is expected to hash to it
+		constexpr uint64_t g_no_hash = ~0ull;
+
+		// multiply-xorshift over the raw cells, 8 bytes at a time
+		uint64_t hash_row(const CHAR_INFO* row, int n)
+		{
+			const auto* p = reinterpret_cast<const unsigned char*>(row);
+			size_t bytes = n * sizeof(CHAR_INFO);
+			uint64_t h = 0x9e3779b97f4a7c15ull ^ bytes;
+			size_t i = 0;
+			for (; i + 8 <= bytes; i += 8) {
+				uint64_t v;
+				memcpy(&v, p + i, sizeof(v));
+				h = (h ^ v) * 0xff51afd7ed558ccdull;
+				h ^= h >> 32;
+			}
+			for (; i < bytes; ++i) {
+				h = (h ^ p[i]) * 0x100000001b3ull;
+			}
+			return h;
+		}
+	}
+
+	cmd_engine::cmd_engine() = default;
+
+	cmd_engine::~cmd_engine()
+	{
+		OutputDebugString(L"~cmd_engine()\n");
+		close();
+		unregister_console_engine(this);
+	}
+
+	void cmd_engine::close()
+	{
+		OutputDebugString(L"close()\n");
+		// stops the mixer thread, or finishes the file of a wav_sink
+		_audio.reset();
+		_spectators.reset();
+
+		if (_console != INVALID_HANDLE_VALUE) {
+            if (_orig_console != INVALID_HANDLE_VALUE) {
+                SetConsoleActiveScreenBuffer(_orig_console);
+            }
+			CloseHandle(_console);
+			_console = INVALID_HANDLE_VALUE;
+		}
+	}
+
+	bool cmd_engine::console_close_handler(DWORD ctrl_type)
+	{
+		// handles notifications from windows similar to windows app
+		// we're only interested in the event when user closes the console window
+		if (ctrl_type == CTRL_CLOSE_EVENT) {
+			OutputDebugString(L"console_close_handler() begin\n");
+			lock_guard<mutex> lk(g_console_engines_mutex);
+			// init shutdown sequence
+			for (auto engine : g_console_engines) {
+				engine->_active = false;
+			}
+
+			// wait for game threads to be exited (to a max of 15 sec)
+			for (auto engine : g_console_engines) {
+				unique_lock<mutex> gamethread_lk(engine->_gamethread_mutex);
+				engine->_gamethread_ended_cv.wait(gamethread_lk, [engine] { return engine->_gamethread_ended; });
+			}
+			OutputDebugString(L"console_close_handler() end\n");
+		}
+		// return true marks the event as processed so events like Ctrl-C won't kill our game.
+		return true;
+	}
+
+	void cmd_engine::register_console_engine(cmd_engine* engine)
+	{
+		lock_guard<mutex> lk(g_console_engines_mutex);
+		if (!g_ctrl_handler_installed) {
+			SetConsoleCtrlHandler((PHANDLER_ROUTINE)console_close_handler, true);
+			g_ctrl_handler_installed = true;
+		}
+		g_console_engines.push_back(engine);
+	}
+
+	void cmd_engine::unregister_console_engine(cmd_engine* engine)
+	{
+		lock_guard<mutex> lk(g_console_engines_mutex);
+		g_console_engines.erase(remove(g_console_engines.begin(), g_console_engines.end(), engine), g_console_engines.end());
+	}
+
+	void cmd_engine::construct_console(int w, int h, int fontw, int fonth)
+	{
+		_width = w;
+		_height = h;
+		_rect = { 0, 0, (short)w - 1, (short)h - 1 };
+
+		_stdin = GetStdHandle(STD_INPUT_HANDLE);
+		_orig_console = GetStdHandle(STD_OUTPUT_HANDLE);
+		_console = CreateConsoleScreenBuffer(GENERIC_WRITE | GENERIC_READ, 0, nullptr, CONSOLE_TEXTMODE_BUFFER, nullptr);
+		try {
+			if (_console == INVALID_HANDLE_VALUE) {
+				throw olc_exception(format_error(L"CreateConsoleScreenBuffer"));
+			}
+
+			//
+			// Screen buffer must be >= windows size.
+			// Shrink window to minimal size so that we can freely set the screen buffer size.
+			// After we resize screen buffer, we can resize window.
+			//
+
+			// make the new console active first. Or changing font size have no effect.
+			bool b = SetConsoleActiveScreenBuffer(_console);
+			if (!b) {
+				throw olc_exception(L"SetConsoleActiveScreenBuffer");
+			}
+
+			// Update fonts first so that it correctly determine windows size.
+			CONSOLE_FONT_INFOEX font_info{ sizeof(CONSOLE_FONT_INFOEX) };
+			font_info.nFont = 0;
+			font_info.dwFontSize = { (short)fontw, (short)fonth };
+			font_info.FontFamily = FF_DONTCARE;
+			font_info.FontWeight = FW_NORMAL;
+			wcscpy_s(font_info.FaceName, sizeof(font_info.FaceName) / sizeof(font_info.FaceName[0]), L"Consolas");
+			b = SetCurrentConsoleFontEx(_console, false, &font_info);
+			if (!b) {
+				throw olc_exception(L"SetCurrentConsoleFontEx");
+			}
+
+			// minimize window
+			SMALL_RECT minrect = { (short)0, (short)0, (short)1, (short)1 };
+			b = SetConsoleWindowInfo(_console, true, &minrect);
+			if (!b) {
+				throw olc_exception(L"SetConsoleWindowInfo when minimize window");
+			}
+
+			// set screen buffer size
+			b = SetConsoleScreenBufferSize(_console, { (short)w, (short)h });
+			if (!b) {
+				throw olc_exception(L"SetConsoleScreenBufferSize");
+			}
+
+			// check max allowed window size. throw if exceeded
+			CONSOLE_SCREEN_BUFFER_INFO info;
+			b = GetConsoleScreenBufferInfo(_console, &info);
+			if (!b) {
+				throw olc_exception(L"GetConsoleScreenBufferInfo");
+			}
+			if (_resizable) {
+				if (_screen_attached) {
+					throw olc_exception(L"Resizable console with an attached screen");
+				}
+				// reserve for the biggest window the display fits at this font, clamp the requested size to it
+				COORD largest = GetLargestConsoleWindowSize(_console);
+				_max_width = max<int>(largest.X, 1);
+				_max_height = max<int>(largest.Y, 1);
+				_width = min(w, min<int>(_max_width, info.dwMaximumWindowSize.X));
+				_height = min(h, min<int>(_max_height, info.dwMaximumWindowSize.Y));
+				_rect = { 0, 0, (short)(_width - 1), (short)(_height - 1) };
+				b = SetConsoleScreenBufferSize(_console, { (short)_width, (short)_height });
+				if (!b) {
+					throw olc_exception(L"SetConsoleScreenBufferSize");
+				}
+			}
+			else {
+				if (w > info.dwMaximumWindowSize.X) {
+					throw olc_exception(L"Screen width / font width too big. Allowed max width="s + to_wstring(info.dwMaximumWindowSize.X));
+				}
+				if (h > info.dwMaximumWindowSize.Y) {
+					throw olc_exception(L"Screen height / font height too big. Allowed max height="s + to_wstring(info.dwMaximumWindowSize.Y));
+				}
+			}
+
+			// set console window size
+			b = SetConsoleWindowInfo(_console, true, &_rect);
+			if (!b) {
+				throw olc_exception(L"SetConsoleWindowInfo");
+			}
+
+			// set console mode to allow mouse input
+			b = SetConsoleMode(_stdin, ENABLE_EXTENDED_FLAGS | ENABLE_WINDOW_INPUT | ENABLE_MOUSE_INPUT);
+			if (!b) {
+				throw olc_exception(L"SetConsoleMode");
+			}
+
+			allocate_screen();
+
+			// set console event handler
+			register_console_engine(this);
+		}
+		catch (std::exception&) {
+			close();
+			throw;
+		}
+	}
+
+	void cmd_engine::enable_spectators(const std::string& socket_path)
+	{
+		_spectators = make_unique<spectator_server>(socket_path);
+	}
+
+	job_system& cmd_engine::jobs()
+	{
+		if (!_jobs) {
+			if (_job_workers >= 0) {
+				_jobs = make_unique<job_system>(static_cast<unsigned>(_job_workers));
+			}
+			else {
+				_jobs = _headless ? make_unique<job_system>(0) : make_unique<job_system>();
+			}
+		}
+		return *_jobs;
+	}
+
+	void cmd_engine::set_job_workers(unsigned nworkers)
+	{
+		if (_jobs) {
+			throw olc_exception(L"The job system already exists, set its workers before the first call to jobs()");
+		}
+		_job_workers = static_cast<int>(nworkers);
+	}
+
+	script_scheduler& cmd_engine::scripts()
+	{
+		if (!_scripts) {
+			_scripts = make_unique<script_scheduler>();
+		}
+		return *_scripts;
+	}
+
+	void cmd_engine::enable_audio(unique_ptr<audio_sink> sink)
+	{
+		_audio.reset();
+		_audio = make_unique<audio_mixer>(move(sink));
+	}
+
+	audio_mixer& cmd_engine::audio()
+	{
+		if (!_audio) {
+			unique_ptr<audio_sink> sink;
+			if (!_headless) {
+				try {
+					sink = make_unique<waveout_sink>();
+				}
+				catch (const olc_exception& e) {
+					OutputDebugString((wstring(e.msg()) + L", playing without sound\n").c_str());
+				}
+			}
+			if (!sink) {
+				sink = make_unique<null_sink>();
+			}
+			_audio = make_unique<audio_mixer>(move(sink));
+		}
+		return *_audio;
+	}
+
+	void cmd_engine::register_snapshot_state(void* data, size_t size)
+	{
+		_snapshot_regions.push_back({ data, size });
+	}
+
+	void cmd_engine::unregister_snapshot_state(void* data)
+	{
+		erase_if(_snapshot_regions, [data](const snapshot_region& r) { return r.data == data; });
+	}
+
+	//
+	// Blob layout: the header, then for each part it holds
+	//   input   the key and mouse arrays, mouse position and focus as they are in the engine
+	//   screen  width x height cells, row by row without the stride
+	//   state   every region's size as uint64_t followed by its bytes
+	//
+	void cmd_engine::save_snapshot(snapshot& s, uint32_t parts) const
+	{
+		OLC_TRACE_ZONE("save_snapshot");
+
+		size_t size = sizeof(snapshot::header);
+		if (parts & snapshot_part::input) {
+			size += sizeof(_keys) + sizeof(_key_old_state) + sizeof(_key_new_state) + sizeof(_mouse)
+				+ sizeof(_mouse_old_state) + sizeof(_mouse_new_state) + sizeof(_mousex) + sizeof(_mousey) + sizeof(_in_focus);
+		}
+		if (parts & snapshot_part::screen) {
+			size += sizeof(CHAR_INFO) * _width * _height;
+		}
+		if (parts & snapshot_part::state) {
+			for (const auto& r : _snapshot_regions) {
+				size += sizeof(uint64_t) + r.size;
+			}
+		}
+		// same size as last time, which is the usual case, doesn't reallocate
+		s._data.resize(size);
+		++s._revision;
+
+		auto out = s._data.data();
+		auto put = [&out](const void* p, size_t n) {
+			memcpy(out, p, n);
+			out += n;
+		};
+		snapshot::header h{ snapshot::g_magic, snapshot::g_version, parts, _width, _height,
+			static_cast<uint32_t>(_snapshot_regions.size()), _frame_count };
+		put(&h, sizeof(h));
+		if (parts & snapshot_part::input) {
+			put(&_keys, sizeof(_keys));
+			put(&_key_old_state, sizeof(_key_old_state));
+			put(&_key_new_state, sizeof(_key_new_state));
+			put(&_mouse, sizeof(_mouse));
+			put(&_mouse_old_state, sizeof(_mouse_old_state));
+			put(&_mouse_new_state, sizeof(_mouse_new_state));
+			put(&_mousex, sizeof(_mousex));
+			put(&_mousey, sizeof(_mousey));
+			put(&_in_focus, sizeof(_in_focus));
+		}
+		if (parts & snapshot_part::screen) {
+			for (int y = 0; y < _height; ++y) {
+				put(_screen + y * _stride, sizeof(CHAR_INFO) * _width);
+			}
+		}
+		if (parts & snapshot_part::state) {
+			for (const auto& r : _snapshot_regions) {
+				uint64_t n = r.size;
+				put(&n, sizeof(n));
+				put(r.data, r.size);
+			}
+		}
+	}
+
+	bool cmd_engine::restore_snapshot(const snapshot& s)
+	{
+		OLC_TRACE_ZONE("restore_snapshot");
+
+		const auto& data = s.data();
+		if (data.size() < sizeof(snapshot::header)) {
+			return false;
+		}
+		snapshot::header h;
+		memcpy(&h, data.data(), sizeof(h));
+		if (h.magic != snapshot::g_magic || h.version != snapshot::g_version) {
+			return false;
+		}
+		if ((h.parts & snapshot_part::screen) && (h.width != _width || h.height != _height)) {
+			return false;
+		}
+
+		// check the regions match before anything is overwritten
+		auto in = data.data() + sizeof(h);
+		auto end = data.data() + data.size();
+		if (h.parts & snapshot_part::input) {
+			in += sizeof(_keys) + sizeof(_key_old_state) + sizeof(_key_new_state) + sizeof(_mouse)
+				+ sizeof(_mouse_old_state) + sizeof(_mouse_new_state) + sizeof(_mousex) + sizeof(_mousey) + sizeof(_in_focus);
+		}
+		if (h.parts & snapshot_part::screen) {
+			in += sizeof(CHAR_INFO) * _width * _height;
+		}
+		if (h.parts & snapshot_part::state) {
+			if (h.regions != _snapshot_regions.size()) {
+				return false;
+			}
+			for (const auto& r : _snapshot_regions) {
+				uint64_t n;
+				if (end - in < static_cast<ptrdiff_t>(sizeof(n))) {
+					return false;
+				}
+				memcpy(&n, in, sizeof(n));
+				if (n != r.size) {
+					return false;
+				}
+				in += sizeof(n) + n;
+			}
+		}
+		if (in != end) {
+			return false;
+		}
+
+		in = data.data() + sizeof(h);
+		auto get = [&in](void* p, size_t n) {
+			memcpy(p, in, n);
+			in += n;
+		};
+		if (h.parts & snapshot_part::input) {
+			get(&_keys, sizeof(_keys));
+			get(&_key_old_state, sizeof(_key_old_state));
+			get(&_key_new_state, sizeof(_key_new_state));
+			get(&_mouse, sizeof(_mouse));
+			get(&_mouse_old_state, sizeof(_mouse_old_state));
+			get(&_mouse_new_state, sizeof(_mouse_new_state));
+			get(&_mousex, sizeof(_mousex));
+			get(&_mousey, sizeof(_mousey));
+			get(&_in_focus, sizeof(_in_focus));
+			_frame_count = h.frame;
+		}
+		if (h.parts & snapshot_part::screen) {
+			for (int y = 0; y < _height; ++y) {
+				get(_screen + y * _stride, sizeof(CHAR_INFO) * _width);
+			}
+			// present compares the rows against what it last wrote
+			mark_rows_dirty(0, _height);
+		}
+		if (h.parts & snapshot_part::state) {
+			for (const auto& r : _snapshot_regions) {
+				in += sizeof(uint64_t);
+				get(r.data, r.size);
+			}
+		}
+		return true;
+	}
+
+	void cmd_engine::construct_headless(int w, int h)
+	{
+		_headless = true;
+		_width = w;
+		_height = h;
+		_rect = { 0, 0, (short)(w - 1), (short)(h - 1) };
+
+		allocate_screen();
+	}
+
+	void cmd_engine::attach_screen(CHAR_INFO* screen, int stride)
+	{
+		_screen = screen;
+		_stride = stride;
+		_screen_attached = true;
+	}
+
+	void cmd_engine::allocate_screen()
+	{
+		// an attached screen is owned and sized by the subclass
+		if (!_screen_attached) {
+			// a resizable screen keeps the stride of the largest size, so a resize only changes what's presented
+			_stride = max(_width, _max_width);
+			_screen_buf.resize(static_cast<size_t>(_stride) * max(_height, _max_height), { 0,0 });
+			_screen = _screen_buf.data();
+		}
+		_row_dirty.reserve(max(_height, _max_height));
+		_row_hash.reserve(max(_height, _max_height));
+		invalidate_screen();
+	}
+
+	void cmd_engine::invalidate_screen()
+	{
+		_row_dirty.assign(_height, 1);
+		_row_hash.assign(_height, g_no_hash);
+	}
+
+	void cmd_engine::start()
+	{
+		{
+			lock_guard<mutex> lk(_gamethread_mutex);
+			_gamethread_ended = false;
+		}
+		_active = true;
+		auto t = thread(&cmd_engine::gamethread, this);
+		t.join();
+	}
+
+	void cmd_engine::gamethread()
+	{
+		OLC_TRACE_THREAD_NAME("game");
+
+		// init user resources
+		begin();
+
+		// init time
+		auto prev_time = chrono::system_clock::now();
+		auto curr_time = chrono::system_clock::now();
+
+		while (_active) {
+			//
+			// handle timing
+			//
+			curr_time = chrono::system_clock::now();
+			float elapsed = chrono::duration<float>(curr_time - prev_time).count();
+			prev_time = curr_time;
+
+			step(elapsed);
+
+			if (_idle_tick.count() > 0 && !_last_frame_presented && _active) {
+				// nothing changed on screen, sleep until there is input or the tick is up
+				OLC_TRACE_ZONE("idle");
+				WaitForSingleObject(_stdin, static_cast<DWORD>(_idle_tick.count()));
+			}
+		}
+
+		// clean up
+		end();
+		// notify the gamethread ends
+		{
+			lock_guard<mutex> lk(_gamethread_mutex);
+			_gamethread_ended = true;
+		}
+		_gamethread_ended_cv.notify_all();
+	}
+
+	bool cmd_engine::begin()
+	{
+		// init user resources
+		if (!on_user_init()) {
+			_active = false;
+		}
+
+		return _active;
+	}
+
+	bool cmd_engine::step(float elapsed)
+	{
+		OLC_TRACE_ZONE("frame");
+
+		//
+		// handle input
+		//
+		if (!_headless) {
+			poll_input();
+		}
+
+		//
+		// handle update
+		//
+		auto allocs_before = alloc_tracker::thread_counters();
+		if (_scripts) {
+			OLC_TRACE_ZONE("scripts");
+			_scripts->tick(*this, elapsed);
+		}
+		{
+			OLC_TRACE_ZONE("on_user_update");
+			if (!on_user_update(elapsed)) {
+				_active = false;
+			}
+		}
+		if (alloc_tracker::enabled()) {
+			auto allocs = alloc_tracker::thread_counters();
+			if (allocs.count != allocs_before.count) {
+				// formatted on the stack, reporting mustn't allocate itself
+				wchar_t msg[128];
+				swprintf_s(msg, L"frame %llu: %llu heap allocations (%llu bytes) in scripts and on_user_update\n",
+					_frame_count, allocs.count - allocs_before.count, allocs.bytes - allocs_before.bytes);
+				OutputDebugString(msg);
+			}
+		}
+		if (_audio) {
+			// a no-op when the mixer runs on its own thread
+			OLC_TRACE_ZONE("audio");
+			_audio->advance(elapsed);
+		}
+
+		//
+		// present screen buffer
+		//
+		if (!_headless) {
+			present(elapsed);
+		}
+		if (_spectators) {
+			OLC_TRACE_ZONE("spectators");
+			_spectators->publish(_screen, _width, _height, _stride);
+		}
+
+		_frame_arena.reset();
+		++_frame_count;
+		return _active;
+	}
+
+	void cmd_engine::end()
+	{
+		if (alloc_tracker::enabled()) {
+			wchar_t msg[128];
+			swprintf_s(msg, L"frame arena peak: %zu of %zu bytes\n", _frame_arena.peak(), _frame_arena.capacity());
+			OutputDebugString(msg);
+		}
+		on_user_destroy();
+		close();
+	}
+
+	void cmd_engine::poll_input()
+	{
+		OLC_TRACE_ZONE("poll_input");
+		constexpr short keydown = 0x8000;
+
+		// keyboard
+		for (int i = 0; i < g_num_keys; ++i) {
+			_key_new_state[i] = GetAsyncKeyState(i);
+
+			// pressed is only true if the key changes from not down to down
+			// released is only true if the key changes from down to not down
+			_keys[i].pressed = false;
+			_keys[i].released = false;
+
+			if (_key_new_state[i] != _key_old_state[i]) {
+				// 0x8000 is key down
+				if (_key_new_state[i] & keydown) {
+					_keys[i].pressed = !_keys[i].held;
+					_keys[i].held = true;
+					//OutputDebugString(boost::str(boost::wformat(L"key %1% pressed\n") % i).c_str());
+				}
+				else {
+					_keys[i].released = true;
+					_keys[i].held = false;
+					//OutputDebugString(boost::str(boost::wformat(L"key %1% released\n") % i).c_str());
+				}
+			}
+			_key_old_state[i] = _key_new_state[i];
+		}
+
+		// mouse
+		array<INPUT_RECORD, 32> inevents;
+		DWORD nevents;
+		GetNumberOfConsoleInputEvents(_stdin, &nevents);
+		if (nevents > 0) {
+			ReadConsoleInput(_stdin, inevents.data(), inevents.size(), &nevents);
+		}
+		for (DWORD i = 0; i < nevents; ++i) {
+			switch (inevents[i].EventType) {
+			case WINDOW_BUFFER_SIZE_EVENT:
+			{
+				// coalesced, a drag sends a burst of these
+				_resize_pending = _resizable;
+				break;
+			}
+			case FOCUS_EVENT:
+			{
+				_in_focus = inevents[i].Event.FocusEvent.bSetFocus;
+				OutputDebugString(boost::str(boost::wformat(L"In focus = %1%\n") % _in_focus).c_str());
+				break;
+			}
+			case MOUSE_EVENT:
+			{
+				const auto& mouseevent = inevents[i].Event.MouseEvent;
+				switch (mouseevent.dwEventFlags) {
+				case 0:		// button is clicked
+				{
+					for (int m = 0; m < g_num_mouse_buttons; ++m) {
+						_mouse_new_state[m] = (mouseevent.dwButtonState & (1 << m)) > 0;
+					}
+					break;
+				}
+				case MOUSE_MOVED:
+				{
+					_mousex = mouseevent.dwMousePosition.X;
+					_mousey = mouseevent.dwMousePosition.Y;
+					//OutputDebugString(boost::str(boost::wformat(L"mouse (%1%, %2%)\n") % _mousex % _mousey).c_str());
+					break;
+				}
+				default:
+					break;
+				}
+				break;
+			}
+			default:
+				break;
+			}
+		}
+		for (int m = 0; m < g_num_mouse_buttons; ++m) {
+			_mouse[m].pressed = false;
+			_mouse[m].released = false;
+
+			if (_mouse_new_state[m] != _mouse_old_state[m]) {
+				if (_mouse_new_state[m]) {
+					_mouse[m].pressed = !_mouse[m].held;
+					_mouse[m].held = true;
+					//OutputDebugString(boost::str(boost::wformat(L"mouse %1% pressed\n") % m).c_str());
+				}
+				else {
+					_mouse[m].released = true;
+					_mouse[m].held = false;
+					//OutputDebugString(boost::str(boost::wformat(L"mouse %1% released\n") % m).c_str());
+				}
+			}
+
+			_mouse_old_state[m] = _mouse_new_state[m];
+		}
+
+		if (_resize_pending) {
+			resize_screen();
+		}
+	}
+
+	void cmd_engine::resize_screen()
+	{
+		_resize_pending = false;
+		CONSOLE_SCREEN_BUFFER_INFO info;
+		if (!GetConsoleScreenBufferInfo(_console, &info)) {
+			return;
+		}
+		// the visible window is what the user sized, the buffer follows it so there are no scroll bars
+		int w = clamp(info.srWindow.Right - info.srWindow.Left + 1, 1, _max_width);
+		int h = clamp(info.srWindow.Bottom - info.srWindow.Top + 1, 1, _max_height);
+		if (w == _width && h == _height) {
+			return;
+		}
+		apply_screen_size(w, h);
+	}
+
+	void cmd_engine::set_screen_size(int w, int h)
+	{
+		if (!_resizable) {
+			throw olc_exception(L"set_screen_size on a console that isn't resizable");
+		}
+		w = clamp(w, 1, _max_width);
+		h = clamp(h, 1, _max_height);
+		if (w == _width && h == _height) {
+			return;
+		}
+		// the window can't be bigger than the buffer, shrink it out of the way first as construct_console does
+		SMALL_RECT minrect = { (short)0, (short)0, (short)1, (short)1 };
+		SetConsoleWindowInfo(_console, true, &minrect);
+		apply_screen_size(w, h);
+		SetConsoleWindowInfo(_console, true, &_rect);
+	}
+
+	void cmd_engine::apply_screen_size(int w, int h)
+	{
+		SetConsoleScreenBufferSize(_console, { (short)w, (short)h });
+
+		_width = w;
+		_height = h;
+		_rect = { 0, 0, (short)(w - 1), (short)(h - 1) };
+		// cells outside the old size hold whatever was drawn before, start from blank
+		fill_n(_screen_buf.data(), _screen_buf.size(), CHAR_INFO{ 0,0 });
+		// within the capacity reserved by allocate_screen
+		invalidate_screen();
+
+		on_resize(w, h);
+	}
+
+	void cmd_engine::present(float elapsed)
+	{
+		OLC_TRACE_ZONE("present");
+
+		// only rows drawn to are rehashed, and only the span of rows that really changed is written
+		int first = _height;
+		int last = -1;
+		for (int y = 0; y < _height; ++y) {
+			if (!_row_dirty[y]) {
+				continue;
+			}
+			_row_dirty[y] = 0;
+			uint64_t h = hash_row(_screen + y * _stride, _width);
+			if (h != _row_hash[y]) {
+				_row_hash[y] = h;
+				first = min(first, y);
+				last = y;
+			}
+		}
+		_last_frame_presented = (last >= 0);
+		if (!_last_frame_presented) {
+			return;
+		}
+
+		// formatted into a member buffer, a boost::wformat here allocated every frame
+		swprintf_s(_title.data(), _title.size(), L"OLC - Console Game Engine - %ls - FPS: %+3.2f", _app_name.c_str(), 1.0f / elapsed);
+		SetConsoleTitle(_title.data());
+		// the buffer size is the full stride, only the changed rows of _rect are written
+		SMALL_RECT rect{ _rect.Left, (short)(_rect.Top + first), _rect.Right, (short)(_rect.Top + last) };
+		WriteConsoleOutput(_console, _screen, { (short)_stride, (short)_height }, { 0, (short)first }, &rect);
+	}
+
+	//
+	// Draw methods
+	//
+	void cmd_engine::draw(int x, int y, wchar_t c, short color)
+	{
+		if (out_of_bound(x, y)) {
+			return;
+		}
+		draw_no_bound_check(x, y, c, color);
+	}
+
+	void cmd_engine::draw_no_bound_check(int x, int y, wchar_t c, short color)
+	{
+		_screen[screen_index(x, y)].Char.UnicodeChar = c;
+		_screen[screen_index(x, y)].Attributes = color;
+		_row_dirty[y] = 1;
+	}
+
+	// x2, y2, is inclusive
+	void cmd_engine::fill(int x1, int y1, int x2, int y2, wchar_t c, short color)
+	{
+		OLC_TRACE_ZONE("fill");
+		clip(x1, y1);
+		clip(x2, y2);
+		for (auto x = x1; x <= x2; ++x) {
+			for (auto y = y1; y < y2; ++y) {
+				draw_no_bound_check(x, y, c, color);
+			}
+		}
+	}
+
+	void cmd_engine::draw_string(int x, int y, wstring_view s, short color)
+	{
+		if (out_of_bound(x, y)) {
+			return;
+		}
+		// the last cell, a string ending on the right edge still fits
+		if (out_of_bound(x + static_cast<int>(s.length()) - 1, y)) {
+			return;
+		}
+		for (auto i = 0; i < s.length(); ++i) {
+			draw_no_bound_check(x + i, y, s[i]);
+		}
+	}
+
+	void cmd_engine::draw_string_alpha(int x, int y, wstring_view s, short color)
+	{
+		if (out_of_bound(x, y)) {
+			return;
+		}
+		// the last cell, a string ending on the right edge still fits
+		if (out_of_bound(x + static_cast<int>(s.length()) - 1, y)) {
+			return;
+		}
+		for (auto i = 0; i < s.length(); ++i) {
+			auto c = s[i];
+			if (!iswblank(c)) {
+				draw_no_bound_check(x + i, y, c);
+			}
+		}
+	}
+
+	void cmd_engine::draw_cells(int x, int y, const CHAR_INFO* cells, int n)
+	{
+		if (y < 0 || y >= _height) {
+			return;
+		}
+		if (x < 0) {
+			cells -= x;
+			n += x;
+			x = 0;
+		}
+		n = min(n, _width - x);
+		if (n <= 0) {
+			return;
+		}
+		copy_n(cells, n, _screen + screen_index(x, y));
+		_row_dirty[y] = 1;
+	}
+
+	// x, y are inclusive
+	// Bresenham's line algorithm
+	// https://en.wikipedia.org/wiki/Bresenham%27s_line_algorithm for integer arithmetic
+	void cmd_engine::draw_line(int x1, int y1, int x2, int y2, wchar_t c, short color)
+	{
+		int x, y, dx, dy, dx_abs, dy_abs, Dx, Dy, xe, ye;
+		dx = x2 - x1;
+		dy = y2 - y1;
+		dx_abs = abs(dx);
+		dy_abs = abs(dy);
+		Dx = 2 * dy_abs - dx_abs;
+		Dy = 2 * dx_abs - dy_abs;
+		if (dy_abs <= dx_abs) {
+			// horizontal-ish line
+			if (dx >= 0) {
+				x = x1; y = y1; xe = x2;
+			}
+			else {
+				x = x2; y = y2; xe = x1;
+			}
+			draw(x, y, c, color);
+			for (x = x + 1; x <= xe; ++x) {
+				if (Dx >= 0) {
+					// y has gone from middle of a pixel to the edge of the next one
+					y += (dx < 0 && dy < 0 || dx > 0 && dy > 0) ? 1 : -1;
+					Dx -= 2 * dx_abs;
+				}
+				Dx += 2 * dy_abs;
+				draw(x, y, c, color);
+			}
+		}
+		else
+		{
+			// verical-ish line
+			if (dy >= 0) {
+				x = x1; y = y1; ye = y2;
+			}
+			else {
+				x = x2; y = y2; ye = y1;
+			}
+			draw(x, y, c, color);
+			for (y = y + 1; y <= ye; ++y) {
+				if (Dy >= 0) {
+					// x has gone from middle of a pixel to the edge of the next one
+					x += (dx < 0 && dy < 0 || dx > 0 && dy > 0) ? 1 : -1;
+					Dy -= 2 * dy_abs;
+				}
+				Dy += 2 * dx_abs;
+				draw(x, y, c, color);
+			}
+		}
+	}
+
+	void cmd_engine::draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, wchar_t c, short color)
+	{
+		OLC_TRACE_ZONE("draw_triangle");
+		draw_line(x1, y1, x2, y2, c, color);
+		draw_line(x1, y1, x3, y3, c, color);
+		draw_line(x2, y2, x3, y3, c, color);
+	}
+
+	// Bresenhams circle drawing algorithm
+	// https://www.geeksforgeeks.org/bresenhams-circle-drawing-algorithm/
+	void cmd_engine::draw_circle(int xc, int yc, int r, wchar_t c, short color)
+	{
+		OLC_TRACE_ZONE("draw_circle");
+		if (r <= 0) {
+			return;
+		}
+		int x = 0, y = r;
+		int d = 3 - 2 * r;
+		// loop through 1/8 of a circle
+		while (y >= x) {
+			draw(xc + x, yc + y, c, color);
+			draw(xc + x, yc - y, c, color);
+			draw(xc - x, yc + y, c, color);
+			draw(xc - x, yc - y, c, color);
+			draw(xc + y, yc + x, c, color);
+			draw(xc + y, yc - x, c, color);
+			draw(xc - y, yc + x, c, color);
+			draw(xc - y, yc - x, c, color);
+			if (d < 0) {
+				d += 4 * x++ + 6;
+			}
+			else {
+				d += 4 * (x++ - y--) + 10;
+			}
+		}
+	}
+
+	void cmd_engine::fill_circle(int xc, int yc, int r, wchar_t c, short color)
+	{
+		OLC_TRACE_ZONE("fill_circle");
+		if (r <= 0) {
+			return;
+		}
+		int x = 0, y = r;
+		int d = 3 - 2 * r;
+
+		auto draw_scanline = [this, c, color](int sx, int sy, int ex) {
+			for (int x = sx; x <= ex; ++x) {
+				draw(x, sy, c, color);
+			}
+		};
+
+		// loop through 1/8 of a circle
+		while (y >= x) {
+			// modified to draw scan lines instead
+			draw_scanline(xc - x, yc + y, xc + x);
+			draw_scanline(xc - x, yc - y, xc + x);
+			draw_scanline(xc - y, yc + x, xc + y);
+			draw_scanline(xc - y, yc - x, xc + y);
+			if (d < 0) {
+				d += 4 * x++ + 6;
+			}
+			else {
+				d += 4 * (x++ - y--) + 10;
+			}
+		}
+	}
+
+	void cmd_engine::draw_sprite(int x, int y, const sprite& sprite)
+	{
+		OLC_TRACE_ZONE("draw_sprite");
+		for (int i = 0; i < sprite.width(); ++i) {
+			if (x + i >= _width) {
+				break;
+			}
+			for (int j = 0; j < sprite.height(); ++j) {
+				if (y + j >= _height) {
+					break;
+				}
+				wchar_t glyph = sprite.get_glyph(i, j);
+				if (glyph != L' ') {
+					draw(x + i, y + j, glyph, sprite.get_color(i, j));
+				}
+			}
+		}
+	}
+
+	// Draws part of the sprite
+	void cmd_engine::draw_partial_sprite(int x, int y, const sprite& sprite, int sx, int sy, int w, int h)
+	{
+		OLC_TRACE_ZONE("draw_partial_sprite");
+		assert("assert: sprite.width() > sx + w" && sprite.width() > sx + w);
+		assert("assert: (sprite.height() > sy + h" && sprite.height() > sy + h);
+		for (int i = 0; i < w; ++i) {
+			if (x + i >= _width) {
+				break;
+			}
+			for (int j = 0; j < h; ++j) {
+				if (y + j >= _height) {
+					break;
+				}
+				wchar_t glyph = sprite.get_glyph(sx + i, sy + j);
+				if (glyph != L' ') {
+					draw(x + i, y + j, glyph, sprite.get_color(sx + i, sy + j));
+				}
+			}
+		}
+	}
+
+    // r is rotation of the model, rotation is base on (0,0) of the model; s is scale
+    void cmd_engine::draw_wire_polygon(const std::vector<std::pair<float, float>>& model, float x, float y, float r, float s,
+        wchar_t c, short color)
+    {
+        OLC_TRACE_ZONE("draw_wire_polygon");
+        // rotate -> scale -> translate -> draw
+        // vertices are transformed as the edges are walked, so the model isn't copied
+        float cos_r = cosf(r);
+        float sin_r = sinf(r);
+        auto transform = [=](const pair<float, float>& vert) {
+            // rotate
+            // note the rotation equation is diff from typical math book as our y-axis is inverted
+            auto xr = vert.first * cos_r - vert.second * sin_r;
+            auto yr = -vert.first * sin_r - vert.second * cos_r;
+            // scale, translate
+            return pair<float, float>(xr * s + x, yr * s + y);
+        };
+
+        // draw closed polygon
+        size_t nverts = model.size();
+        if (nverts == 0) {
+            return;
+        }
+        auto first = transform(model[0]);
+        auto prev = first;
+        for (size_t i = 1; i <= nverts; ++i) {
+            auto next = (i < nverts) ? transform(model[i]) : first;
+            draw_line((int)prev.first, (int)prev.second, (int)next.first, (int)next.second, c, color);
+            prev = next;
+        }
+    }
+    
+    void cmd_engine::draw_shader_impl(int x1, int y1, int x2, int y2, void* ctx, shader_row_fn shade_row)
+    {
+        OLC_TRACE_ZONE("draw_shader");
+        x1 = max(x1, 0);
+        y1 = max(y1, 0);
+        x2 = min(x2, _width - 1);
+        y2 = min(y2, _height - 1);
+        if (x1 > x2 || y1 > y2) {
+            return;
+        }
+        // enough rows per job to be worth handing out, a few thousand cells
+        int rows_per_job = max(1, 4096 / (x2 - x1 + 1));
+        auto shade_rows = [&](int begin, int end) {
+            for (int y = begin; y < end; ++y) {
+                shade_row(ctx, _screen + screen_index(x1, y), x1, x2, y);
+            }
+        };
+        // a rect that's one job anyway isn't worth the trip through the job system
+        if (y2 - y1 + 1 <= rows_per_job) {
+            shade_rows(y1, y2 + 1);
+        }
+        else {
+            jobs().parallel_for_rows(y1, y2 + 1, rows_per_job, shade_rows);
+        }
+        mark_rows_dirty(y1, y2 + 1);
+    }
+
+    wstring cmd_engine::format_error(wstring_view msg) const
+	{
+		array<wchar_t, 256> buf;
+		FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, nullptr, GetLastError(), MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), buf.data(), static_cast<DWORD>(buf.size()), nullptr);
+		wstring s(L"ERROR: ");
+		s.append(msg).append(L"\n\t").append(buf.data());
+		return s;
+	}
 }
\ No newline at end of file
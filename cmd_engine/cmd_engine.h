@@ -1,272 +1,435 @@
-#pragma once
-//#pragma comment(lib, "winmm.lib")
-
-#ifndef UNICODE
-#error Please enable UNICODE for your compiler! VS: Project Properties -> General -> \
-Character Set -> Use Unicode. Thanks! - Javidx9
-#endif
-
-#include <windows.h>
-#include <string>
-#include <memory>
-#include <array>
-#include <vector>
-#include <atomic>
-#include <condition_variable>
-#include <mutex>
-
-using namespace std::string_literals;
-
-namespace olc
-{
-	//
-	// utility functions
-	//
-	void pause();
-
-	//
-	// Calculated by the basic FOREGROUD_XXX, BACKGROUND_XXX flags defined in windows.h that includes only red, green, blue, intensity (gray) colors.
-	// The followings are calculated by mixing those basic colors.
-	//
-	namespace color_t
-	{
-		enum enum_t : short
-		{
-			fg_black = 0x0000,
-			fg_dark_blue = 0x0001,
-			fg_dark_green = 0x0002,
-			fg_dark_cyan = 0x0003,
-			fg_dark_red = 0x0004,
-			fg_dark_magenta = 0x0005,
-			fg_dark_yellow = 0x0006,
-			fg_grey = 0x0007, // thanks ms :-/
-			fg_dark_grey = 0x0008,
-			fg_blue = 0x0009,
-			fg_green = 0x000a,
-			fg_cyan = 0x000b,
-			fg_red = 0x000c,
-			fg_magenta = 0x000d,
-			fg_yellow = 0x000e,
-			fg_white = 0x000f,
-
-			bg_black = 0x0000,
-			bg_dark_blue = 0x0010,
-			bg_dark_green = 0x0020,
-			bg_dark_cyan = 0x0030,
-			bg_dark_red = 0x0040,
-			bg_dark_magenta = 0x0050,
-			bg_dark_yellow = 0x0060,
-			bg_grey = 0x0070,
-			bg_dark_grey = 0x0080,
-			bg_blue = 0x0090,
-			bg_green = 0x00a0,
-			bg_cyan = 0x00b0,
-			bg_red = 0x00c0,
-			bg_magenta = 0x00d0,
-			bg_yellow = 0x00e0,
-			bg_white = 0x00f0,
-
-            black = 0x0000,
-            dark_blue = 0x0011,
-            dark_green = 0x0022,
-            dark_cyan = 0x0033,
-            dark_red = 0x0044,
-            dark_magenta = 0x0055,
-            dark_yellow = 0x0066,
-            grey = 0x0077, // thanks ms :-/
-            dark_grey = 0x0088,
-            blue = 0x0099,
-            green = 0x00aa,
-            cyan = 0x00bb,
-            red = 0x00cc,
-            magenta = 0x00dd,
-            yellow = 0x00ee,
-            white = 0x00ff,
-        };
-	}
-
-	//
-	// Unicode characters test display blocks in different "shade".
-	// Check https://www.fileformat.info/info/unicode/char/<character-code>/browsertest.htm
-	// by replace <character-code> with, say, 2592, to see what it looks like.
-	//
-	namespace pixel_type
-	{
-		enum enum_t
-		{
-			solid = 0x2588,
-			threequarters = 0x2593,
-			half = 0x2592,
-			quarter = 0x2591,
-		};
-	}
-
-	struct keystate {
-		bool pressed;
-		bool released;
-		bool held;
-	};
-
-	//
-	// Custom exception class to support unicode msg. Implementation mostly copied from std::runtime_error
-	//
-	class olc_exception : public std::exception { // base of all runtime-error exceptions
-	public:
-		using _Mybase = exception;
-
-		explicit olc_exception(std::wstring_view msg) : _Mybase(), _msg(msg) { // construct from message string
-		}
-
-		std::wstring_view msg() const
-		{
-			return _msg;
-		}
-
-#if _HAS_EXCEPTIONS
-
-#else // _HAS_EXCEPTIONS
-	protected:
-		virtual void _Doraise() const { // perform class-specific exception handling
-			_RAISE(*this);
-		}
-#endif // _HAS_EXCEPTIONS
-	private:
-		std::wstring _msg;
-	};
-
-	class sprite
-	{
-	public:
-		sprite() = delete;
-		sprite(int w, int h);
-		sprite(const std::wstring &file);
-
-	private:
-		void create(int w, int h);
-
-	public:
-		int width() const { return _width; }
-		int height() const { return _height; }
-
-		bool save(const std::wstring& file) const;
-        bool load(const std::wstring& file);
-        bool load_from_resource(uint32_t id);
-
-		void set_glyph(int x, int y, wchar_t c);
-		void set_color(int x, int y, short c);
-
-		wchar_t get_glyph(int x, int y) const;
-		short get_color(int x, int y) const;
-
-		wchar_t sample_glyph(float x, float y) const;
-		short sample_color(float x, float y) const;
-
-	private:
-		bool out_of_bound(int x, int y) const;
-
-	private:
-		int _width;
-		int _height;
-		std::wstring _glyphs;
-		std::vector<short> _colors;
-	};
-
-	class cmd_engine
-	{
-	public:
-		static constexpr int g_num_keys = 256;
-		static constexpr int g_num_mouse_buttons = 5;
-
-	public:
-		virtual ~cmd_engine();
-
-		void construct_console(int w, int h, int fontw, int fonth);
-		void start();
-		virtual void close();
-
-		int width() const { return _width; }
-		int height() const { return _height; }
-
-		keystate get_key(int key_id) const { return _keys[key_id]; }
-		keystate get_mouse(int button_id) const { return _mouse[button_id]; }
-		int get_mouse_x() const { return _mousex; }
-		int get_mouse_y() const { return _mousey; }
-
-		bool is_focused() const { return _in_focus; }
-
-		//
-		// draw methods
-		//
-		void draw(int x, int y, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-		void draw_no_bound_check(int x, int y, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-		// x2, y2, is inclusive
-		void fill(int x1, int y1, int x2, int y2, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-		void draw_string(int x, int y, const std::wstring& s, short color = color_t::fg_white);
-		void draw_string_alpha(int x, int y, const std::wstring& s, short color = color_t::fg_white);
-		// x, y are inclusive
-		void draw_line(int x1, int y1, int x2, int y2, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-		void draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-        // TODO: fill_triangle
-		void draw_circle(int xc, int yc, int r, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-		void fill_circle(int xc, int yc, int r, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-		void draw_sprite(int x, int y, const sprite& sprite);
-		// Draws part of the sprite
-		void draw_partial_sprite(int x, int y, const sprite& sprite, int sx, int sy, int w, int h);
-        // r is rotation of the model, rotation is base on (0,0) of the model; s is scale
-        void draw_wire_polygon(const std::vector<std::pair<float, float>>& model, float x, float y, float r = 0.0f, float s = 1.0f,
-            wchar_t c = pixel_type::solid, short color = color_t::fg_white);
-
-		// must override
-        // return false will quit the game
-		virtual bool on_user_init() = 0;
-        // return false will quit the game
-		virtual bool on_user_update(float elapsed) = 0;
-
-		// optional
-		virtual bool on_user_destroy() { return true; }
-
-	private:
-		// Main game thread
-		void gamethread();
-
-	private:
-		bool out_of_bound(int x, int y) const { return (x < 0 || x >= _width || y < 0 || y >= _height); }
-		int screen_index(int x, int y) const { return y * _width + x; }
-		void clip(int &x, int &y) {
-			x = std::clamp(x, 0, _width - 1);
-			y = std::clamp(y, 0, _height - 1);
-		}
-
-		std::wstring format_error(std::wstring_view msg) const;
-
-		// static as it's very hacky to pass in instance method to SetConsoleCtrlHandler
-		static bool console_close_handler(DWORD event);
-
-	protected:
-		std::wstring _app_name{ L"cmd engine"s };
-
-	private:
-		HANDLE _console{ INVALID_HANDLE_VALUE };
-		HANDLE _orig_console{ INVALID_HANDLE_VALUE };
-		HANDLE _stdin{ INVALID_HANDLE_VALUE };
-		int _width{ 0 };
-		int _height{ 0 };
-		SMALL_RECT _rect;
-		std::vector<CHAR_INFO> _screen_buf;
-
-		std::array<keystate, g_num_keys> _keys;
-		std::array<short, g_num_keys> _key_old_state;
-		std::array<short, g_num_keys> _key_new_state;
-		std::array<keystate, g_num_mouse_buttons> _mouse;
-		std::array<bool, g_num_mouse_buttons> _mouse_old_state;
-		std::array<bool, g_num_mouse_buttons> _mouse_new_state;
-		int _mousex = 0;
-		int _mousey = 0;
-		bool _in_focus{ true };
-
-		// static as will be used by static console_close_handler
-		static std::atomic<bool> _active;
-		static std::condition_variable _gamethread_ended_cv;
-		static std::mutex _gamethread_mutex;
-	};
+#pragma once
+//#pragma comment(lib, "winmm.lib")
+
+#ifndef UNICODE
+#error Please enable UNICODE for your compiler! VS: Project Properties -> General -> \
+Character Set -> Use Unicode. Thanks! - Javidx9
+#endif
+
+#include "frame_arena.h"
+#include "snapshot.h"
+#include <windows.h>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <type_traits>
+
+using namespace std::string_literals;
+
+namespace olc
+{
+	class spectator_server;
+	class engine_runner;
+	class job_system;
+	class script_scheduler;
+	class particle_system;
+	class audio_mixer;
+	class audio_sink;
+
+	//
+	// utility functions
+	//
+	void pause();
+
+	//
+	// Calculated by the basic FOREGROUD_XXX, BACKGROUND_XXX flags defined in windows.h that includes only red, green, blue, intensity (gray) colors.
+	// The followings are calculated by mixing those basic colors.
+	//
+	namespace color_t
+	{
+		enum enum_t : short
+		{
+			fg_black = 0x0000,
+			fg_dark_blue = 0x0001,
+			fg_dark_green = 0x0002,
+			fg_dark_cyan = 0x0003,
+			fg_dark_red = 0x0004,
+			fg_dark_magenta = 0x0005,
+			fg_dark_yellow = 0x0006,
+			fg_grey = 0x0007, // thanks ms :-/
+			fg_dark_grey = 0x0008,
+			fg_blue = 0x0009,
+			fg_green = 0x000a,
+			fg_cyan = 0x000b,
+			fg_red = 0x000c,
+			fg_magenta = 0x000d,
+			fg_yellow = 0x000e,
+			fg_white = 0x000f,
+
+			bg_black = 0x0000,
+			bg_dark_blue = 0x0010,
+			bg_dark_green = 0x0020,
+			bg_dark_cyan = 0x0030,
+			bg_dark_red = 0x0040,
+			bg_dark_magenta = 0x0050,
+			bg_dark_yellow = 0x0060,
+			bg_grey = 0x0070,
+			bg_dark_grey = 0x0080,
+			bg_blue = 0x0090,
+			bg_green = 0x00a0,
+			bg_cyan = 0x00b0,
+			bg_red = 0x00c0,
+			bg_magenta = 0x00d0,
+			bg_yellow = 0x00e0,
+			bg_white = 0x00f0,
+
+            black = 0x0000,
+            dark_blue = 0x0011,
+            dark_green = 0x0022,
+            dark_cyan = 0x0033,
+            dark_red = 0x0044,
+            dark_magenta = 0x0055,
+            dark_yellow = 0x0066,
+            grey = 0x0077, // thanks ms :-/
+            dark_grey = 0x0088,
+            blue = 0x0099,
+            green = 0x00aa,
+            cyan = 0x00bb,
+            red = 0x00cc,
+            magenta = 0x00dd,
+            yellow = 0x00ee,
+            white = 0x00ff,
+        };
+	}
+
+	//
+	// Unicode characters test display blocks in different "shade".
+	// Check https://www.fileformat.info/info/unicode/char/<character-code>/browsertest.htm
+	// by replace <character-code> with, say, 2592, to see what it looks like.
+	//
+	namespace pixel_type
+	{
+		enum enum_t
+		{
+			solid = 0x2588,
+			threequarters = 0x2593,
+			half = 0x2592,
+			quarter = 0x2591,
+		};
+	}
+
+	// What a draw_shader callback returns for its cell
+	struct shader_cell
+	{
+		wchar_t glyph;
+		short color;
+	};
+
+	struct keystate {
+		bool pressed;
+		bool released;
+		bool held;
+	};
+
+	//
+	// Custom exception class to support unicode msg. Implementation mostly copied from std::runtime_error
+	//
+	class olc_exception : public std::exception { // base of all runtime-error exceptions
+	public:
+		using _Mybase = exception;
+
+		explicit olc_exception(std::wstring_view msg) : _Mybase(), _msg(msg) { // construct from message string
+		}
+
+		std::wstring_view msg() const
+		{
+			return _msg;
+		}
+
+#if _HAS_EXCEPTIONS
+
+#else // _HAS_EXCEPTIONS
+	protected:
+		virtual void _Doraise() const { // perform class-specific exception handling
+			_RAISE(*this);
+		}
+#endif // _HAS_EXCEPTIONS
+	private:
+		std::wstring _msg;
+	};
+
+	class sprite
+	{
+	public:
+		sprite() = delete;
+		sprite(int w, int h);
+		sprite(const std::wstring &file);
+
+	private:
+		void create(int w, int h);
+
+	public:
+		int width() const { return _width; }
+		int height() const { return _height; }
+
+		bool save(const std::wstring& file) const;
+        bool load(const std::wstring& file);
+        bool load_from_resource(uint32_t id);
+
+		void set_glyph(int x, int y, wchar_t c);
+		void set_color(int x, int y, short c);
+
+		wchar_t get_glyph(int x, int y) const;
+		short get_color(int x, int y) const;
+
+		wchar_t sample_glyph(float x, float y) const;
+		short sample_color(float x, float y) const;
+
+	private:
+		bool out_of_bound(int x, int y) const;
+
+	private:
+		int _width;
+		int _height;
+		std::wstring _glyphs;
+		std::vector<short> _colors;
+	};
+
+	class cmd_engine
+	{
+	public:
+		static constexpr int g_num_keys = 256;
+		static constexpr int g_num_mouse_buttons = 5;
+
+	public:
+		cmd_engine();
+		virtual ~cmd_engine();
+
+		void construct_console(int w, int h, int fontw, int fonth);
+		// Follow the console window when the user resizes it, must be called before construct_console. The screen is
+		// reserved for the largest window the console allows at the chosen font, so a resize never reallocates; the
+		// requested w and h are clamped to that rather than thrown on. Not supported with an attached screen.
+		void set_resizable(bool resizable) { _resizable = resizable; }
+		// Sizes a resizable console's screen and window to w x h, clamped to the reserved capacity, and calls on_resize
+		// as a resize by the user would. Throws olc_exception if the console isn't resizable.
+		void set_screen_size(int w, int h);
+		// Screen buffer only, no console window and no input. Used for simulations driven by engine_runner.
+		void construct_headless(int w, int h);
+		void start();
+		virtual void close();
+
+		bool headless() const { return _headless; }
+		bool active() const { return _active; }
+
+		// Stream every presented frame to viewers connecting to the unix domain socket at socket_path.
+		void enable_spectators(const std::string& socket_path);
+
+		// Thread pool for spreading per frame work across cores, created on first use.
+		// Headless engines get a pool without workers, engine_runner already keeps every core busy.
+		job_system& jobs();
+		// Overrides the worker count jobs() creates its pool with, e.g. for a headless engine that owns the machine.
+		// Throws olc_exception once the pool exists.
+		void set_job_workers(unsigned nworkers);
+
+		// Coroutine scripts, resumed every frame just before on_user_update. Created on first use.
+		script_scheduler& scripts();
+
+		// Sound through a mixer fed after every on_user_update. Created on first use, playing to the default output
+		// device, or to nothing when headless or there's no device. enable_audio picks another sink, such as a
+		// wav_sink to record a headless run.
+		void enable_audio(std::unique_ptr<audio_sink> sink);
+		audio_mixer& audio();
+
+		// Transient memory for the current frame, everything allocated from it is freed after on_user_update returns.
+		// Debug builds report the peak usage and any heap allocations made during on_user_update to the debugger.
+		frame_arena& frame_memory() { return _frame_arena; }
+		std::pmr::memory_resource* frame_resource() { return &_frame_resource; }
+
+		// Game state to include in snapshots. Plain data only, restoring overwrites it byte for byte, so it mustn't
+		// own memory or point into memory that isn't restored with it. Snapshots only restore into an engine with the
+		// same regions registered in the same order.
+		void register_snapshot_state(void* data, size_t size);
+		void unregister_snapshot_state(void* data);
+		// Captures the parts of the engine into s, reusing its memory
+		void save_snapshot(snapshot& s, uint32_t parts = snapshot_part::all) const;
+		// Puts back what s holds. Returns false, changing nothing, if s was taken of a differently sized screen or
+		// with other state regions.
+		bool restore_snapshot(const snapshot& s);
+
+		int width() const { return _width; }
+		int height() const { return _height; }
+
+		keystate get_key(int key_id) const { return _keys[key_id]; }
+		keystate get_mouse(int button_id) const { return _mouse[button_id]; }
+		int get_mouse_x() const { return _mousex; }
+		int get_mouse_y() const { return _mousey; }
+
+		bool is_focused() const { return _in_focus; }
+
+		// Frames identical to the last presented one are never written to the console. With an idle tick the game
+		// thread also sleeps after such a frame until console input arrives or the tick is up, so a static screen
+		// costs next to no CPU. Off (0) by default, as games animating on their own need every frame.
+		void set_idle_tick(std::chrono::milliseconds tick) { _idle_tick = tick; }
+
+		//
+		// draw methods
+		//
+		void draw(int x, int y, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+		void draw_no_bound_check(int x, int y, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+		// x2, y2, is inclusive
+		void fill(int x1, int y1, int x2, int y2, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+		void draw_string(int x, int y, std::wstring_view s, short color = color_t::fg_white);
+		void draw_string_alpha(int x, int y, std::wstring_view s, short color = color_t::fg_white);
+		// Copies n ready made cells to the screen starting at x, y, clipped to the screen. Used for blitting spans.
+		void draw_cells(int x, int y, const CHAR_INFO* cells, int n);
+		// x, y are inclusive
+		void draw_line(int x1, int y1, int x2, int y2, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+		void draw_triangle(int x1, int y1, int x2, int y2, int x3, int y3, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+        // TODO: fill_triangle
+		void draw_circle(int xc, int yc, int r, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+		void fill_circle(int xc, int yc, int r, wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+		void draw_sprite(int x, int y, const sprite& sprite);
+		// Draws part of the sprite
+		void draw_partial_sprite(int x, int y, const sprite& sprite, int sx, int sy, int w, int h);
+        // r is rotation of the model, rotation is base on (0,0) of the model; s is scale
+        void draw_wire_polygon(const std::vector<std::pair<float, float>>& model, float x, float y, float r = 0.0f, float s = 1.0f,
+            wchar_t c = pixel_type::solid, short color = color_t::fg_white);
+		// Sets every cell of the rect, x2, y2 inclusive and clipped to the screen, to shader(x, y), which returns a
+		// shader_cell. Rows are split across jobs(), so the shader runs on several threads at once and mustn't write
+		// anything shared. It's inlined into the row loop and the cells are written without bound checks.
+		template<typename F>
+		void draw_shader(int x1, int y1, int x2, int y2, F&& shader)
+		{
+			using fn_t = std::remove_reference_t<F>;
+			auto shade_row = [](void* ctx, CHAR_INFO* cells, int x1, int x2, int y) {
+				auto& f = *static_cast<fn_t*>(ctx);
+				for (int x = x1; x <= x2; ++x, ++cells) {
+					shader_cell c = f(x, y);
+					cells->Char.UnicodeChar = c.glyph;
+					cells->Attributes = c.color;
+				}
+			};
+			draw_shader_impl(x1, y1, x2, y2, const_cast<void*>(static_cast<const void*>(&shader)), shade_row);
+		}
+
+		// must override
+        // return false will quit the game
+		virtual bool on_user_init() = 0;
+        // return false will quit the game
+		virtual bool on_user_update(float elapsed) = 0;
+
+		// optional
+		virtual bool on_user_destroy() { return true; }
+		// Called on the game thread before the next on_user_update once a resizable console changed size.
+		// The screen is cleared and fully repainted on the next present.
+		virtual void on_resize(int w, int h) {}
+
+	private:
+		friend class engine_runner;
+		// renders straight into the screen
+		friend class particle_system;
+
+		// Main game thread
+		void gamethread();
+
+		// frame loop building blocks, shared by gamethread and engine_runner
+		bool begin();
+		bool step(float elapsed);
+		void end();
+		void poll_input();
+		void present(float elapsed);
+		// applies a pending console resize, only within the reserved capacity
+		void resize_screen();
+		void apply_screen_size(int w, int h);
+
+	private:
+		using shader_row_fn = void (*)(void* ctx, CHAR_INFO* cells, int x1, int x2, int y);
+		// clips the rect and calls shade_row for each of its rows on the job system
+		void draw_shader_impl(int x1, int y1, int x2, int y2, void* ctx, shader_row_fn shade_row);
+
+	private:
+		bool out_of_bound(int x, int y) const { return (x < 0 || x >= _width || y < 0 || y >= _height); }
+		int screen_index(int x, int y) const { return y * _stride + x; }
+		void clip(int &x, int &y) {
+			x = std::clamp(x, 0, _width - 1);
+			y = std::clamp(y, 0, _height - 1);
+		}
+
+		std::wstring format_error(std::wstring_view msg) const;
+		// points _screen at _screen_buf unless a screen is attached
+		void allocate_screen();
+
+		// static as it's very hacky to pass in instance method to SetConsoleCtrlHandler
+		static bool console_close_handler(DWORD event);
+		static void register_console_engine(cmd_engine* engine);
+		static void unregister_console_engine(cmd_engine* engine);
+
+	protected:
+		// Draw into caller owned memory instead of the engine's own buffer, stride >= width is the distance between
+		// rows in cells. Must be called before construct_console/construct_headless. Used by fixed_cmd_engine.
+		void attach_screen(CHAR_INFO* screen, int stride);
+
+		// Rows written to directly through an attached screen must be marked, or present may skip them
+		void mark_row_dirty(int y) { _row_dirty[y] = 1; }
+		void mark_rows_dirty(int y1, int y2) { std::fill(_row_dirty.begin() + y1, _row_dirty.begin() + y2, uint8_t{ 1 }); }
+		// Present every row on the next frame
+		void invalidate_screen();
+
+	protected:
+		std::wstring _app_name{ L"cmd engine"s };
+
+	private:
+		HANDLE _console{ INVALID_HANDLE_VALUE };
+		HANDLE _orig_console{ INVALID_HANDLE_VALUE };
+		HANDLE _stdin{ INVALID_HANDLE_VALUE };
+		int _width{ 0 };
+		int _height{ 0 };
+		SMALL_RECT _rect;
+		// owned buffer, unused when a screen is attached
+		std::vector<CHAR_INFO> _screen_buf;
+		CHAR_INFO* _screen{ nullptr };
+		int _stride{ 0 };
+		bool _screen_attached{ false };
+		bool _resizable{ false };
+		bool _resize_pending{ false };
+		// largest screen a resizable console can grow to, the owned buffer is allocated at this size
+		int _max_width{ 0 };
+		int _max_height{ 0 };
+		// rows drawn to since the last present, and the hash of every row as last presented
+		std::vector<uint8_t> _row_dirty;
+		std::vector<uint64_t> _row_hash;
+		bool _last_frame_presented{ false };
+		std::chrono::milliseconds _idle_tick{ 0 };
+
+		std::array<keystate, g_num_keys> _keys{};
+		std::array<short, g_num_keys> _key_old_state{};
+		std::array<short, g_num_keys> _key_new_state{};
+		std::array<keystate, g_num_mouse_buttons> _mouse{};
+		std::array<bool, g_num_mouse_buttons> _mouse_old_state{};
+		std::array<bool, g_num_mouse_buttons> _mouse_new_state{};
+		int _mousex = 0;
+		int _mousey = 0;
+		bool _in_focus{ true };
+		bool _headless{ false };
+
+		std::unique_ptr<spectator_server> _spectators;
+		std::unique_ptr<job_system> _jobs;
+		int _job_workers{ -1 };
+		std::unique_ptr<script_scheduler> _scripts;
+		std::unique_ptr<audio_mixer> _audio;
+
+		struct snapshot_region
+		{
+			void* data;
+			size_t size;
+		};
+		std::vector<snapshot_region> _snapshot_regions;
+
+		frame_arena _frame_arena;
+		frame_arena_resource _frame_resource{ _frame_arena };
+		uint64_t _frame_count{ 0 };
+		std::array<wchar_t, 256> _title{};
+
+		std::atomic<bool> _active{ false };
+		// true while no game thread is running
+		bool _gamethread_ended{ true };
+		std::condition_variable _gamethread_ended_cv;
+		std::mutex _gamethread_mutex;
+	};
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "cpu_features.h"
+#include <intrin.h>
+#include <immintrin.h>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		bool detect_avx2()
+		{
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7) {
+				return false;
+			}
+			// FMA is used alongside AVX2, and the OS must save the ymm registers on a context switch
+			__cpuid(info, 1);
+			bool fma = (info[2] & (1 << 12)) != 0;
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (!fma || !osxsave || (_xgetbv(0) & 6) != 6) {
+				return false;
+			}
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+		}
+	}
+
+	bool cpu_has_avx2()
+	{
+		static const bool has_avx2 = detect_avx2();
+		return has_avx2;
+	}
+}
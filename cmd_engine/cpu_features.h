@@ -0,0 +1,7 @@
+#pragma once
+
+namespace olc
+{
+	// AVX2 with FMA, and an OS that saves the ymm registers. Checked once, cheap to call after.
+	bool cpu_has_avx2();
+}
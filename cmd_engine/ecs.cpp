@@ -0,0 +1,214 @@
+#include "ecs.h"
+#include "cmd_engine.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+
+using namespace std;
+
+namespace olc
+{
+	namespace ecs
+	{
+		namespace detail
+		{
+			namespace
+			{
+				struct component_info
+				{
+					size_t size;
+					size_t alignment;
+				};
+
+				// ids are handed out once per type on first use, possibly from several threads
+				mutex g_components_mutex;
+				array<component_info, max_components> g_components;
+				uint32_t g_num_components = 0;
+			}
+
+			uint32_t register_component(size_t size, size_t alignment)
+			{
+				lock_guard<mutex> lk(g_components_mutex);
+				if (g_num_components == max_components) {
+					throw olc_exception(L"Too many ECS component types, the limit is "s + to_wstring(max_components));
+				}
+				g_components[g_num_components] = { size, alignment };
+				return g_num_components++;
+			}
+
+			size_t component_size(uint32_t id)
+			{
+				lock_guard<mutex> lk(g_components_mutex);
+				return g_components[id].size;
+			}
+
+			size_t component_alignment(uint32_t id)
+			{
+				lock_guard<mutex> lk(g_components_mutex);
+				return g_components[id].alignment;
+			}
+		}
+
+		world::world()
+		{
+			// entities without components
+			find_or_add_archetype(0);
+		}
+
+		void world::destroy(entity e)
+		{
+			if (!alive(e)) {
+				return;
+			}
+			auto& rec = _records[e.index];
+			remove_row(rec.archetype, rec.chunk, rec.row);
+			rec.archetype = npos;
+			// old handles to this index stop being alive
+			++rec.generation;
+			_free_indices.push_back(e.index);
+			--_size;
+		}
+
+		entity world::new_entity()
+		{
+			uint32_t index;
+			if (!_free_indices.empty()) {
+				index = _free_indices.back();
+				_free_indices.pop_back();
+			}
+			else {
+				index = static_cast<uint32_t>(_records.size());
+				_records.emplace_back();
+			}
+			++_size;
+			return { index, _records[index].generation };
+		}
+
+		void world::require_alive(entity e) const
+		{
+			if (!alive(e)) {
+				throw olc_exception(L"ECS entity "s + to_wstring(e.index) + L" is not alive");
+			}
+		}
+
+		uint32_t world::find_or_add_archetype(uint64_t mask)
+		{
+			auto it = _archetype_by_mask.find(mask);
+			if (it != _archetype_by_mask.end()) {
+				return it->second;
+			}
+
+			auto a = make_unique<archetype>();
+			a->mask = mask;
+			a->add_edges.fill(npos);
+			a->remove_edges.fill(npos);
+			size_t row_bytes = sizeof(entity);
+			for (uint32_t id = 0; id < max_components; ++id) {
+				if (mask & (uint64_t{ 1 } << id)) {
+					a->components.push_back(id);
+					a->sizes[id] = static_cast<uint32_t>(detail::component_size(id));
+					row_bytes += a->sizes[id];
+				}
+			}
+
+			// as many rows as fit, leaving room for aligning each array; arrays start on a cache line so the
+			// loops over them vectorize cleanly
+			constexpr size_t array_align = 64;
+			size_t padding = array_align * a->components.size();
+			a->capacity = static_cast<uint32_t>((chunk_bytes - padding) / row_bytes);
+			assert(a->capacity > 0 && "component set too big for a chunk");
+			size_t offset = sizeof(entity) * a->capacity;
+			for (uint32_t id : a->components) {
+				size_t alignment = max(detail::component_alignment(id), array_align);
+				offset = (offset + alignment - 1) / alignment * alignment;
+				a->offsets[id] = static_cast<uint32_t>(offset);
+				offset += a->sizes[id] * a->capacity;
+			}
+			assert(offset <= chunk_bytes);
+
+			uint32_t index = static_cast<uint32_t>(_archetypes.size());
+			_archetypes.push_back(move(a));
+			_archetype_by_mask.emplace(mask, index);
+			return index;
+		}
+
+		uint32_t world::add_edge(uint32_t archetype, uint32_t id)
+		{
+			if (_archetypes[archetype]->add_edges[id] == npos) {
+				uint32_t target = find_or_add_archetype(_archetypes[archetype]->mask | (uint64_t{ 1 } << id));
+				_archetypes[archetype]->add_edges[id] = target;
+				_archetypes[target]->remove_edges[id] = archetype;
+			}
+			return _archetypes[archetype]->add_edges[id];
+		}
+
+		uint32_t world::remove_edge(uint32_t archetype, uint32_t id)
+		{
+			if (_archetypes[archetype]->remove_edges[id] == npos) {
+				uint32_t target = find_or_add_archetype(_archetypes[archetype]->mask & ~(uint64_t{ 1 } << id));
+				_archetypes[archetype]->remove_edges[id] = target;
+				_archetypes[target]->add_edges[id] = archetype;
+			}
+			return _archetypes[archetype]->remove_edges[id];
+		}
+
+		void world::place(entity e, uint32_t archetype)
+		{
+			auto& a = *_archetypes[archetype];
+			uint32_t c = static_cast<uint32_t>(a.count / a.capacity);
+			uint32_t row = static_cast<uint32_t>(a.count % a.capacity);
+			if (c == a.chunks.size()) {
+				a.chunks.push_back({ make_unique_for_overwrite<chunk_block>(), 0 });
+			}
+			auto& ch = a.chunks[c];
+			entities(ch)[row] = e;
+			++ch.count;
+			++a.count;
+			_records[e.index] = { e.generation, archetype, c, row };
+		}
+
+		void world::remove_row(uint32_t archetype, uint32_t chunk, uint32_t row)
+		{
+			auto& a = *_archetypes[archetype];
+			size_t last = a.count - 1;
+			uint32_t last_chunk = static_cast<uint32_t>(last / a.capacity);
+			uint32_t last_row = static_cast<uint32_t>(last % a.capacity);
+			if (chunk != last_chunk || row != last_row) {
+				// keep the chunks packed, the last entity takes the hole
+				auto& dst = a.chunks[chunk];
+				auto& src = a.chunks[last_chunk];
+				entity moved = entities(src)[last_row];
+				entities(dst)[row] = moved;
+				for (uint32_t id : a.components) {
+					size_t size = a.sizes[id];
+					memcpy(dst.block->bytes + a.offsets[id] + size * row, src.block->bytes + a.offsets[id] + size * last_row, size);
+				}
+				_records[moved.index].chunk = chunk;
+				_records[moved.index].row = row;
+			}
+			--a.chunks[last_chunk].count;
+			--a.count;
+		}
+
+		void world::move_entity(entity e, uint32_t archetype)
+		{
+			auto rec = _records[e.index];
+			place(e, archetype);
+			const auto& to = _records[e.index];
+
+			auto& src_arch = *_archetypes[rec.archetype];
+			auto& dst_arch = *_archetypes[archetype];
+			auto& src = src_arch.chunks[rec.chunk];
+			auto& dst = dst_arch.chunks[to.chunk];
+			for (uint32_t id : src_arch.components) {
+				if (dst_arch.mask & (uint64_t{ 1 } << id)) {
+					size_t size = src_arch.sizes[id];
+					memcpy(dst.block->bytes + dst_arch.offsets[id] + size * to.row,
+						src.block->bytes + src_arch.offsets[id] + size * rec.row, size);
+				}
+			}
+			remove_row(rec.archetype, rec.chunk, rec.row);
+		}
+	}
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#include "job_system.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace olc
+{
+	namespace ecs
+	{
+		//
+		// Entity component system with archetype storage.
+		//
+		// Entities with the same set of components share an archetype, which keeps them in fixed size chunks with
+		// one array per component (structure of arrays). A query walks the archetypes that have every component
+		// asked for and hands the arrays over chunk by chunk, so a system like
+		//
+		//     world.each<position, const velocity>([dt](position& p, const velocity& v) { p.x += v.x * dt; ... });
+		//
+		// is a plain loop over contiguous memory that the compiler can vectorize.
+		//
+		// Components are plain data: trivially copyable and destructible, as they're moved between chunks with
+		// memcpy. At most max_components component types per program. Adding or removing a component moves the
+		// entity to another archetype, so prefer setting up the full set in create().
+		//
+		// Queries don't modify the world. Several may run at the same time, e.g. as independent task_graph tasks,
+		// as long as no two of them write the same component type and nothing creates, destroys, adds or removes
+		// while they run. Not thread safe otherwise.
+		//
+		constexpr uint32_t max_components = 64;
+
+		struct entity
+		{
+			uint32_t index{ UINT32_MAX };
+			uint32_t generation{ 0 };
+
+			bool operator==(const entity&) const = default;
+		};
+
+		namespace detail
+		{
+			// returns the id for a new component type, throws once there are max_components
+			uint32_t register_component(size_t size, size_t alignment);
+			size_t component_size(uint32_t id);
+			size_t component_alignment(uint32_t id);
+
+			template<typename T>
+			uint32_t component_id_of()
+			{
+				static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>,
+					"components must be plain data");
+				static const uint32_t id = register_component(sizeof(T), alignof(T));
+				return id;
+			}
+		}
+
+		// const T and T are the same component
+		template<typename T>
+		uint32_t component_id()
+		{
+			return detail::component_id_of<std::remove_cv_t<T>>();
+		}
+
+		template<typename... Cs>
+		uint64_t component_mask()
+		{
+			return (uint64_t{ 0 } | ... | (uint64_t{ 1 } << component_id<Cs>()));
+		}
+
+		class world
+		{
+		public:
+			// every archetype stores its entities in chunks of this many bytes
+			static constexpr size_t chunk_bytes = 16 * 1024;
+
+		public:
+			world();
+
+			world(const world&) = delete;
+			world& operator=(const world&) = delete;
+
+			template<typename... Cs>
+			entity create(const Cs&... components)
+			{
+				uint32_t a = find_or_add_archetype(component_mask<Cs...>());
+				entity e = new_entity();
+				place(e, a);
+				(write<Cs>(e, components), ...);
+				return e;
+			}
+
+			void destroy(entity e);
+			bool alive(entity e) const
+			{
+				return e.index < _records.size() && _records[e.index].generation == e.generation &&
+					_records[e.index].archetype != npos;
+			}
+
+			// Adds the component, or overwrites it if the entity already has one. Throws if the entity isn't alive.
+			template<typename T>
+			void add(entity e, const T& component = T{})
+			{
+				require_alive(e);
+				uint32_t id = component_id<T>();
+				const auto& rec = _records[e.index];
+				if (!(_archetypes[rec.archetype]->mask & (uint64_t{ 1 } << id))) {
+					move_entity(e, add_edge(rec.archetype, id));
+				}
+				write<T>(e, component);
+			}
+
+			// Throws if the entity isn't alive
+			template<typename T>
+			void remove(entity e)
+			{
+				require_alive(e);
+				uint32_t id = component_id<T>();
+				const auto& rec = _records[e.index];
+				if (_archetypes[rec.archetype]->mask & (uint64_t{ 1 } << id)) {
+					move_entity(e, remove_edge(rec.archetype, id));
+				}
+			}
+
+			template<typename T>
+			bool has(entity e) const
+			{
+				return alive(e) && (_archetypes[_records[e.index].archetype]->mask & (uint64_t{ 1 } << component_id<T>()));
+			}
+
+			// nullptr if the entity doesn't have the component. Invalidated by any structural change.
+			template<typename T>
+			T* get(entity e)
+			{
+				if (!has<T>(e)) {
+					return nullptr;
+				}
+				const auto& rec = _records[e.index];
+				auto& a = *_archetypes[rec.archetype];
+				return column<T>(a, a.chunks[rec.chunk], component_id<T>()) + rec.row;
+			}
+
+			// number of live entities
+			size_t size() const { return _size; }
+
+			//
+			// Queries. Cs are the components to visit, const ones are only read.
+			//
+
+			// Calls f(Cs&...) for every entity that has all of Cs
+			template<typename... Cs, typename F>
+			void each(F&& f)
+			{
+				each_chunk<Cs...>([&f](size_t n, const entity*, Cs*... arrays) {
+					for (size_t i = 0; i < n; ++i) {
+						f(arrays[i]...);
+					}
+				});
+			}
+
+			// Calls f(n, entities, Cs*... arrays) for every chunk with entities that have all of Cs
+			template<typename... Cs, typename F>
+			void each_chunk(F&& f)
+			{
+				const uint64_t mask = component_mask<Cs...>();
+				const std::array<uint32_t, sizeof...(Cs)> ids{ component_id<Cs>()... };
+				for (auto& a : _archetypes) {
+					if ((a->mask & mask) != mask) {
+						continue;
+					}
+					for (size_t c = 0; c < a->used_chunks(); ++c) {
+						visit_chunk<Cs...>(*a, a->chunks[c], ids, f, std::index_sequence_for<Cs...>{});
+					}
+				}
+			}
+
+			// each_chunk with the chunks spread over the job system, f is called concurrently
+			template<typename... Cs, typename F>
+			void each_chunk_parallel(job_system& js, F&& f)
+			{
+				const uint64_t mask = component_mask<Cs...>();
+				const std::array<uint32_t, sizeof...(Cs)> ids{ component_id<Cs>()... };
+				for (auto& a : _archetypes) {
+					if ((a->mask & mask) != mask || a->count == 0) {
+						continue;
+					}
+					auto& arch = *a;
+					js.parallel_for_rows(0, static_cast<int>(arch.used_chunks()), 1, [&](int c0, int c1) {
+						for (int c = c0; c < c1; ++c) {
+							visit_chunk<Cs...>(arch, arch.chunks[c], ids, f, std::index_sequence_for<Cs...>{});
+						}
+					});
+				}
+			}
+
+			// each with the chunks spread over the job system, f is called concurrently
+			template<typename... Cs, typename F>
+			void each_parallel(job_system& js, F&& f)
+			{
+				each_chunk_parallel<Cs...>(js, [&f](size_t n, const entity*, Cs*... arrays) {
+					for (size_t i = 0; i < n; ++i) {
+						f(arrays[i]...);
+					}
+				});
+			}
+
+		private:
+			static constexpr uint32_t npos = UINT32_MAX;
+
+			struct alignas(64) chunk_block
+			{
+				std::byte bytes[chunk_bytes];
+			};
+
+			struct chunk
+			{
+				std::unique_ptr<chunk_block> block;
+				uint32_t count{ 0 };
+			};
+
+			struct archetype
+			{
+				uint64_t mask{ 0 };
+				// entities per chunk
+				uint32_t capacity{ 0 };
+				std::vector<uint32_t> components;
+				// byte offset of each component's array within a chunk, by component id, the entities come first
+				std::array<uint32_t, max_components> offsets{};
+				std::array<uint32_t, max_components> sizes{};
+				// chunks are packed, only the last used one may be partly full. Emptied chunks are kept for reuse.
+				std::vector<chunk> chunks;
+				size_t count{ 0 };
+				// archetypes one component away, filled in on first use
+				std::array<uint32_t, max_components> add_edges;
+				std::array<uint32_t, max_components> remove_edges;
+
+				size_t used_chunks() const { return (count + capacity - 1) / capacity; }
+			};
+
+			struct record
+			{
+				uint32_t generation{ 0 };
+				// npos when the entity is destroyed
+				uint32_t archetype{ npos };
+				uint32_t chunk{ 0 };
+				uint32_t row{ 0 };
+			};
+
+			template<typename T>
+			static T* column(archetype& a, chunk& c, uint32_t id)
+			{
+				return std::launder(reinterpret_cast<T*>(c.block->bytes + a.offsets[id]));
+			}
+
+			static entity* entities(chunk& c)
+			{
+				return std::launder(reinterpret_cast<entity*>(c.block->bytes));
+			}
+
+			template<typename T>
+			void write(entity e, const T& component)
+			{
+				const auto& rec = _records[e.index];
+				auto& a = *_archetypes[rec.archetype];
+				column<std::remove_cv_t<T>>(a, a.chunks[rec.chunk], component_id<T>())[rec.row] = component;
+			}
+
+			template<typename... Cs, typename F, size_t... I>
+			static void visit_chunk(archetype& a, chunk& c, const std::array<uint32_t, sizeof...(Cs)>& ids, F& f,
+				std::index_sequence<I...>)
+			{
+				f(static_cast<size_t>(c.count), static_cast<const entity*>(entities(c)), column<Cs>(a, c, ids[I])...);
+			}
+
+			entity new_entity();
+			// throws olc_exception for a destroyed or stale entity, which has no archetype to change
+			void require_alive(entity e) const;
+			uint32_t find_or_add_archetype(uint64_t mask);
+			uint32_t add_edge(uint32_t archetype, uint32_t id);
+			uint32_t remove_edge(uint32_t archetype, uint32_t id);
+			// appends the entity to the archetype, components left uninitialized
+			void place(entity e, uint32_t archetype);
+			// takes the row out of its archetype, filling the hole with the archetype's last entity
+			void remove_row(uint32_t archetype, uint32_t chunk, uint32_t row);
+			// moves an entity to an archetype, copying the components both have
+			void move_entity(entity e, uint32_t archetype);
+
+		private:
+			// unique_ptr keeps archetypes in place as more are added
+			std::vector<std::unique_ptr<archetype>> _archetypes;
+			std::unordered_map<uint64_t, uint32_t> _archetype_by_mask;
+			std::vector<record> _records;
+			std::vector<uint32_t> _free_indices;
+			size_t _size{ 0 };
+		};
+	}
+}
@@ -0,0 +1,93 @@
+#include "engine_runner.h"
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		// frames an engine is stepped for before it is handed back to the queue
+		constexpr uint64_t g_frames_per_slice = 64;
+	}
+
+	engine_runner::engine_runner(unsigned nthreads)
+		: _nthreads{ max(nthreads, 1u) }
+	{
+	}
+
+	void engine_runner::add(cmd_engine& engine)
+	{
+		if (!engine.headless()) {
+			throw olc_exception(L"engine_runner only runs engines constructed with construct_headless()");
+		}
+		_slots.push_back({ &engine });
+	}
+
+	uint64_t engine_runner::run(float elapsed, uint64_t max_frames)
+	{
+		_total_frames = 0;
+		_queue.clear();
+		for (size_t i = 0; i < _slots.size(); ++i) {
+			_slots[i].frames = 0;
+			_slots[i].started = false;
+			_queue.push_back(i);
+		}
+
+		vector<thread> threads;
+		unsigned n = static_cast<unsigned>(min<size_t>(_nthreads, _slots.size()));
+		threads.reserve(n);
+		for (unsigned i = 0; i < n; ++i) {
+			threads.emplace_back(&engine_runner::worker, this, elapsed, max_frames);
+		}
+		for (auto& t : threads) {
+			t.join();
+		}
+		return _total_frames;
+	}
+
+	void engine_runner::worker(float elapsed, uint64_t max_frames)
+	{
+		for (;;) {
+			size_t index;
+			{
+				lock_guard<mutex> lk(_queue_mutex);
+				if (_queue.empty()) {
+					// the remaining engines are being finished by other workers
+					return;
+				}
+				index = _queue.front();
+				_queue.pop_front();
+			}
+
+			if (!run_slice(_slots[index], elapsed, max_frames)) {
+				lock_guard<mutex> lk(_queue_mutex);
+				_queue.push_back(index);
+			}
+		}
+	}
+
+	bool engine_runner::run_slice(slot& s, float elapsed, uint64_t max_frames)
+	{
+		auto& engine = *s.engine;
+		if (!s.started) {
+			s.started = true;
+			engine._active = true;
+			engine.begin();
+		}
+
+		uint64_t frames = 0;
+		while (engine._active && frames < g_frames_per_slice && (max_frames == 0 || s.frames < max_frames)) {
+			engine.step(elapsed);
+			++frames;
+			++s.frames;
+		}
+		_total_frames += frames;
+
+		if (engine._active && (max_frames == 0 || s.frames < max_frames)) {
+			return false;
+		}
+		engine._active = false;
+		engine.end();
+		return true;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include <thread>
+
+namespace olc
+{
+	//
+	// Drives many headless engines in one process on a pool of worker threads.
+	//
+	// Every engine steps with the same fixed elapsed time, so runs are deterministic regardless of the machine load.
+	// An engine is only ever stepped by one worker at a time, so game code needs no locking. Workers pick up engines
+	// from a shared queue and run them for a slice of frames, which keeps all cores busy even when some games
+	// quit early.
+	//
+	class engine_runner
+	{
+	public:
+		explicit engine_runner(unsigned nthreads = std::thread::hardware_concurrency());
+
+		engine_runner(const engine_runner&) = delete;
+		engine_runner& operator=(const engine_runner&) = delete;
+
+		// The engine must be constructed with construct_headless() and outlive run().
+		void add(cmd_engine& engine);
+
+		// Run all engines until they quit, or for max_frames each if max_frames > 0.
+		// Returns the total number of frames stepped.
+		uint64_t run(float elapsed = 1.0f / 60.0f, uint64_t max_frames = 0);
+
+		size_t size() const { return _slots.size(); }
+		unsigned thread_count() const { return _nthreads; }
+
+	private:
+		struct slot
+		{
+			cmd_engine* engine;
+			uint64_t frames{ 0 };
+			bool started{ false };
+		};
+
+		void worker(float elapsed, uint64_t max_frames);
+		// returns true if the engine is finished
+		bool run_slice(slot& s, float elapsed, uint64_t max_frames);
+
+	private:
+		unsigned _nthreads;
+		std::vector<slot> _slots;
+
+		std::mutex _queue_mutex;
+		std::deque<size_t> _queue;
+		std::atomic<uint64_t> _total_frames{ 0 };
+	};
+}
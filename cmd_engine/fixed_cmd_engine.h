@@ -0,0 +1,102 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+
+namespace olc
+{
+	//
+	// cmd_engine for a resolution known at compile time.
+	//
+	// The screen is a std::array inside the engine, and draw, draw_no_bound_check and fill hide the cmd_engine
+	// versions with ones where the index math and clipping use constants, so the compiler can unroll and vectorize
+	// the loops in game code. Everything else, and any call through a cmd_engine&, goes through the runtime path
+	// onto the same screen and draws the same result.
+	//
+	// With pow2_stride the rows are padded to a power of two, turning y * stride into a shift. That trades memory
+	// (160 wide becomes 256) for cheaper indexing, so measure before turning it on.
+	//
+	template<int W, int H, bool pow2_stride = false>
+	class fixed_cmd_engine : public cmd_engine
+	{
+		static_assert(W > 0 && H > 0 && W <= SHRT_MAX && H <= SHRT_MAX, "console size must fit in a short");
+
+	public:
+		static constexpr int stride = pow2_stride ? static_cast<int>(std::bit_ceil(static_cast<unsigned>(W))) : W;
+
+	public:
+		fixed_cmd_engine()
+		{
+			attach_screen(_screen.data(), stride);
+		}
+
+		void construct_console(int fontw, int fonth) { cmd_engine::construct_console(W, H, fontw, fonth); }
+		void construct_headless() { cmd_engine::construct_headless(W, H); }
+
+		static constexpr int width() { return W; }
+		static constexpr int height() { return H; }
+
+		CHAR_INFO& cell(int x, int y)
+		{
+			mark_row_dirty(y);
+			return _screen[index(x, y)];
+		}
+		const CHAR_INFO& cell(int x, int y) const { return _screen[index(x, y)]; }
+
+		//
+		// draw methods with compile time bounds
+		//
+		void draw(int x, int y, wchar_t c = pixel_type::solid, short color = color_t::fg_white)
+		{
+			if (out_of_bound(x, y)) {
+				return;
+			}
+			draw_no_bound_check(x, y, c, color);
+		}
+
+		void draw_no_bound_check(int x, int y, wchar_t c = pixel_type::solid, short color = color_t::fg_white)
+		{
+			auto& ci = _screen[index(x, y)];
+			ci.Char.UnicodeChar = c;
+			ci.Attributes = color;
+			mark_row_dirty(y);
+		}
+
+		// same ranges as cmd_engine::fill
+		void fill(int x1, int y1, int x2, int y2, wchar_t c = pixel_type::solid, short color = color_t::fg_white)
+		{
+			x1 = std::clamp(x1, 0, W - 1);
+			x2 = std::clamp(x2, 0, W - 1);
+			y1 = std::clamp(y1, 0, H - 1);
+			y2 = std::clamp(y2, 0, H - 1);
+			if (x2 < x1) {
+				return;
+			}
+			CHAR_INFO ci;
+			ci.Char.UnicodeChar = c;
+			ci.Attributes = color;
+			// row by row, each row is contiguous
+			for (int y = y1; y < y2; ++y) {
+				std::fill_n(_screen.data() + index(x1, y), x2 - x1 + 1, ci);
+			}
+			if (y1 < y2) {
+				mark_rows_dirty(y1, y2);
+			}
+		}
+
+	private:
+		static constexpr bool out_of_bound(int x, int y)
+		{
+			// one unsigned compare per axis also catches negatives
+			return static_cast<unsigned>(x) >= static_cast<unsigned>(W) || static_cast<unsigned>(y) >= static_cast<unsigned>(H);
+		}
+
+		static constexpr int index(int x, int y) { return y * stride + x; }
+
+	private:
+		std::array<CHAR_INFO, static_cast<size_t>(stride) * H> _screen{};
+	};
+}
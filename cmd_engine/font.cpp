@@ -0,0 +1,304 @@
+#include "font.h"
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		constexpr int g_builtin_w = 5;
+		constexpr int g_builtin_h = 7;
+		constexpr int g_builtin_first = 32;
+
+		// one byte per row, high bit leftmost
+		constexpr uint8_t g_builtin[][g_builtin_h] = {
+			{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// space
+			{ 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x20 },	// !
+			{ 0x50, 0x50, 0x50, 0x00, 0x00, 0x00, 0x00 },	// "
+			{ 0x50, 0x50, 0xf8, 0x50, 0xf8, 0x50, 0x50 },	// #
+			{ 0x20, 0x78, 0xa0, 0x70, 0x28, 0xf0, 0x20 },	// $
+			{ 0xc0, 0xc8, 0x10, 0x20, 0x40, 0x98, 0x18 },	// %
+			{ 0x60, 0x90, 0xa0, 0x40, 0xa8, 0x90, 0x68 },	// &
+			{ 0x20, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00 },	// '
+			{ 0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10 },	// (
+			{ 0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40 },	// )
+			{ 0x00, 0x20, 0xa8, 0x70, 0xa8, 0x20, 0x00 },	// *
+			{ 0x00, 0x20, 0x20, 0xf8, 0x20, 0x20, 0x00 },	// +
+			{ 0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x40 },	// ,
+			{ 0x00, 0x00, 0x00, 0xf8, 0x00, 0x00, 0x00 },	// -
+			{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60 },	// .
+			{ 0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00 },	// /
+			{ 0x70, 0x88, 0x98, 0xa8, 0xc8, 0x88, 0x70 },	// 0
+			{ 0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70 },	// 1
+			{ 0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xf8 },	// 2
+			{ 0xf8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70 },	// 3
+			{ 0x10, 0x30, 0x50, 0x90, 0xf8, 0x10, 0x10 },	// 4
+			{ 0xf8, 0x80, 0xf0, 0x08, 0x08, 0x88, 0x70 },	// 5
+			{ 0x30, 0x40, 0x80, 0xf0, 0x88, 0x88, 0x70 },	// 6
+			{ 0xf8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40 },	// 7
+			{ 0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70 },	// 8
+			{ 0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60 },	// 9
+			{ 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00 },	// :
+			{ 0x00, 0x60, 0x60, 0x00, 0x60, 0x20, 0x40 },	// ;
+			{ 0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10 },	// <
+			{ 0x00, 0x00, 0xf8, 0x00, 0xf8, 0x00, 0x00 },	// =
+			{ 0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40 },	// >
+			{ 0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20 },	// ?
+			{ 0x70, 0x88, 0x08, 0x68, 0xa8, 0xa8, 0x70 },	// @
+			{ 0x70, 0x88, 0x88, 0xf8, 0x88, 0x88, 0x88 },	// A
+			{ 0xf0, 0x88, 0x88, 0xf0, 0x88, 0x88, 0xf0 },	// B
+			{ 0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70 },	// C
+			{ 0xe0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xe0 },	// D
+			{ 0xf8, 0x80, 0x80, 0xf0, 0x80, 0x80, 0xf8 },	// E
+			{ 0xf8, 0x80, 0x80, 0xf0, 0x80, 0x80, 0x80 },	// F
+			{ 0x70, 0x88, 0x80, 0xb8, 0x88, 0x88, 0x78 },	// G
+			{ 0x88, 0x88, 0x88, 0xf8, 0x88, 0x88, 0x88 },	// H
+			{ 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70 },	// I
+			{ 0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60 },	// J
+			{ 0x88, 0x90, 0xa0, 0xc0, 0xa0, 0x90, 0x88 },	// K
+			{ 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xf8 },	// L
+			{ 0x88, 0xd8, 0xa8, 0xa8, 0x88, 0x88, 0x88 },	// M
+			{ 0x88, 0x88, 0xc8, 0xa8, 0x98, 0x88, 0x88 },	// N
+			{ 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70 },	// O
+			{ 0xf0, 0x88, 0x88, 0xf0, 0x80, 0x80, 0x80 },	// P
+			{ 0x70, 0x88, 0x88, 0x88, 0xa8, 0x90, 0x68 },	// Q
+			{ 0xf0, 0x88, 0x88, 0xf0, 0xa0, 0x90, 0x88 },	// R
+			{ 0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xf0 },	// S
+			{ 0xf8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20 },	// T
+			{ 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70 },	// U
+			{ 0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20 },	// V
+			{ 0x88, 0x88, 0x88, 0xa8, 0xa8, 0xa8, 0x50 },	// W
+			{ 0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88 },	// X
+			{ 0x88, 0x88, 0x88, 0x50, 0x20, 0x20, 0x20 },	// Y
+			{ 0xf8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xf8 },	// Z
+			{ 0x70, 0x40, 0x40, 0x40, 0x40, 0x40, 0x70 },	// [
+			{ 0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00 },	// backslash
+			{ 0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x70 },	// ]
+			{ 0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00 },	// ^
+			{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf8 },	// _
+			{ 0x40, 0x20, 0x10, 0x00, 0x00, 0x00, 0x00 },	// `
+			{ 0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78 },	// a
+			{ 0x80, 0x80, 0xb0, 0xc8, 0x88, 0x88, 0xf0 },	// b
+			{ 0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70 },	// c
+			{ 0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78 },	// d
+			{ 0x00, 0x00, 0x70, 0x88, 0xf8, 0x80, 0x70 },	// e
+			{ 0x30, 0x48, 0x40, 0xe0, 0x40, 0x40, 0x40 },	// f
+			{ 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x70 },	// g
+			{ 0x80, 0x80, 0xb0, 0xc8, 0x88, 0x88, 0x88 },	// h
+			{ 0x20, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70 },	// i
+			{ 0x10, 0x00, 0x30, 0x10, 0x10, 0x90, 0x60 },	// j
+			{ 0x80, 0x80, 0x90, 0xa0, 0xc0, 0xa0, 0x90 },	// k
+			{ 0x60, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70 },	// l
+			{ 0x00, 0x00, 0xd0, 0xa8, 0xa8, 0x88, 0x88 },	// m
+			{ 0x00, 0x00, 0xb0, 0xc8, 0x88, 0x88, 0x88 },	// n
+			{ 0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70 },	// o
+			{ 0x00, 0x00, 0xf0, 0x88, 0xf0, 0x80, 0x80 },	// p
+			{ 0x00, 0x00, 0x68, 0x98, 0x78, 0x08, 0x08 },	// q
+			{ 0x00, 0x00, 0xb0, 0xc8, 0x80, 0x80, 0x80 },	// r
+			{ 0x00, 0x00, 0x70, 0x80, 0x70, 0x08, 0xf0 },	// s
+			{ 0x40, 0x40, 0xe0, 0x40, 0x40, 0x48, 0x30 },	// t
+			{ 0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68 },	// u
+			{ 0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20 },	// v
+			{ 0x00, 0x00, 0x88, 0x88, 0xa8, 0xa8, 0x50 },	// w
+			{ 0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88 },	// x
+			{ 0x00, 0x00, 0x88, 0x88, 0x78, 0x08, 0x70 },	// y
+			{ 0x00, 0x00, 0xf8, 0x10, 0x20, 0x40, 0xf8 },	// z
+			{ 0x10, 0x20, 0x20, 0x40, 0x20, 0x20, 0x10 },	// {
+			{ 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20 },	// |
+			{ 0x40, 0x20, 0x20, 0x10, 0x20, 0x20, 0x40 },	// }
+			{ 0x00, 0x00, 0x40, 0xa8, 0x10, 0x00, 0x00 },	// ~
+		};
+
+		constexpr int g_builtin_count = static_cast<int>(size(g_builtin));
+	}
+
+	font::font()
+		: _glyph_w{ g_builtin_w }
+		, _glyph_h{ g_builtin_h }
+		, _first{ g_builtin_first }
+		, _count{ g_builtin_count }
+		, _bitmap(&g_builtin[0][0], &g_builtin[0][0] + sizeof(g_builtin))
+	{
+		reset_caches();
+	}
+
+	font::font(const wstring& file)
+	{
+		if (!load(file)) {
+			throw olc_exception(L"Failed to load font "s + file);
+		}
+	}
+
+	bool font::save(const wstring& file) const
+	{
+		FILE* f{ nullptr };
+		_wfopen_s(&f, file.c_str(), L"wb");
+		if (!f) {
+			return false;
+		}
+
+		int32_t header[] = { _glyph_w, _glyph_h, _first, _count };
+		fwrite(header, sizeof(header), 1, f);
+		fwrite(_bitmap.data(), 1, _bitmap.size(), f);
+
+		fclose(f);
+		return true;
+	}
+
+	bool font::load(const wstring& file)
+	{
+		FILE* f{ nullptr };
+		_wfopen_s(&f, file.c_str(), L"rb");
+		if (!f) {
+			return false;
+		}
+
+		int32_t header[4];
+		bool ok = fread(header, sizeof(header), 1, f) == 1;
+		// anything bigger than a screen's worth of glyph is a broken file
+		ok = ok && header[0] > 0 && header[0] <= 256 && header[1] > 0 && header[1] <= 256;
+		ok = ok && header[2] >= 0 && header[3] > 0 && header[2] + header[3] <= 0x10000;
+		vector<uint8_t> bitmap;
+		if (ok) {
+			bitmap.resize(static_cast<size_t>(header[3]) * header[1] * ((header[0] + 7) / 8));
+			ok = fread(bitmap.data(), 1, bitmap.size(), f) == bitmap.size();
+		}
+		fclose(f);
+		if (!ok) {
+			return false;
+		}
+
+		_glyph_w = header[0];
+		_glyph_h = header[1];
+		_first = header[2];
+		_count = header[3];
+		_bitmap = move(bitmap);
+		reset_caches();
+		return true;
+	}
+
+	int font::text_width(wstring_view s, int scale) const
+	{
+		int widest = 0;
+		int chars = 0;
+		for (wchar_t c : s) {
+			chars = (c == L'\n') ? 0 : chars + 1;
+			widest = max(widest, chars);
+		}
+		return widest > 0 ? (widest * (_glyph_w + 1) - 1) * scale : 0;
+	}
+
+	int font::text_height(wstring_view s, int scale) const
+	{
+		if (s.empty()) {
+			return 0;
+		}
+		int lines = static_cast<int>(count(s.begin(), s.end(), L'\n')) + 1;
+		return (lines * (_glyph_h + 1) - 1) * scale;
+	}
+
+	void font::draw_string(cmd_engine& engine, int x, int y, wstring_view s, int scale, short color, wchar_t c)
+	{
+		if (scale < 1 || s.empty()) {
+			return;
+		}
+		if (const layout* l = find_layout(s, scale)) {
+			prepare_ink(l->max_len, color, c);
+			for (const auto& sp : l->spans) {
+				engine.draw_cells(x + sp.x, y + sp.y, _ink.data(), sp.len);
+			}
+			return;
+		}
+		prepare_ink(_glyph_w * scale, color, c);
+		for_each_span(s, scale, [&](int sx, int sy, int len) {
+			engine.draw_cells(x + sx, y + sy, _ink.data(), len);
+		});
+	}
+
+	void font::prepare_ink(int len, short color, wchar_t c)
+	{
+		if (_ink.size() < static_cast<size_t>(len) || (!_ink.empty() &&
+			(_ink[0].Char.UnicodeChar != c || _ink[0].Attributes != static_cast<WORD>(color)))) {
+			CHAR_INFO ci;
+			ci.Char.UnicodeChar = c;
+			ci.Attributes = color;
+			_ink.assign(max(_ink.size(), static_cast<size_t>(len)), ci);
+		}
+	}
+
+	int font::glyph_index(wchar_t c) const
+	{
+		int index = static_cast<int>(c) - _first;
+		if (index >= 0 && index < _count) {
+			return index;
+		}
+		index = L'?' - _first;
+		return (index >= 0 && index < _count) ? index : -1;
+	}
+
+	const vector<font::span>& font::glyph_spans(int index)
+	{
+		auto& spans = _glyph_spans[index];
+		if (_glyph_cached[index]) {
+			return spans;
+		}
+		int row_bytes = (_glyph_w + 7) / 8;
+		const uint8_t* rows = _bitmap.data() + static_cast<size_t>(index) * _glyph_h * row_bytes;
+		auto pixel = [&](int x, int y) {
+			return (rows[y * row_bytes + x / 8] & (0x80 >> (x % 8))) != 0;
+		};
+		for (int y = 0; y < _glyph_h; ++y) {
+			for (int x = 0; x < _glyph_w;) {
+				if (!pixel(x, y)) {
+					++x;
+					continue;
+				}
+				int start = x;
+				while (x < _glyph_w && pixel(x, y)) {
+					++x;
+				}
+				spans.push_back({ start, y, x - start });
+			}
+		}
+		_glyph_cached[index] = 1;
+		return spans;
+	}
+
+	const font::layout* font::find_layout(wstring_view s, int scale)
+	{
+		// the key buffer is reused so a cache hit doesn't allocate
+		_key.clear();
+		_key.push_back(static_cast<wchar_t>(scale));
+		_key.append(s);
+		auto it = _layouts.find(_key);
+		if (it != _layouts.end()) {
+			return &it->second;
+		}
+		size_t h = hash<wstring>{}(_key);
+		if (find(_recent.begin(), _recent.end(), h) == _recent.end()) {
+			_recent[_recent_next++ % _recent.size()] = h;
+			return nullptr;
+		}
+		if (_layouts.size() >= max_layouts) {
+			_layouts.clear();
+		}
+
+		layout l;
+		for_each_span(s, scale, [&l](int x, int y, int len) {
+			l.spans.push_back({ x, y, len });
+			l.max_len = max(l.max_len, len);
+		});
+		return &_layouts.emplace(_key, move(l)).first->second;
+	}
+
+	void font::reset_caches()
+	{
+		_glyph_spans.assign(_count, {});
+		_glyph_cached.assign(_count, 0);
+		_layouts.clear();
+		_recent.fill(0);
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace olc
+{
+	//
+	// Bitmap font for text bigger than one cell per character: titles, scores, timers.
+	//
+	// Glyphs are one bit per pixel, loaded once from a font file or taken from the built in 5x7 font for printable
+	// ascii. Each glyph is turned into horizontal runs of set pixels the first time it's drawn, and each string drawn
+	// again into the runs of all its glyphs at a given scale, kept until the cache fills up. Drawing a cached string
+	// is one draw_cells copy per run, with nothing to decode. A string drawn for the first time, such as a timer
+	// changing every frame, is drawn glyph by glyph instead and allocates nothing.
+	//
+	// Only the glyph pixels are written, the background shows through between them. '\n' starts a new line.
+	//
+	// File format, little endian: int32 glyph width, glyph height, first character and character count, then for
+	// every character glyph height rows of (glyph width + 7) / 8 bytes, the high bit of each byte the leftmost pixel.
+	//
+	class font
+	{
+	public:
+		// The built in 5x7 font, characters 32 to 126
+		font();
+		// Throws olc_exception if the file can't be loaded
+		explicit font(const std::wstring& file);
+
+		font(const font&) = delete;
+		font& operator=(const font&) = delete;
+
+		bool save(const std::wstring& file) const;
+		bool load(const std::wstring& file);
+
+		int glyph_width() const { return _glyph_w; }
+		int glyph_height() const { return _glyph_h; }
+
+		// Size of s drawn at scale, in cells. Characters are one font pixel apart, lines too.
+		int text_width(std::wstring_view s, int scale = 1) const;
+		int text_height(std::wstring_view s, int scale = 1) const;
+
+		// Top left of the text at x, y; every font pixel is drawn as scale x scale cells of c in color
+		void draw_string(cmd_engine& engine, int x, int y, std::wstring_view s, int scale = 1,
+			short color = color_t::fg_white, wchar_t c = pixel_type::solid);
+
+	private:
+		// a horizontal run of set pixels, relative to the top left of the glyph or string
+		struct span
+		{
+			int x;
+			int y;
+			int len;
+		};
+
+		struct layout
+		{
+			std::vector<span> spans;
+			int max_len{ 0 };
+		};
+
+		// glyph index of c, the '?' glyph or -1 if c isn't in the font
+		int glyph_index(wchar_t c) const;
+		const std::vector<span>& glyph_spans(int index);
+		// The cached layout of s at scale, made if s was drawn recently, otherwise nullptr
+		const layout* find_layout(std::wstring_view s, int scale);
+		// the cells to copy for runs up to len long
+		void prepare_ink(int len, short color, wchar_t c);
+
+		// calls f(x, y, len) for every run of s at scale, relative to its top left
+		template<typename F>
+		void for_each_span(std::wstring_view s, int scale, F&& f)
+		{
+			int pen_x = 0;
+			int pen_y = 0;
+			for (wchar_t c : s) {
+				if (c == L'\n') {
+					pen_x = 0;
+					pen_y += _glyph_h + 1;
+					continue;
+				}
+				int index = glyph_index(c);
+				if (index >= 0) {
+					for (const auto& g : glyph_spans(index)) {
+						for (int sy = 0; sy < scale; ++sy) {
+							f((pen_x + g.x) * scale, (pen_y + g.y) * scale + sy, g.len * scale);
+						}
+					}
+				}
+				pen_x += _glyph_w + 1;
+			}
+		}
+		void reset_caches();
+
+	private:
+		int _glyph_w{ 0 };
+		int _glyph_h{ 0 };
+		int _first{ 0 };
+		int _count{ 0 };
+		// glyph_h rows of (glyph_w + 7) / 8 bytes per glyph, as in the file
+		std::vector<uint8_t> _bitmap;
+
+		// runs of every glyph, built on first use
+		std::vector<std::vector<span>> _glyph_spans;
+		std::vector<uint8_t> _glyph_cached;
+
+		// keyed by the scale followed by the text; strings that change every frame would grow it forever, so it's
+		// emptied once it reaches max_layouts
+		static constexpr size_t max_layouts = 256;
+		std::unordered_map<std::wstring, layout> _layouts;
+		std::wstring _key;
+		// hashes of the keys last drawn without a layout, a string only gets one when it shows up again
+		std::array<size_t, 64> _recent{};
+		size_t _recent_next{ 0 };
+
+		// the cells every run is copied from
+		std::vector<CHAR_INFO> _ink;
+	};
+}
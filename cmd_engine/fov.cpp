@@ -0,0 +1,255 @@
+#include "fov.h"
+#include "cmd_engine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		int floor_div(int a, int b)
+		{
+			return a >= 0 ? a / b : -((-a + b - 1) / b);
+		}
+
+		int ceil_div(int a, int b)
+		{
+			return -floor_div(-a, b);
+		}
+
+		// quadrants scan outward north, east, south and west; depth is the distance out, col the offset across
+		grid_point transform(grid_point origin, int quadrant, int depth, int col)
+		{
+			switch (quadrant) {
+			case 0: return { origin.x + col, origin.y - depth };
+			case 1: return { origin.x + depth, origin.y + col };
+			case 2: return { origin.x + col, origin.y + depth };
+			default: return { origin.x - depth, origin.y + col };
+			}
+		}
+	}
+
+	//
+	// field_of_view class
+	//
+	field_of_view::field_of_view(const grid_map& map)
+		: _map{ map }, _stamps(static_cast<size_t>(map.width()) * map.height(), 0)
+	{
+	}
+
+	void field_of_view::compute(grid_point origin, int radius)
+	{
+		_visible.clear();
+		if (++_generation == 0) {
+			fill(_stamps.begin(), _stamps.end(), 0);
+			_generation = 1;
+		}
+		_origin = origin;
+		_radius = radius;
+		reveal(origin.x, origin.y);
+		for (int q = 0; q < 4; ++q) {
+			cast(q, 1, { -1, 1 }, { 1, 1 });
+		}
+	}
+
+	bool field_of_view::is_visible(int x, int y) const
+	{
+		if (x < 0 || x >= _map.width() || y < 0 || y >= _map.height()) {
+			return false;
+		}
+		return _stamps[y * _map.width() + x] == _generation;
+	}
+
+	void field_of_view::cast(int quadrant, int depth, slope start, slope end)
+	{
+		for (; depth <= _radius; ++depth) {
+			// the columns the slopes cover at this depth, rounding to the nearer cell center
+			int min_col = floor_div(2 * depth * start.num + start.den, 2 * start.den);
+			int max_col = ceil_div(2 * depth * end.num - end.den, 2 * end.den);
+			bool prev_wall = false;
+			bool prev_floor = false;
+			for (int col = min_col; col <= max_col; ++col) {
+				auto p = transform(_origin, quadrant, depth, col);
+				bool wall = !_map.passable(p.x, p.y);
+				// floor is seen only if its center is inside the slopes, which is what makes it symmetric
+				bool centered = col * start.den >= depth * start.num && col * end.den <= depth * end.num;
+				if ((wall || centered) && col * col + depth * depth <= _radius * _radius + _radius) {
+					reveal(p.x, p.y);
+				}
+				slope edge{ 2 * col - 1, 2 * depth };
+				if (prev_wall && !wall) {
+					start = edge;
+				}
+				if (prev_floor && wall) {
+					// what's past the floor before this wall
+					cast(quadrant, depth + 1, start, edge);
+				}
+				prev_wall = wall;
+				prev_floor = !wall;
+			}
+			if (!prev_floor) {
+				// the row ended in a wall, everything past it was handed to the recursions
+				return;
+			}
+		}
+	}
+
+	void field_of_view::reveal(int x, int y)
+	{
+		if (x < 0 || x >= _map.width() || y < 0 || y >= _map.height()) {
+			return;
+		}
+		// cells on the diagonals are scanned by two quadrants
+		auto& stamp = _stamps[y * _map.width() + x];
+		if (stamp != _generation) {
+			stamp = _generation;
+			_visible.push_back({ x, y });
+		}
+	}
+
+	//
+	// light_map class
+	//
+	light_map::light_map(const grid_map& map)
+		: _map{ map }, _fov{ map }, _light(static_cast<size_t>(map.width()) * map.height(), light_color{ 0.0f, 0.0f, 0.0f })
+	{
+	}
+
+	light_map::light_id light_map::add(grid_point at, int radius, light_color color)
+	{
+		light_id id;
+		if (!_free.empty()) {
+			id = _free.back();
+			_free.pop_back();
+		}
+		else {
+			id = static_cast<light_id>(_lights.size());
+			_lights.emplace_back();
+		}
+		auto& l = _lights[id];
+		l.at = at;
+		l.radius = radius;
+		l.color = color;
+		l.alive = true;
+		l.stale = true;
+		_changed = true;
+		return id;
+	}
+
+	void light_map::move(light_id id, grid_point at)
+	{
+		auto& l = _lights[id];
+		if (l.at != at) {
+			l.at = at;
+			l.stale = true;
+			_changed = true;
+		}
+	}
+
+	void light_map::set_color(light_id id, light_color color)
+	{
+		// the cells it reaches stay the same
+		_lights[id].color = color;
+		_changed = true;
+	}
+
+	void light_map::remove(light_id id)
+	{
+		// its cells are darkened on the next update
+		auto& l = _lights[id];
+		l.alive = false;
+		_free.push_back(id);
+		_changed = true;
+	}
+
+	void light_map::invalidate(int x, int y)
+	{
+		for (auto& l : _lights) {
+			if (l.alive && !l.stale && max(abs(x - l.at.x), abs(y - l.at.y)) <= l.radius) {
+				l.stale = true;
+				_changed = true;
+			}
+		}
+	}
+
+	void light_map::update()
+	{
+		if (!_changed) {
+			return;
+		}
+		_changed = false;
+
+		// only what was lit needs darkening, not the whole map
+		for (auto& l : _lights) {
+			for (const auto& c : l.cells) {
+				_light[c.index] = { 0.0f, 0.0f, 0.0f };
+			}
+			if (!l.alive) {
+				l.cells.clear();
+			}
+		}
+
+		int w = _map.width();
+		for (auto& l : _lights) {
+			if (!l.alive || !l.stale) {
+				continue;
+			}
+			l.stale = false;
+			l.cells.clear();
+			_fov.compute(l.at, l.radius);
+			float scale = 1.0f / static_cast<float>(l.radius + 1);
+			for (auto p : _fov.visible()) {
+				float d = sqrtf(static_cast<float>((p.x - l.at.x) * (p.x - l.at.x) + (p.y - l.at.y) * (p.y - l.at.y)));
+				float intensity = 1.0f - d * scale;
+				if (intensity > 0.0f) {
+					l.cells.push_back({ static_cast<uint32_t>(p.y * w + p.x), intensity });
+				}
+			}
+		}
+
+		for (const auto& l : _lights) {
+			if (!l.alive) {
+				continue;
+			}
+			for (const auto& c : l.cells) {
+				auto& sum = _light[c.index];
+				sum.r += l.color.r * c.intensity;
+				sum.g += l.color.g * c.intensity;
+				sum.b += l.color.b * c.intensity;
+			}
+		}
+	}
+
+	light_color light_map::at(int x, int y) const
+	{
+		if (x < 0 || x >= _map.width() || y < 0 || y >= _map.height()) {
+			return { 0.0f, 0.0f, 0.0f };
+		}
+		return _light[y * _map.width() + x];
+	}
+
+	void light_map::shade(int x, int y, wchar_t& glyph, short& color) const
+	{
+		auto c = at(x, y);
+		float brightness = max({ c.r, c.g, c.b });
+		if (brightness < 0.05f) {
+			glyph = L' ';
+			color = color_t::fg_black;
+			return;
+		}
+		glyph = brightness < 0.25f ? pixel_type::quarter
+			: brightness < 0.5f ? pixel_type::half
+			: brightness < 0.75f ? pixel_type::threequarters
+			: pixel_type::solid;
+		// the channels at least half as strong as the strongest, bright once it's well lit
+		short hue = 0;
+		hue |= c.r >= brightness * 0.5f ? color_t::fg_dark_red : 0;
+		hue |= c.g >= brightness * 0.5f ? color_t::fg_dark_green : 0;
+		hue |= c.b >= brightness * 0.5f ? color_t::fg_dark_blue : 0;
+		// the intensity bit
+		color = hue | (brightness >= 0.5f ? color_t::fg_dark_grey : 0);
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "pathfinding.h"
+#include <cstdint>
+#include <vector>
+
+namespace olc
+{
+	//
+	// The cells of a grid_map visible from a point, by symmetric shadowcasting: light passes through passable cells,
+	// the others block it but are seen themselves, like walls. Floor cells see each other both ways, and there are
+	// no artifacts around pillars or along walls.
+	//
+	// Scans each quadrant a row at a time outward, narrowing the visible slope range at every wall edge and recursing
+	// for the part behind a wall, so it only touches visible cells and the walls bounding them. The buffers are kept,
+	// computing again doesn't allocate once grown.
+	//
+	class field_of_view
+	{
+	public:
+		// The map is referenced, not copied, and may change between computes but not its size
+		explicit field_of_view(const grid_map& map);
+
+		// Finds the cells visible from origin within radius, origin included
+		void compute(grid_point origin, int radius);
+
+		// In no particular order, each once
+		const std::vector<grid_point>& visible() const { return _visible; }
+		bool is_visible(int x, int y) const;
+
+	private:
+		// a rational slope, den always positive
+		struct slope
+		{
+			int num;
+			int den;
+		};
+
+		void cast(int quadrant, int depth, slope start, slope end);
+		void reveal(int x, int y);
+
+	private:
+		const grid_map& _map;
+		grid_point _origin{ 0, 0 };
+		int _radius{ 0 };
+		std::vector<grid_point> _visible;
+		// cells revealed by the last compute carry its generation
+		std::vector<uint32_t> _stamps;
+		uint32_t _generation{ 0 };
+	};
+
+	struct light_color
+	{
+		float r;
+		float g;
+		float b;
+	};
+
+	//
+	// Light from any number of colored point lights summed over a grid_map, each falling off linearly to nothing at
+	// its radius and blocked like sight.
+	//
+	// What each light reaches is kept, and only computed again when the light moves or the map changes within its
+	// radius (tell it with invalidate), so many lights cost little more than adding them up each update.
+	//
+	class light_map
+	{
+	public:
+		using light_id = uint32_t;
+
+	public:
+		// The map is referenced, not copied
+		explicit light_map(const grid_map& map);
+
+		light_id add(grid_point at, int radius, light_color color);
+		void move(light_id id, grid_point at);
+		void set_color(light_id id, light_color color);
+		void remove(light_id id);
+		// The cell at (x, y) changed in the map, lights within reach of it are recomputed on the next update
+		void invalidate(int x, int y);
+
+		// Recomputes the lights that need it and sums them all, nothing to do if no light changed since the last one
+		void update();
+
+		// The summed light at (x, y), black outside the map
+		light_color at(int x, int y) const;
+		// The light at (x, y) as a console cell: a shade glyph for its brightness and the nearest console color
+		void shade(int x, int y, wchar_t& glyph, short& color) const;
+
+	private:
+		struct lit_cell
+		{
+			uint32_t index;
+			float intensity;
+		};
+
+		struct light
+		{
+			grid_point at;
+			int radius;
+			light_color color;
+			bool alive;
+			// its cells need computing again
+			bool stale;
+			std::vector<lit_cell> cells;
+		};
+
+	private:
+		const grid_map& _map;
+		field_of_view _fov;
+		std::vector<light> _lights;
+		std::vector<light_id> _free;
+		std::vector<light_color> _light;
+		bool _changed{ false };
+	};
+}
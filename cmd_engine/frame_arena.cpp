@@ -0,0 +1,51 @@
+#include "frame_arena.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		size_t align_up(size_t n, size_t alignment)
+		{
+			return (n + alignment - 1) & ~(alignment - 1);
+		}
+	}
+
+	frame_arena::frame_arena(size_t capacity)
+		: _buf{ make_unique<byte[]>(capacity) }
+		, _capacity{ capacity }
+	{
+	}
+
+	void* frame_arena::allocate(size_t bytes, size_t alignment)
+	{
+		// align the address rather than the offset, new[] only guarantees max_align_t
+		auto base = reinterpret_cast<uintptr_t>(_buf.get());
+		size_t start = align_up(base + _offset, alignment) - base;
+		if (start + bytes <= _capacity) {
+			_offset = start + bytes;
+			return _buf.get() + start;
+		}
+
+		// doesn't fit, fall back to the heap for the rest of the frame
+		auto& block = _overflow.emplace_back(make_unique<byte[]>(bytes + alignment));
+		_overflow_bytes += bytes;
+		auto p = reinterpret_cast<uintptr_t>(block.get());
+		return reinterpret_cast<void*>(align_up(p, alignment));
+	}
+
+	void frame_arena::reset()
+	{
+		_peak = max(_peak, used());
+		if (!_overflow.empty()) {
+			// grow to the peak so the overflow doesn't happen again
+			_overflow.clear();
+			_capacity = max(_peak, _capacity * 2);
+			_buf = make_unique<byte[]>(_capacity);
+		}
+		_offset = 0;
+		_overflow_bytes = 0;
+	}
+}
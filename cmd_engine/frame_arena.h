@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace olc
+{
+	//
+	// Linear allocator for memory that only lives for one frame.
+	//
+	// Allocating is a pointer bump and nothing is freed individually, the whole arena is reset at the end of the frame.
+	// A frame that needs more than the capacity still gets its memory from the heap, and the next reset grows the
+	// buffer to the peak so the steady state frame doesn't touch the heap at all.
+	// Not thread safe, it belongs to the game thread.
+	//
+	class frame_arena
+	{
+	public:
+		static constexpr size_t default_capacity = 256 * 1024;
+
+		explicit frame_arena(size_t capacity = default_capacity);
+
+		frame_arena(const frame_arena&) = delete;
+		frame_arena& operator=(const frame_arena&) = delete;
+
+		void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+		// Memory for n T's, left uninitialized. T must not need a destructor, none is ever called.
+		template<typename T>
+		T* allocate_array(size_t n)
+		{
+			static_assert(std::is_trivially_destructible_v<T>, "frame_arena never runs destructors");
+			return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+		}
+
+		// Frees everything allocated since the last reset
+		void reset();
+
+		// bytes handed out since the last reset
+		size_t used() const { return _offset + _overflow_bytes; }
+		// highest used() seen at a reset
+		size_t peak() const { return _peak; }
+		size_t capacity() const { return _capacity; }
+
+	private:
+		std::unique_ptr<std::byte[]> _buf;
+		size_t _capacity;
+		size_t _offset{ 0 };
+		size_t _peak{ 0 };
+
+		// allocations that didn't fit in _buf this frame
+		std::vector<std::unique_ptr<std::byte[]>> _overflow;
+		size_t _overflow_bytes{ 0 };
+	};
+
+	//
+	// Lets std::pmr containers allocate from a frame_arena, e.g. std::pmr::vector<int> v{ frame_resource() }.
+	// Deallocation does nothing, so the container must not outlive the frame.
+	//
+	class frame_arena_resource : public std::pmr::memory_resource
+	{
+	public:
+		explicit frame_arena_resource(frame_arena& arena) : _arena{ arena } {}
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override { return _arena.allocate(bytes, alignment); }
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	private:
+		frame_arena& _arena;
+	};
+}
@@ -0,0 +1,193 @@
+#include "game_module.h"
+#include "script.h"
+#include <filesystem>
+#include <functional>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		constexpr const char* g_api_symbol = "olc_game_api";
+		// a new build must keep its file time this long before it's loaded
+		constexpr chrono::milliseconds g_settle_time{ 300 };
+		// frame time between checks of the module file
+		constexpr float g_poll_interval = 0.25f;
+	}
+
+	//
+	// game_module class
+	//
+	game_module::game_module(const wstring& path)
+		: _path{ filesystem::absolute(path).wstring() }
+	{
+		wstring error;
+		if (!load(error)) {
+			throw olc_exception(error);
+		}
+	}
+
+	game_module::~game_module()
+	{
+		unload();
+	}
+
+	bool game_module::write_time(uint64_t& t) const
+	{
+		WIN32_FILE_ATTRIBUTE_DATA data;
+		if (!GetFileAttributesExW(_path.c_str(), GetFileExInfoStandard, &data)) {
+			return false;
+		}
+		t = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+		return true;
+	}
+
+	bool game_module::load(wstring& error)
+	{
+		uint64_t t;
+		if (!write_time(t)) {
+			error = L"Can't find game module "s + _path;
+			return false;
+		}
+
+		// load a copy, the linker must be able to overwrite the dll while it's loaded
+		auto live_path = filesystem::path(_path).replace_extension(L".live" + to_wstring(_generation + 1) + L".dll").wstring();
+		if (!CopyFileW(_path.c_str(), live_path.c_str(), FALSE)) {
+			// most likely still being written, tried again on the next change check
+			error = L"Can't copy game module "s + _path;
+			return false;
+		}
+		HMODULE module = LoadLibraryW(live_path.c_str());
+		using get_api_fn = const game_api* (*)();
+		auto get_api = module ? reinterpret_cast<get_api_fn>(GetProcAddress(module, g_api_symbol)) : nullptr;
+		const game_api* api = get_api ? get_api() : nullptr;
+		if (!api || api->abi != game_api::current_abi || !api->init || !api->update) {
+			error = module
+				? L"Game module "s + _path + L" doesn't export a matching olc_game_api"
+				: L"Can't load game module "s + _path;
+			if (module) {
+				FreeLibrary(module);
+			}
+			DeleteFileW(live_path.c_str());
+			// broken build, wait for the next one
+			_loaded_time = t;
+			return false;
+		}
+
+		_module = module;
+		_live_path = live_path;
+		_api = api;
+		_loaded_time = t;
+		_seen_time = t;
+		++_generation;
+		return true;
+	}
+
+	void game_module::unload()
+	{
+		if (_module) {
+			FreeLibrary(_module);
+			DeleteFileW(_live_path.c_str());
+			_module = nullptr;
+			_api = nullptr;
+		}
+	}
+
+	bool game_module::changed()
+	{
+		uint64_t t;
+		if (!write_time(t) || t == _loaded_time) {
+			_seen_time = _loaded_time;
+			return false;
+		}
+		auto now = chrono::steady_clock::now();
+		if (t != _seen_time) {
+			_seen_time = t;
+			_seen_at = now;
+			return false;
+		}
+		return now - _seen_at >= g_settle_time;
+	}
+
+	bool game_module::reload(const function<void(const game_api& old_api)>& retire)
+	{
+		// the new build loads next to the old one, which only goes once the new one is in
+		auto old_module = _module;
+		auto old_live_path = _live_path;
+		auto old_api = _api;
+		wstring error;
+		if (!load(error)) {
+			OutputDebugString((error + L", keeping the previous build\n").c_str());
+			return false;
+		}
+		retire(*old_api);
+		FreeLibrary(old_module);
+		DeleteFileW(old_live_path.c_str());
+		return true;
+	}
+
+	//
+	// game_host class
+	//
+	game_host::game_host(const wstring& module_path)
+		: _module{ module_path }
+	{
+		update_title();
+	}
+
+	bool game_host::on_user_init()
+	{
+		// created by the host, so their threads and memory never belong to a module that gets unloaded
+		jobs();
+		scripts();
+
+		const auto& api = _module.api();
+		_state_size = api.state_size;
+		_state_version = api.state_version;
+		_state = make_unique<byte[]>(_state_size);
+		return api.init(*this, _state.get(), false);
+	}
+
+	bool game_host::on_user_update(float elapsed)
+	{
+		_since_poll += elapsed;
+		if (_since_poll >= g_poll_interval) {
+			_since_poll = 0.0f;
+			if (_module.changed() && !hot_reload()) {
+				return false;
+			}
+		}
+		return _module.api().update(*this, _state.get(), elapsed);
+	}
+
+	bool game_host::hot_reload()
+	{
+		bool reloaded = _module.reload([this](const game_api& old_api) {
+			// suspended scripts would resume into the old build's code
+			scripts().clear();
+			if (old_api.unload) {
+				old_api.unload(*this, _state.get());
+			}
+		});
+		if (!reloaded) {
+			return true;
+		}
+
+		const auto& api = _module.api();
+		bool keep_state = api.state_size == _state_size && api.state_version == _state_version;
+		if (!keep_state) {
+			_state_size = api.state_size;
+			_state_version = api.state_version;
+			_state = make_unique<byte[]>(_state_size);
+		}
+		update_title();
+		OutputDebugString(keep_state ? L"game module reloaded\n" : L"game module reloaded, state layout changed, starting over\n");
+		return api.init(*this, _state.get(), keep_state);
+	}
+
+	void game_host::update_title()
+	{
+		_app_name = filesystem::path(_module.path()).stem().wstring() + L" build " + to_wstring(_module.generation());
+	}
+}
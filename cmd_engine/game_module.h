@@ -0,0 +1,125 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#define OLC_GAME_EXPORT extern "C" __declspec(dllexport)
+
+namespace olc
+{
+	//
+	// What a game module dll hands to game_host. The module exports
+	//
+	//     OLC_GAME_EXPORT const olc::game_api* olc_game_api();
+	//
+	// returning a game_api that lives as long as the dll.
+	//
+	// Everything the game keeps from frame to frame goes in the state block, which the host owns and keeps across
+	// reloads. It's handed over as raw bytes, so it mustn't hold anything that points into the module: no virtual
+	// functions, function pointers, lambdas or string literals. Heap memory is fine, module and host share the CRT.
+	// Coroutine scripts are code of the module, the host clears them before every reload.
+	//
+	// Static and thread local variables are not shared though: the module links its own copy of the engine code,
+	// whose globals only its own calls see and whose thread locals the host's threads never set up. engine.jobs() is
+	// safe, job_system dispatches through the host's vtable (see job_system); anything else the engine keeps per
+	// thread must be called from the host.
+	//
+	struct game_api
+	{
+		// bumped when this struct changes, modules built against another one aren't loaded
+		static constexpr uint32_t current_abi = 3;
+
+		uint32_t abi;
+		// size of the state block and a version the module bumps when its layout changes. If either differs from
+		// the build before, the reloaded module starts over on a fresh block.
+		size_t state_size;
+		uint32_t state_version;
+
+		// state is zeroed when fresh, after a reload it holds what the previous build left in it
+		bool (*init)(cmd_engine& engine, void* state, bool reloaded);
+		bool (*update)(cmd_engine& engine, void* state, float elapsed);
+		// called before the module is unloaded, may be null
+		void (*unload)(cmd_engine& engine, void* state);
+	};
+
+	//
+	// Loads a game module dll and reloads it when the file changes.
+	//
+	// The dll is copied next to itself and the copy loaded, so the original stays writable for the linker while the
+	// game runs. A new build is picked up once its file time has been stable for a moment, the linker writes it in
+	// several goes. If it fails to load the previous build keeps running.
+	//
+	// Debug builds of a module should give each link its own pdb name, the debugger keeps the loaded one open.
+	//
+	class game_module
+	{
+	public:
+		// Throws olc_exception if the dll can't be loaded or doesn't export a matching olc_game_api
+		explicit game_module(const std::wstring& path);
+		~game_module();
+
+		game_module(const game_module&) = delete;
+		game_module& operator=(const game_module&) = delete;
+
+		const game_api& api() const { return *_api; }
+		// number of times loaded, 1 for the first build
+		unsigned generation() const { return _generation; }
+		const std::wstring& path() const { return _path; }
+
+		// True if the file changed since the last load and was stable long enough for a reload
+		bool changed();
+		// Loads the file again, then calls retire with the previous build still loaded and unloads it.
+		// Returns false, still on the previous build, if the new one fails to load.
+		bool reload(const std::function<void(const game_api& old_api)>& retire);
+
+	private:
+		bool load(std::wstring& error);
+		void unload();
+		bool write_time(uint64_t& t) const;
+
+	private:
+		std::wstring _path;
+		std::wstring _live_path;
+		HMODULE _module{ nullptr };
+		const game_api* _api{ nullptr };
+		unsigned _generation{ 0 };
+
+		// file time of the loaded build, and of a newer one seen since
+		uint64_t _loaded_time{ 0 };
+		uint64_t _seen_time{ 0 };
+		std::chrono::steady_clock::time_point _seen_at;
+	};
+
+	//
+	// Runs a game module as the engine's game, reloading it whenever it's rebuilt. The console and the game state
+	// survive the reload, so a change to the update code shows up in the running game within a frame or so.
+	//
+	class game_host : public cmd_engine
+	{
+	public:
+		explicit game_host(const std::wstring& module_path);
+
+		// Inherited via cmd_engine
+		virtual bool on_user_init() override;
+		virtual bool on_user_update(float elapsed) override;
+
+	private:
+		// false if the new build's init failed
+		bool hot_reload();
+		void update_title();
+
+	private:
+		game_module _module;
+		// the game's state, owned here so it outlives any one build of the module
+		std::unique_ptr<std::byte[]> _state;
+		size_t _state_size{ 0 };
+		uint32_t _state_version{ 0 };
+		// frame time since the module file was last checked
+		float _since_poll{ 0.0f };
+	};
+}
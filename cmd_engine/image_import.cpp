@@ -0,0 +1,415 @@
+#include "image_import.h"
+#include "job_system.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <emmintrin.h>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		// the default console palette, in color_t order
+		constexpr uint8_t g_palette[16][3] = {
+			{ 0, 0, 0 }, { 0, 0, 128 }, { 0, 128, 0 }, { 0, 128, 128 },
+			{ 128, 0, 0 }, { 128, 0, 128 }, { 128, 128, 0 }, { 192, 192, 192 },
+			{ 128, 128, 128 }, { 0, 0, 255 }, { 0, 255, 0 }, { 0, 255, 255 },
+			{ 255, 0, 0 }, { 255, 0, 255 }, { 255, 255, 0 }, { 255, 255, 255 },
+		};
+
+		struct candidate
+		{
+			int rgb[3];
+			wchar_t glyph;
+			short color;
+		};
+
+		//
+		// Every color a cell can show, and the closest of them for every 5:5:5 rgb value
+		//
+		struct palette_lut
+		{
+			vector<candidate> candidates;
+			vector<uint16_t> nearest;
+
+			palette_lut()
+			{
+				// solid cells, and foreground shaded over a different background
+				for (int c = 0; c < 16; ++c) {
+					candidates.push_back({ { g_palette[c][0], g_palette[c][1], g_palette[c][2] },
+						pixel_type::solid, static_cast<short>(c | (c << 4)) });
+				}
+				const pair<wchar_t, int> shades[] = {
+					{ pixel_type::quarter, 1 }, { pixel_type::half, 2 }, { pixel_type::threequarters, 3 } };
+				for (int fg = 0; fg < 16; ++fg) {
+					for (int bg = 0; bg < 16; ++bg) {
+						if (fg == bg) {
+							continue;
+						}
+						for (auto [glyph, quarters] : shades) {
+							candidate cand{ {}, glyph, static_cast<short>(fg | (bg << 4)) };
+							for (int ch = 0; ch < 3; ++ch) {
+								cand.rgb[ch] = (g_palette[fg][ch] * quarters + g_palette[bg][ch] * (4 - quarters)) / 4;
+							}
+							candidates.push_back(cand);
+						}
+					}
+				}
+
+				nearest.resize(32 * 32 * 32);
+				for (int i = 0; i < 32 * 32 * 32; ++i) {
+					// middle of the 8 values each 5 bit step stands for
+					int r = ((i >> 10) << 3) + 4;
+					int g = (((i >> 5) & 31) << 3) + 4;
+					int b = ((i & 31) << 3) + 4;
+					int best = 0;
+					int best_dist = INT_MAX;
+					for (int c = 0; c < static_cast<int>(candidates.size()); ++c) {
+						int d = distance(candidates[c], r, g, b);
+						if (d < best_dist) {
+							best_dist = d;
+							best = c;
+						}
+					}
+					nearest[i] = static_cast<uint16_t>(best);
+				}
+			}
+
+			// green weighs most, blue least, as the eye sees them
+			static int distance(const candidate& c, int r, int g, int b)
+			{
+				int dr = c.rgb[0] - r;
+				int dg = c.rgb[1] - g;
+				int db = c.rgb[2] - b;
+				return 2 * dr * dr + 4 * dg * dg + 3 * db * db;
+			}
+
+			const candidate& lookup(int r5, int g5, int b5) const
+			{
+				return candidates[nearest[(r5 << 10) | (g5 << 5) | b5]];
+			}
+		};
+
+		const palette_lut& lut()
+		{
+			static const palette_lut l;
+			return l;
+		}
+
+		// 4x4 bayer matrix, spread to plus or minus 30 which is about half the gap between neighbouring blends;
+		// wider spreads measured worse over 8x8 block averages
+		constexpr int g_bayer[4][4] = {
+			{ 0, 8, 2, 10 },
+			{ 12, 4, 14, 6 },
+			{ 3, 11, 1, 9 },
+			{ 15, 7, 13, 5 },
+		};
+		constexpr int g_bayer_spread = 2;
+
+		// rgb bytes plus offsets, clamped and cut down to 5 bits, 16 bytes per step
+		void quantize_row(const uint8_t* src, const int16_t* offsets, uint8_t* q, int n)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i max_value = _mm_set1_epi16(255);
+			int i = 0;
+			for (; i + 16 <= n; i += 16) {
+				__m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(px, zero), _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets + i)));
+				__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(px, zero), _mm_loadu_si128(reinterpret_cast<const __m128i*>(offsets + i + 8)));
+				lo = _mm_srli_epi16(_mm_min_epi16(_mm_max_epi16(lo, zero), max_value), 3);
+				hi = _mm_srli_epi16(_mm_min_epi16(_mm_max_epi16(hi, zero), max_value), 3);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(q + i), _mm_packus_epi16(lo, hi));
+			}
+			for (; i < n; ++i) {
+				q[i] = static_cast<uint8_t>(clamp(src[i] + offsets[i], 0, 255) >> 3);
+			}
+		}
+
+		// the bayer offsets of one row, repeated to fill 8 lanes
+		__m128i bayer_row(int y)
+		{
+			const int* row = g_bayer[y & 3];
+			auto offset = [](int b) { return static_cast<short>((b * 2 - 15) * g_bayer_spread); };
+			return _mm_setr_epi16(offset(row[0]), offset(row[1]), offset(row[2]), offset(row[3]),
+				offset(row[0]), offset(row[1]), offset(row[2]), offset(row[3]));
+		}
+
+		void convert_quantized(const image& img, sprite& spr, int y0, int y1, dither_mode::enum_t mode)
+		{
+			const auto& l = lut();
+			int n = img.width * 3;
+			// one offset per byte for each of the 4 bayer rows, all 0 without dithering
+			vector<int16_t> offsets(static_cast<size_t>(n) * 4, 0);
+			if (mode == dither_mode::ordered) {
+				for (int row = 0; row < 4; ++row) {
+					for (int x = 0; x < img.width; ++x) {
+						int16_t offset = static_cast<int16_t>((g_bayer[row][x & 3] * 2 - 15) * g_bayer_spread);
+						fill_n(offsets.begin() + row * n + x * 3, 3, offset);
+					}
+				}
+			}
+			vector<uint8_t> q(n);
+			for (int y = y0; y < y1; ++y) {
+				int row = (mode == dither_mode::ordered) ? (y & 3) : 0;
+				quantize_row(img.rgb.data() + static_cast<size_t>(y) * n, offsets.data() + row * n, q.data(), n);
+				for (int x = 0; x < img.width; ++x) {
+					const auto& c = l.lookup(q[x * 3], q[x * 3 + 1], q[x * 3 + 2]);
+					spr.set_glyph(x, y, c.glyph);
+					spr.set_color(x, y, c.color);
+				}
+			}
+		}
+
+		void convert_floyd_steinberg(const image& img, sprite& spr, int y0, int y1)
+		{
+			const auto& l = lut();
+			int w = img.width;
+			// error carried into this and the next row, 16 times the real value, one pixel of padding either side
+			vector<int> cur((w + 2) * 3, 0);
+			vector<int> next((w + 2) * 3, 0);
+			for (int y = y0; y < y1; ++y) {
+				const uint8_t* src = img.rgb.data() + static_cast<size_t>(y) * w * 3;
+				for (int x = 0; x < w; ++x) {
+					int v[3];
+					for (int ch = 0; ch < 3; ++ch) {
+						v[ch] = clamp(src[x * 3 + ch] + cur[(x + 1) * 3 + ch] / 16, 0, 255);
+					}
+					const auto& c = l.lookup(v[0] >> 3, v[1] >> 3, v[2] >> 3);
+					spr.set_glyph(x, y, c.glyph);
+					spr.set_color(x, y, c.color);
+					for (int ch = 0; ch < 3; ++ch) {
+						int e = v[ch] - c.rgb[ch];
+						cur[(x + 2) * 3 + ch] += e * 7;
+						next[x * 3 + ch] += e * 3;
+						next[(x + 1) * 3 + ch] += e * 5;
+						next[(x + 2) * 3 + ch] += e;
+					}
+				}
+				swap(cur, next);
+				fill(next.begin(), next.end(), 0);
+			}
+		}
+
+		//
+		// PNM header tokens are separated by whitespace and may be interleaved with # comments
+		//
+		struct pnm_reader
+		{
+			const vector<uint8_t>& data;
+			size_t pos{ 0 };
+
+			void skip_space()
+			{
+				while (pos < data.size()) {
+					if (data[pos] == '#') {
+						while (pos < data.size() && data[pos] != '\n') {
+							++pos;
+						}
+					}
+					else if (isspace(data[pos])) {
+						++pos;
+					}
+					else {
+						break;
+					}
+				}
+			}
+
+			bool number(int& value)
+			{
+				skip_space();
+				if (pos >= data.size() || !isdigit(data[pos])) {
+					return false;
+				}
+				int64_t v = 0;
+				while (pos < data.size() && isdigit(data[pos]) && v <= INT_MAX) {
+					v = v * 10 + (data[pos++] - '0');
+				}
+				if (v > INT_MAX) {
+					return false;
+				}
+				value = static_cast<int>(v);
+				return true;
+			}
+		};
+	}
+
+	bool load_pnm(const wstring& file, image& img)
+	{
+		FILE* f{ nullptr };
+		_wfopen_s(&f, file.c_str(), L"rb");
+		if (!f) {
+			return false;
+		}
+		vector<uint8_t> data;
+		uint8_t buf[64 * 1024];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+			data.insert(data.end(), buf, buf + n);
+		}
+		fclose(f);
+
+		if (data.size() < 2 || data[0] != 'P') {
+			return false;
+		}
+		char kind = static_cast<char>(data[1]);
+		bool binary = kind == '5' || kind == '6';
+		bool grey = kind == '2' || kind == '5';
+		if (!binary && kind != '2' && kind != '3') {
+			return false;
+		}
+		pnm_reader r{ data, 2 };
+		int w, h, maxval;
+		if (!r.number(w) || !r.number(h) || !r.number(maxval) || w <= 0 || h <= 0 || maxval <= 0 || maxval > 65535) {
+			return false;
+		}
+		int channels = grey ? 1 : 3;
+		size_t samples = static_cast<size_t>(w) * h * channels;
+		if (samples / channels / h != static_cast<size_t>(w)) {
+			return false;
+		}
+		// checked against the file before allocating, so a header claiming a huge image can't ask for the memory
+		size_t start = r.pos + 1;
+		size_t bytes_per_sample = maxval < 256 ? 1 : 2;
+		size_t available = 0;
+		if (binary) {
+			// exactly one whitespace byte between the header and the samples
+			available = start <= data.size() ? (data.size() - start) / bytes_per_sample : 0;
+		}
+		else {
+			// a separator and at least one digit each
+			available = (data.size() - r.pos) / 2;
+		}
+		if (available < samples) {
+			return false;
+		}
+
+		vector<uint8_t> rgb(static_cast<size_t>(w) * h * 3);
+		auto scale = [maxval](int v) {
+			return static_cast<uint8_t>((min(v, maxval) * 255 + maxval / 2) / maxval);
+		};
+		auto store = [&](size_t i, int v) {
+			if (grey) {
+				fill_n(rgb.begin() + i * 3, 3, scale(v));
+			}
+			else {
+				rgb[i] = scale(v);
+			}
+		};
+		if (binary) {
+			const uint8_t* p = data.data() + start;
+			for (size_t i = 0; i < samples; ++i) {
+				int v = bytes_per_sample == 1 ? p[i] : (p[i * 2] << 8) | p[i * 2 + 1];
+				store(i, v);
+			}
+		}
+		else {
+			for (size_t i = 0; i < samples; ++i) {
+				int v;
+				if (!r.number(v)) {
+					return false;
+				}
+				store(i, v);
+			}
+		}
+
+		img.width = w;
+		img.height = h;
+		img.rgb = move(rgb);
+		return true;
+	}
+
+	image resize_image(const image& img, int w, int h)
+	{
+		image out;
+		if (w <= 0 || h <= 0 || img.width <= 0 || img.height <= 0) {
+			return out;
+		}
+		out.width = w;
+		out.height = h;
+		out.rgb.resize(static_cast<size_t>(w) * h * 3);
+		for (int y = 0; y < h; ++y) {
+			// source rows and columns under this pixel, at least one when growing
+			int sy0 = static_cast<int>(static_cast<int64_t>(y) * img.height / h);
+			int sy1 = max(sy0 + 1, static_cast<int>(static_cast<int64_t>(y + 1) * img.height / h));
+			for (int x = 0; x < w; ++x) {
+				int sx0 = static_cast<int>(static_cast<int64_t>(x) * img.width / w);
+				int sx1 = max(sx0 + 1, static_cast<int>(static_cast<int64_t>(x + 1) * img.width / w));
+				uint64_t sum[3] = {};
+				for (int sy = sy0; sy < sy1; ++sy) {
+					const uint8_t* p = img.rgb.data() + (static_cast<size_t>(sy) * img.width + sx0) * 3;
+					for (int sx = sx0; sx < sx1; ++sx, p += 3) {
+						sum[0] += p[0];
+						sum[1] += p[1];
+						sum[2] += p[2];
+					}
+				}
+				uint64_t count = static_cast<uint64_t>(sy1 - sy0) * (sx1 - sx0);
+				uint8_t* dst = out.rgb.data() + (static_cast<size_t>(y) * w + x) * 3;
+				for (int ch = 0; ch < 3; ++ch) {
+					dst[ch] = static_cast<uint8_t>((sum[ch] + count / 2) / count);
+				}
+			}
+		}
+		return out;
+	}
+
+	void rgb_to_cells(const uint8_t* r, const uint8_t* g, const uint8_t* b, int n, int y, bool dither, CHAR_INFO* cells)
+	{
+		const auto& l = lut();
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i max_value = _mm_set1_epi16(255);
+		const __m128i offset = dither ? bayer_row(y) : zero;
+		auto quantize = [&](const uint8_t* p) {
+			__m128i v = _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero), offset);
+			return _mm_srli_epi16(_mm_min_epi16(_mm_max_epi16(v, zero), max_value), 3);
+		};
+		alignas(16) uint16_t index[8];
+		int x = 0;
+		for (; x + 8 <= n; x += 8) {
+			// table index r:g:b at 5 bits each, 8 pixels at a time; the table lookups can't be vectorized
+			__m128i i = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(quantize(r + x), 10), _mm_slli_epi16(quantize(g + x), 5)), quantize(b + x));
+			_mm_store_si128(reinterpret_cast<__m128i*>(index), i);
+			for (int k = 0; k < 8; ++k) {
+				const auto& c = l.candidates[l.nearest[index[k]]];
+				cells[x + k].Char.UnicodeChar = c.glyph;
+				cells[x + k].Attributes = c.color;
+			}
+		}
+		for (; x < n; ++x) {
+			int o = dither ? (g_bayer[y & 3][x & 3] * 2 - 15) * g_bayer_spread : 0;
+			const auto& c = l.lookup(clamp(r[x] + o, 0, 255) >> 3, clamp(g[x] + o, 0, 255) >> 3, clamp(b[x] + o, 0, 255) >> 3);
+			cells[x].Char.UnicodeChar = c.glyph;
+			cells[x].Attributes = c.color;
+		}
+	}
+
+	sprite image_to_sprite(const image& img, dither_mode::enum_t mode, job_system* jobs)
+	{
+		sprite spr(img.width, img.height);
+		auto convert = [&](int y0, int y1) {
+			if (mode == dither_mode::floyd_steinberg) {
+				convert_floyd_steinberg(img, spr, y0, y1);
+			}
+			else {
+				convert_quantized(img, spr, y0, y1, mode);
+			}
+		};
+		// bands stay a multiple of the bayer height, and tall enough that restarting the error diffusion is
+		// lost in the noise
+		int band = (mode == dither_mode::floyd_steinberg) ? 64 : 16;
+		// built here rather than racing in every band
+		lut();
+		if (jobs && img.height > band) {
+			jobs->parallel_for_rows(0, img.height, band, convert);
+		}
+		else {
+			convert(0, img.height);
+		}
+		return spr;
+	}
+}
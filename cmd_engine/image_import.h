@@ -0,0 +1,54 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace olc
+{
+	class job_system;
+
+	//
+	// 8 bit rgb pixels, row after row without padding
+	//
+	struct image
+	{
+		int width{ 0 };
+		int height{ 0 };
+		std::vector<uint8_t> rgb;
+	};
+
+	namespace dither_mode
+	{
+		enum enum_t
+		{
+			none,
+			// 4x4 bayer threshold, stable between frames and neighbouring sprites
+			ordered,
+			// error diffusion, smoother gradients
+			floyd_steinberg,
+		};
+	}
+
+	// Binary and ascii PPM (P6, P3) and PGM (P5, P2), any maxval up to 65535. Grey is expanded to rgb.
+	bool load_pnm(const std::wstring& file, image& img);
+
+	// Averages the source pixels under every target pixel, for shrinking art down to console size
+	image resize_image(const image& img, int w, int h);
+
+	//
+	// One sprite cell per pixel: the console foreground/background pair and shade glyph whose blend is closest
+	// to the pixel's color. The lookup goes through a table of the blends at 5 bits per channel, built on first
+	// use, after the dither offset is added to the pixel; the ordered dither and quantize run 16 bytes at a time
+	// with SSE2.
+	//
+	// With jobs the rows are converted in bands in parallel. Floyd-Steinberg diffuses error within a band only,
+	// starting clean every 64 rows.
+	//
+	sprite image_to_sprite(const image& img, dither_mode::enum_t mode = dither_mode::ordered, job_system* jobs = nullptr);
+
+	// The same mapping for n pixels given as separate r, g and b rows, written straight to cells; y picks the row
+	// of the dither pattern. 8 pixels per step, for converting video frames as they stream in.
+	void rgb_to_cells(const uint8_t* r, const uint8_t* g, const uint8_t* b, int n, int y, bool dither, CHAR_INFO* cells);
+}
@@ -0,0 +1,358 @@
+#include "job_system.h"
+#include "trace.h"
+#include <cassert>
+#include <string>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		// which job_system the current thread is a worker of, and its deque
+		thread_local const job_system* t_system = nullptr;
+		thread_local unsigned t_index = 0;
+		thread_local uint32_t t_steal_seed = 0x9e3779b9u;
+
+		// idle rounds a worker spins for before going to sleep
+		constexpr int g_spin_rounds = 64;
+
+		uint32_t next_random()
+		{
+			// xorshift32
+			uint32_t x = t_steal_seed;
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			t_steal_seed = x;
+			return x;
+		}
+	}
+
+	//
+	// work_deque class
+	//
+	// Based on "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al. 2013.
+	// The bottom store in push is seq_cst so a worker going to sleep can't miss a job pushed concurrently.
+	//
+	bool work_deque::push(job* j)
+	{
+		int64_t b = _bottom.load(memory_order_relaxed);
+		int64_t t = _top.load(memory_order_acquire);
+		if (b - t >= capacity) {
+			return false;
+		}
+		_buf[b & mask].store(j, memory_order_relaxed);
+		_bottom.store(b + 1, memory_order_seq_cst);
+		return true;
+	}
+
+	job* work_deque::pop()
+	{
+		int64_t b = _bottom.load(memory_order_relaxed) - 1;
+		_bottom.store(b, memory_order_relaxed);
+		atomic_thread_fence(memory_order_seq_cst);
+		int64_t t = _top.load(memory_order_relaxed);
+		if (t > b) {
+			// empty
+			_bottom.store(b + 1, memory_order_relaxed);
+			return nullptr;
+		}
+
+		job* j = _buf[b & mask].load(memory_order_relaxed);
+		if (t == b) {
+			// last job, race against thieves
+			if (!_top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+				j = nullptr;
+			}
+			_bottom.store(b + 1, memory_order_relaxed);
+		}
+		return j;
+	}
+
+	job* work_deque::steal()
+	{
+		int64_t t = _top.load(memory_order_acquire);
+		atomic_thread_fence(memory_order_seq_cst);
+		int64_t b = _bottom.load(memory_order_seq_cst);
+		if (t >= b) {
+			return nullptr;
+		}
+		job* j = _buf[t & mask].load(memory_order_relaxed);
+		if (!_top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+			// lost the race to another thief or the owner
+			return nullptr;
+		}
+		return j;
+	}
+
+	//
+	// job_system class
+	//
+	job_system::job_system(unsigned nworkers)
+	{
+		unsigned n = nworkers + 1;
+		_queues.reserve(n);
+		for (unsigned i = 0; i < n; ++i) {
+			_queues.push_back(make_unique<work_deque>());
+		}
+		_pools.resize(n);
+		_threads.reserve(nworkers);
+		for (unsigned i = 1; i < n; ++i) {
+			_threads.emplace_back(&job_system::worker, this, i);
+		}
+	}
+
+	job_system::~job_system()
+	{
+		_running = false;
+		_work_epoch.fetch_add(1);
+		_work_epoch.notify_all();
+		for (auto& t : _threads) {
+			t.join();
+		}
+	}
+
+	unsigned job_system::thread_index() const
+	{
+		// any thread that isn't one of our workers is the driving thread
+		return (t_system == this) ? t_index : 0;
+	}
+
+	job* job_system::create_job(job::function fn, job* parent)
+	{
+		auto& pool = _pools[thread_index()];
+		constexpr size_t block_size = job_pool::block_size;
+		size_t total = pool.blocks.size() * block_size;
+		// jobs finish roughly in the order they're created, so the next slot is nearly always free
+		job* j = nullptr;
+		for (size_t k = 0; k < total && !j; ++k) {
+			size_t i = pool.next++ % total;
+			job* slot = &pool.blocks[i / block_size][i % block_size];
+			if (slot->unfinished.load(memory_order_acquire) == 0) {
+				j = slot;
+			}
+		}
+		if (!j) {
+			// every slot is still running, waiting on children or queued
+			pool.blocks.push_back(make_unique<job[]>(block_size));
+			j = &pool.blocks.back()[0];
+			pool.next = total + 1;
+		}
+		j->fn = fn;
+		j->parent = parent;
+		j->unfinished.store(1, memory_order_relaxed);
+		if (parent) {
+			parent->unfinished.fetch_add(1, memory_order_relaxed);
+		}
+		return j;
+	}
+
+	void job_system::run(job* j)
+	{
+		if (!_queues[thread_index()]->push(j)) {
+			// deque is full, no point queueing more
+			execute(j);
+			return;
+		}
+		wake_workers();
+	}
+
+	void job_system::wait(job* j)
+	{
+		unsigned index = thread_index();
+		while (j->unfinished.load(memory_order_acquire) > 0) {
+			if (job* next = find_job(index)) {
+				execute(next);
+			}
+			else {
+				this_thread::yield();
+			}
+		}
+	}
+
+	void job_system::wake_workers()
+	{
+		if (_threads.empty()) {
+			return;
+		}
+		_work_epoch.fetch_add(1, memory_order_seq_cst);
+		if (_sleeping.load(memory_order_seq_cst) > 0) {
+			_work_epoch.notify_all();
+		}
+	}
+
+	job* job_system::find_job(unsigned index)
+	{
+		if (job* j = _queues[index]->pop()) {
+			return j;
+		}
+
+		// steal, starting from a random victim so thieves don't all hit the same deque
+		unsigned n = static_cast<unsigned>(_queues.size());
+		unsigned start = next_random() % n;
+		for (unsigned k = 0; k < n; ++k) {
+			unsigned victim = (start + k) % n;
+			if (victim == index) {
+				continue;
+			}
+			if (job* j = _queues[victim]->steal()) {
+				return j;
+			}
+		}
+		return nullptr;
+	}
+
+	void job_system::execute(job* j)
+	{
+		j->fn(*this, *j);
+		finish(j);
+	}
+
+	void job_system::finish(job* j)
+	{
+		// read the parent first, once the count drops the waiter may recycle the job
+		job* parent = j->parent;
+		if (j->unfinished.fetch_sub(1, memory_order_acq_rel) == 1 && parent) {
+			finish(parent);
+		}
+	}
+
+	void job_system::worker(unsigned index)
+	{
+		t_system = this;
+		t_index = index;
+		t_steal_seed = 0x9e3779b9u * (index + 1);
+		OLC_TRACE_THREAD_NAME("job worker " + to_string(index));
+
+		while (_running) {
+			if (job* j = find_job(index)) {
+				execute(j);
+				continue;
+			}
+
+			// spin for a while before sleeping, games submit work every frame
+			job* j = nullptr;
+			for (int spin = 0; spin < g_spin_rounds && !j; ++spin) {
+				this_thread::yield();
+				j = find_job(index);
+			}
+			if (j) {
+				execute(j);
+				continue;
+			}
+
+			uint32_t epoch = _work_epoch.load(memory_order_seq_cst);
+			_sleeping.fetch_add(1, memory_order_seq_cst);
+			// check again now that pushers can see we're sleeping
+			j = find_job(index);
+			if (!j && _running) {
+				_work_epoch.wait(epoch, memory_order_seq_cst);
+			}
+			_sleeping.fetch_sub(1, memory_order_seq_cst);
+			if (j) {
+				execute(j);
+			}
+		}
+	}
+
+	void job_system::parallel_for_impl(int x0, int y0, int x1, int y1, int tile_w, int tile_h, void* ctx, range_fn invoke)
+	{
+		if (x1 <= x0 || y1 <= y0) {
+			return;
+		}
+		OLC_TRACE_ZONE("parallel_for");
+		job* root = create_job(range_job);
+		root->data_as<range_data>() = { ctx, invoke, x0, y0, x1, y1, max(tile_w, 1), max(tile_h, 1) };
+		run(root);
+		wait(root);
+	}
+
+	void job_system::range_job(job_system& js, job& j)
+	{
+		OLC_TRACE_ZONE("range job");
+		auto& r = j.data_as<range_data>();
+
+		// split in halves along the dimension with more tiles, hand one half out and keep going with the other
+		for (;;) {
+			int tiles_x = (r.x1 - r.x0 + r.tile_w - 1) / r.tile_w;
+			int tiles_y = (r.y1 - r.y0 + r.tile_h - 1) / r.tile_h;
+			if (tiles_x <= 1 && tiles_y <= 1) {
+				break;
+			}
+
+			range_data other = r;
+			if (tiles_y >= tiles_x) {
+				int mid = r.y0 + (tiles_y / 2) * r.tile_h;
+				other.y0 = mid;
+				r.y1 = mid;
+			}
+			else {
+				int mid = r.x0 + (tiles_x / 2) * r.tile_w;
+				other.x0 = mid;
+				r.x1 = mid;
+			}
+			job* child = js.create_job(range_job, &j);
+			child->data_as<range_data>() = other;
+			js.run(child);
+		}
+		r.invoke(r.ctx, r.x0, r.y0, r.x1, r.y1);
+	}
+
+	//
+	// task_graph class
+	//
+	task_graph::task_id task_graph::add(function<void()> fn, initializer_list<task_id> deps)
+	{
+		task_id id = _nodes.size();
+		auto& n = _nodes.emplace_back();
+		n.fn = move(fn);
+		n.dep_count = static_cast<int>(deps.size());
+		for (auto dep : deps) {
+			// dependencies must already exist, which also rules out cycles
+			assert(dep < id);
+			_nodes[dep].successors.push_back(id);
+		}
+		return id;
+	}
+
+	void task_graph::run(job_system& js)
+	{
+		if (_nodes.empty()) {
+			return;
+		}
+		for (auto& n : _nodes) {
+			n.pending.store(n.dep_count, memory_order_relaxed);
+		}
+
+		// the root does nothing itself, it's only there to wait on all the tasks as its children
+		_root = js.create_job([](job_system&, job&) {});
+		for (task_id id = 0; id < _nodes.size(); ++id) {
+			if (_nodes[id].dep_count == 0) {
+				spawn(js, _root, id);
+			}
+		}
+		js.run(_root);
+		js.wait(_root);
+		_root = nullptr;
+	}
+
+	void task_graph::spawn(job_system& js, job* root, task_id id)
+	{
+		job* j = js.create_job(node_job, root);
+		j->data_as<node_data>() = { this, id };
+		js.run(j);
+	}
+
+	void task_graph::node_job(job_system& js, job& j)
+	{
+		auto [graph, id] = j.data_as<node_data>();
+		auto& n = graph->_nodes[id];
+		n.fn();
+		for (auto succ : n.successors) {
+			if (graph->_nodes[succ].pending.fetch_sub(1, memory_order_acq_rel) == 1) {
+				graph->spawn(js, graph->_root, succ);
+			}
+		}
+	}
+}
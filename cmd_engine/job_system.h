@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace olc
+{
+	class job_system;
+
+	//
+	// Unit of work. Jobs are allocated from a per thread ring so spawning one is a couple of stores, no heap.
+	// unfinished counts the job itself plus its unfinished children; a job is done when it reaches 0.
+	//
+	struct alignas(64) job
+	{
+		using function = void (*)(job_system&, job&);
+
+		function fn;
+		job* parent;
+		std::atomic<int> unfinished;
+		alignas(8) unsigned char data[104];
+
+		template<typename T>
+		T& data_as()
+		{
+			static_assert(sizeof(T) <= sizeof(data) && std::is_trivially_copyable_v<T>, "job data must be small and trivially copyable");
+			return *std::launder(reinterpret_cast<T*>(data));
+		}
+	};
+
+	//
+	// Chase-Lev work stealing deque with a fixed capacity.
+	// The owner thread pushes and pops at the bottom, other threads steal from the top.
+	//
+	class work_deque
+	{
+	public:
+		static constexpr int64_t capacity = 4096;
+
+		// returns false when full, the caller then runs the job itself
+		bool push(job* j);
+		job* pop();
+		job* steal();
+
+	private:
+		static constexpr int64_t mask = capacity - 1;
+
+		alignas(64) std::atomic<int64_t> _top{ 0 };
+		alignas(64) std::atomic<int64_t> _bottom{ 0 };
+		alignas(64) std::array<std::atomic<job*>, capacity> _buf{};
+	};
+
+	//
+	// Work stealing thread pool with one deque per worker.
+	//
+	// The thread driving the system (normally the game thread) owns deque 0 and helps executing jobs while it waits,
+	// so parallel_for never leaves it idle. Only one non worker thread may drive the system at a time; jobs may
+	// spawn nested work from any worker.
+	//
+	// Everything that touches the per thread state goes through the virtual functions. A game module dll has its own
+	// copy of this code and of its thread locals, which the host's workers never set up; calling through the vtable
+	// of the host's job_system runs the host's copy instead, whichever binary the caller is in. Don't make it final,
+	// that would let the compiler call the module's copy directly.
+	//
+	class job_system
+	{
+	public:
+		// nworkers extra threads are started, 0 runs every job on the calling thread
+		explicit job_system(unsigned nworkers = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+		virtual ~job_system();
+
+		job_system(const job_system&) = delete;
+		job_system& operator=(const job_system&) = delete;
+
+		// number of threads executing jobs, including the calling thread
+		unsigned thread_count() const { return static_cast<unsigned>(_queues.size()); }
+
+		//
+		// Calls f(x0, y0, x1, y1) for tiles of at most tile_w x tile_h covering [x0, x1) x [y0, y1).
+		// Returns when all tiles are done. The range is split recursively so idle threads steal big halves first.
+		//
+		template<typename F>
+		void parallel_for(int x0, int y0, int x1, int y1, int tile_w, int tile_h, F&& f)
+		{
+			using fn_t = std::remove_reference_t<F>;
+			auto invoke = [](void* ctx, int ax0, int ay0, int ax1, int ay1) {
+				(*static_cast<fn_t*>(ctx))(ax0, ay0, ax1, ay1);
+			};
+			parallel_for_impl(x0, y0, x1, y1, tile_w, tile_h, const_cast<void*>(static_cast<const void*>(&f)), invoke);
+		}
+
+		// Calls f(begin, end) for chunks of at most grain rows of [y0, y1)
+		template<typename F>
+		void parallel_for_rows(int y0, int y1, int grain, F&& f)
+		{
+			parallel_for(0, y0, 1, y1, 1, grain, [&f](int, int ay0, int, int ay1) { f(ay0, ay1); });
+		}
+
+		//
+		// Low level interface
+		//
+		// A job created with a parent keeps the parent unfinished until it completes.
+		virtual job* create_job(job::function fn, job* parent = nullptr);
+		virtual void run(job* j);
+		// executes other jobs until j is finished
+		virtual void wait(job* j);
+
+	private:
+		using range_fn = void (*)(void* ctx, int x0, int y0, int x1, int y1);
+
+		struct range_data
+		{
+			void* ctx;
+			range_fn invoke;
+			int x0, y0, x1, y1;
+			int tile_w, tile_h;
+		};
+
+		// Per thread job ring, only touched by its owner thread. Slots are reused once their job is finished; with more
+		// jobs than that in flight another block is added, jobs never move while in use.
+		struct job_pool
+		{
+			static constexpr size_t block_size = 4096;
+
+			job_pool() { blocks.push_back(std::make_unique<job[]>(block_size)); }
+
+			std::vector<std::unique_ptr<job[]>> blocks;
+			size_t next{ 0 };
+		};
+
+		virtual void parallel_for_impl(int x0, int y0, int x1, int y1, int tile_w, int tile_h, void* ctx, range_fn invoke);
+		static void range_job(job_system& js, job& j);
+
+		void worker(unsigned index);
+		unsigned thread_index() const;
+		job* find_job(unsigned index);
+		void execute(job* j);
+		void finish(job* j);
+		void wake_workers();
+
+	private:
+		std::vector<std::unique_ptr<work_deque>> _queues;
+		std::vector<job_pool> _pools;
+		std::vector<std::thread> _threads;
+
+		std::atomic<bool> _running{ true };
+		// bumped on every push so sleeping workers wake up
+		std::atomic<uint32_t> _work_epoch{ 0 };
+		std::atomic<int> _sleeping{ 0 };
+	};
+
+	//
+	// Graph of tasks with dependencies, built once and run any number of times.
+	// A task is started as soon as all the tasks it depends on are done; independent tasks run in parallel.
+	//
+	class task_graph
+	{
+	public:
+		using task_id = size_t;
+
+		task_id add(std::function<void()> fn, std::initializer_list<task_id> deps = {});
+		// blocks until all tasks are done
+		void run(job_system& js);
+		void clear() { _nodes.clear(); }
+		size_t size() const { return _nodes.size(); }
+
+	private:
+		struct node
+		{
+			std::function<void()> fn;
+			std::vector<task_id> successors;
+			int dep_count{ 0 };
+			std::atomic<int> pending{ 0 };
+		};
+
+		struct node_data
+		{
+			task_graph* graph;
+			task_id id;
+		};
+
+		static void node_job(job_system& js, job& j);
+		void spawn(job_system& js, job* root, task_id id);
+
+	private:
+		// deque keeps the nodes (and their atomics) in place as the graph grows
+		std::deque<node> _nodes;
+		job* _root{ nullptr };
+	};
+}
@@ -0,0 +1,516 @@
+#include "noise.h"
+#include "cpu_features.h"
+#include <algorithm>
+#include <cmath>
+#include <immintrin.h>
+#include <iterator>
+#include <numeric>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		const bool g_has_avx2 = cpu_has_avx2();
+
+		// skew to the simplex lattice and back, 2D and 3D
+		constexpr float g_f2 = 0.366025403784f;
+		constexpr float g_g2 = 0.211324865405f;
+		constexpr float g_f3 = 1.0f / 3.0f;
+		constexpr float g_g3 = 1.0f / 6.0f;
+
+		// the midpoints of a cube's edges, 2D uses their x and y
+		constexpr float g_gradients[12][3] = {
+			{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+			{ 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+			{ 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 },
+		};
+
+		//
+		// Scalar kernels. The AVX2 ones below do the very same operations in the same order, so both give the
+		// same bits; keep them in step.
+		//
+		int lattice(float f)
+		{
+			return static_cast<int>(f) & 255;
+		}
+
+		// 6t^5 - 15t^4 + 10t^3, flat at both ends so lattice cells join smoothly
+		float fade(float f)
+		{
+			return f * f * f * (f * (f * 6.0f - 15.0f) + 10.0f);
+		}
+
+		float lerp(float a, float b, float t)
+		{
+			return a + t * (b - a);
+		}
+
+		float value2(const noise_tables& t, float x, float y)
+		{
+			float fx = floorf(x);
+			float fy = floorf(y);
+			int ix = lattice(fx);
+			int iy = lattice(fy);
+			float u = fade(x - fx);
+			float v = fade(y - fy);
+			int a = t.perm[iy];
+			int b = t.perm[iy + 1];
+			float x0 = lerp(t.value[ix + a], t.value[ix + 1 + a], u);
+			float x1 = lerp(t.value[ix + b], t.value[ix + 1 + b], u);
+			return lerp(x0, x1, v);
+		}
+
+		float value3(const noise_tables& t, float x, float y, float z)
+		{
+			float fx = floorf(x);
+			float fy = floorf(y);
+			float fz = floorf(z);
+			int ix = lattice(fx);
+			int iy = lattice(fy);
+			int iz = lattice(fz);
+			float u = fade(x - fx);
+			float v = fade(y - fy);
+			float w = fade(z - fz);
+			int a = t.perm[iz];
+			int b = t.perm[iz + 1];
+			int aa = t.perm[iy + a];
+			int ab = t.perm[iy + 1 + a];
+			int ba = t.perm[iy + b];
+			int bb = t.perm[iy + 1 + b];
+			float x00 = lerp(t.value[ix + aa], t.value[ix + 1 + aa], u);
+			float x10 = lerp(t.value[ix + ab], t.value[ix + 1 + ab], u);
+			float x01 = lerp(t.value[ix + ba], t.value[ix + 1 + ba], u);
+			float x11 = lerp(t.value[ix + bb], t.value[ix + 1 + bb], u);
+			return lerp(lerp(x00, x10, v), lerp(x01, x11, v), w);
+		}
+
+		// a simplex corner's share, falling to 0 at distance sqrt(r2)
+		float corner(const noise_tables& t, int g, float r2, float x, float y)
+		{
+			float a = max(r2 - x * x - y * y, 0.0f);
+			a *= a;
+			return a * a * (t.grad_x[g] * x + t.grad_y[g] * y);
+		}
+
+		float corner(const noise_tables& t, int g, float r2, float x, float y, float z)
+		{
+			float a = max(r2 - x * x - y * y - z * z, 0.0f);
+			a *= a;
+			return a * a * (t.grad_x[g] * x + t.grad_y[g] * y + t.grad_z[g] * z);
+		}
+
+		float simplex2(const noise_tables& t, float x, float y)
+		{
+			float s = (x + y) * g_f2;
+			float fi = floorf(x + s);
+			float fj = floorf(y + s);
+			float u = (fi + fj) * g_g2;
+			float x0 = x - (fi - u);
+			float y0 = y - (fj - u);
+			// the lower or the upper triangle of the skewed square
+			int i1 = x0 > y0 ? 1 : 0;
+			int j1 = 1 - i1;
+			float x1 = x0 - static_cast<float>(i1) + g_g2;
+			float y1 = y0 - static_cast<float>(j1) + g_g2;
+			float x2 = x0 + (2.0f * g_g2 - 1.0f);
+			float y2 = y0 + (2.0f * g_g2 - 1.0f);
+			int ii = lattice(fi);
+			int jj = lattice(fj);
+			float n = corner(t, ii + t.perm[jj], 0.5f, x0, y0)
+				+ corner(t, ii + i1 + t.perm[jj + j1], 0.5f, x1, y1)
+				+ corner(t, ii + 1 + t.perm[jj + 1], 0.5f, x2, y2);
+			return 70.0f * n;
+		}
+
+		float simplex3(const noise_tables& t, float x, float y, float z)
+		{
+			float s = (x + y + z) * g_f3;
+			float fi = floorf(x + s);
+			float fj = floorf(y + s);
+			float fk = floorf(z + s);
+			float u = (fi + fj + fk) * g_g3;
+			float x0 = x - (fi - u);
+			float y0 = y - (fj - u);
+			float z0 = z - (fk - u);
+			// which of the 6 tetrahedra of the skewed cube, by the order of x0, y0 and z0
+			bool xy = x0 >= y0;
+			bool xz = x0 >= z0;
+			bool yz = y0 >= z0;
+			int i1 = xy && xz;
+			int j1 = !xy && yz;
+			int k1 = !xz && !yz;
+			int i2 = xy || xz;
+			int j2 = !xy || yz;
+			int k2 = !(xz && yz);
+			float x1 = x0 - static_cast<float>(i1) + g_g3;
+			float y1 = y0 - static_cast<float>(j1) + g_g3;
+			float z1 = z0 - static_cast<float>(k1) + g_g3;
+			float x2 = x0 - static_cast<float>(i2) + 2.0f * g_g3;
+			float y2 = y0 - static_cast<float>(j2) + 2.0f * g_g3;
+			float z2 = z0 - static_cast<float>(k2) + 2.0f * g_g3;
+			float x3 = x0 + (3.0f * g_g3 - 1.0f);
+			float y3 = y0 + (3.0f * g_g3 - 1.0f);
+			float z3 = z0 + (3.0f * g_g3 - 1.0f);
+			int ii = lattice(fi);
+			int jj = lattice(fj);
+			int kk = lattice(fk);
+			float n = corner(t, ii + t.perm[jj + t.perm[kk]], 0.6f, x0, y0, z0)
+				+ corner(t, ii + i1 + t.perm[jj + j1 + t.perm[kk + k1]], 0.6f, x1, y1, z1)
+				+ corner(t, ii + i2 + t.perm[jj + j2 + t.perm[kk + k2]], 0.6f, x2, y2, z2)
+				+ corner(t, ii + 1 + t.perm[jj + 1 + t.perm[kk + 1]], 0.6f, x3, y3, z3);
+			return 32.0f * n;
+		}
+
+		float sample(const noise_tables& t, noise_type::enum_t type, float x, float y)
+		{
+			return type == noise_type::simplex ? simplex2(t, x, y) : value2(t, x, y);
+		}
+
+		float sample(const noise_tables& t, noise_type::enum_t type, float x, float y, float z)
+		{
+			return type == noise_type::simplex ? simplex3(t, x, y, z) : value3(t, x, y, z);
+		}
+
+		// calls sample(frequency) for each octave
+		template <typename Sample>
+		float fractal(const fbm_params& params, Sample sample)
+		{
+			float sum = 0.0f;
+			float total = 0.0f;
+			float amplitude = 1.0f;
+			float frequency = 1.0f;
+			for (int o = 0; o < max(params.octaves, 1); ++o) {
+				sum += amplitude * sample(frequency);
+				total += amplitude;
+				amplitude *= params.gain;
+				frequency *= params.lacunarity;
+			}
+			return sum * (1.0f / total);
+		}
+
+		//
+		// AVX2 kernels, 8 samples a lane each. The lattice hashes are gathers from the doubled tables.
+		//
+		__m256i lattice_avx2(__m256 f)
+		{
+			return _mm256_and_si256(_mm256_cvttps_epi32(f), _mm256_set1_epi32(255));
+		}
+
+		__m256 fade_avx2(__m256 f)
+		{
+			__m256 poly = _mm256_add_ps(_mm256_mul_ps(f, _mm256_sub_ps(_mm256_mul_ps(f, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))), _mm256_set1_ps(10.0f));
+			return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(f, f), f), poly);
+		}
+
+		__m256 lerp_avx2(__m256 a, __m256 b, __m256 t)
+		{
+			return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+		}
+
+		__m256i perm_avx2(const noise_tables& t, __m256i i)
+		{
+			return _mm256_i32gather_epi32(t.perm, i, 4);
+		}
+
+		__m256 value_at_avx2(const noise_tables& t, __m256i i)
+		{
+			return _mm256_i32gather_ps(t.value, i, 4);
+		}
+
+		__m256 value2_avx2(const noise_tables& t, __m256 x, __m256 y)
+		{
+			const __m256i one = _mm256_set1_epi32(1);
+			__m256 fx = _mm256_floor_ps(x);
+			__m256 fy = _mm256_floor_ps(y);
+			__m256i ix = lattice_avx2(fx);
+			__m256i iy = lattice_avx2(fy);
+			__m256 u = fade_avx2(_mm256_sub_ps(x, fx));
+			__m256 v = fade_avx2(_mm256_sub_ps(y, fy));
+			__m256i ix1 = _mm256_add_epi32(ix, one);
+			__m256i a = perm_avx2(t, iy);
+			__m256i b = perm_avx2(t, _mm256_add_epi32(iy, one));
+			__m256 x0 = lerp_avx2(value_at_avx2(t, _mm256_add_epi32(ix, a)), value_at_avx2(t, _mm256_add_epi32(ix1, a)), u);
+			__m256 x1 = lerp_avx2(value_at_avx2(t, _mm256_add_epi32(ix, b)), value_at_avx2(t, _mm256_add_epi32(ix1, b)), u);
+			return lerp_avx2(x0, x1, v);
+		}
+
+		__m256 value3_avx2(const noise_tables& t, __m256 x, __m256 y, __m256 z)
+		{
+			const __m256i one = _mm256_set1_epi32(1);
+			__m256 fx = _mm256_floor_ps(x);
+			__m256 fy = _mm256_floor_ps(y);
+			__m256 fz = _mm256_floor_ps(z);
+			__m256i ix = lattice_avx2(fx);
+			__m256i iy = lattice_avx2(fy);
+			__m256i iz = lattice_avx2(fz);
+			__m256 u = fade_avx2(_mm256_sub_ps(x, fx));
+			__m256 v = fade_avx2(_mm256_sub_ps(y, fy));
+			__m256 w = fade_avx2(_mm256_sub_ps(z, fz));
+			__m256i ix1 = _mm256_add_epi32(ix, one);
+			__m256i iy1 = _mm256_add_epi32(iy, one);
+			__m256i a = perm_avx2(t, iz);
+			__m256i b = perm_avx2(t, _mm256_add_epi32(iz, one));
+			__m256i aa = perm_avx2(t, _mm256_add_epi32(iy, a));
+			__m256i ab = perm_avx2(t, _mm256_add_epi32(iy1, a));
+			__m256i ba = perm_avx2(t, _mm256_add_epi32(iy, b));
+			__m256i bb = perm_avx2(t, _mm256_add_epi32(iy1, b));
+			auto row = [&](__m256i h) {
+				return lerp_avx2(value_at_avx2(t, _mm256_add_epi32(ix, h)), value_at_avx2(t, _mm256_add_epi32(ix1, h)), u);
+			};
+			__m256 y0 = lerp_avx2(row(aa), row(ab), v);
+			__m256 y1 = lerp_avx2(row(ba), row(bb), v);
+			return lerp_avx2(y0, y1, w);
+		}
+
+		__m256 corner_avx2(const noise_tables& t, __m256i g, __m256 r2, __m256 x, __m256 y)
+		{
+			__m256 a = _mm256_sub_ps(_mm256_sub_ps(r2, _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y));
+			a = _mm256_max_ps(a, _mm256_setzero_ps());
+			a = _mm256_mul_ps(a, a);
+			__m256 dot = _mm256_add_ps(_mm256_mul_ps(_mm256_i32gather_ps(t.grad_x, g, 4), x), _mm256_mul_ps(_mm256_i32gather_ps(t.grad_y, g, 4), y));
+			return _mm256_mul_ps(_mm256_mul_ps(a, a), dot);
+		}
+
+		__m256 corner_avx2(const noise_tables& t, __m256i g, __m256 r2, __m256 x, __m256 y, __m256 z)
+		{
+			__m256 a = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(r2, _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+			a = _mm256_max_ps(a, _mm256_setzero_ps());
+			a = _mm256_mul_ps(a, a);
+			__m256 dot = _mm256_add_ps(_mm256_add_ps(
+				_mm256_mul_ps(_mm256_i32gather_ps(t.grad_x, g, 4), x),
+				_mm256_mul_ps(_mm256_i32gather_ps(t.grad_y, g, 4), y)),
+				_mm256_mul_ps(_mm256_i32gather_ps(t.grad_z, g, 4), z));
+			return _mm256_mul_ps(_mm256_mul_ps(a, a), dot);
+		}
+
+		__m256 simplex2_avx2(const noise_tables& t, __m256 x, __m256 y)
+		{
+			const __m256i one = _mm256_set1_epi32(1);
+			const __m256 g2 = _mm256_set1_ps(g_g2);
+			const __m256 r2 = _mm256_set1_ps(0.5f);
+			__m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(g_f2));
+			__m256 fi = _mm256_floor_ps(_mm256_add_ps(x, s));
+			__m256 fj = _mm256_floor_ps(_mm256_add_ps(y, s));
+			__m256 u = _mm256_mul_ps(_mm256_add_ps(fi, fj), g2);
+			__m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(fi, u));
+			__m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(fj, u));
+			__m256i i1 = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(x0, y0, _CMP_GT_OQ)), one);
+			__m256i j1 = _mm256_sub_epi32(one, i1);
+			__m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_cvtepi32_ps(i1)), g2);
+			__m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_cvtepi32_ps(j1)), g2);
+			__m256 x2 = _mm256_add_ps(x0, _mm256_set1_ps(2.0f * g_g2 - 1.0f));
+			__m256 y2 = _mm256_add_ps(y0, _mm256_set1_ps(2.0f * g_g2 - 1.0f));
+			__m256i ii = lattice_avx2(fi);
+			__m256i jj = lattice_avx2(fj);
+			__m256i g0 = _mm256_add_epi32(ii, perm_avx2(t, jj));
+			__m256i g1 = _mm256_add_epi32(_mm256_add_epi32(ii, i1), perm_avx2(t, _mm256_add_epi32(jj, j1)));
+			__m256i g2i = _mm256_add_epi32(_mm256_add_epi32(ii, one), perm_avx2(t, _mm256_add_epi32(jj, one)));
+			__m256 n = _mm256_add_ps(_mm256_add_ps(corner_avx2(t, g0, r2, x0, y0), corner_avx2(t, g1, r2, x1, y1)), corner_avx2(t, g2i, r2, x2, y2));
+			return _mm256_mul_ps(_mm256_set1_ps(70.0f), n);
+		}
+
+		__m256 simplex3_avx2(const noise_tables& t, __m256 x, __m256 y, __m256 z)
+		{
+			const __m256i one = _mm256_set1_epi32(1);
+			const __m256i all = _mm256_set1_epi32(-1);
+			const __m256 g3 = _mm256_set1_ps(g_g3);
+			const __m256 g3x2 = _mm256_set1_ps(2.0f * g_g3);
+			const __m256 r2 = _mm256_set1_ps(0.6f);
+			__m256 s = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), _mm256_set1_ps(g_f3));
+			__m256 fi = _mm256_floor_ps(_mm256_add_ps(x, s));
+			__m256 fj = _mm256_floor_ps(_mm256_add_ps(y, s));
+			__m256 fk = _mm256_floor_ps(_mm256_add_ps(z, s));
+			__m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(fi, fj), fk), g3);
+			__m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(fi, u));
+			__m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(fj, u));
+			__m256 z0 = _mm256_sub_ps(z, _mm256_sub_ps(fk, u));
+			__m256i xy = _mm256_castps_si256(_mm256_cmp_ps(x0, y0, _CMP_GE_OQ));
+			__m256i xz = _mm256_castps_si256(_mm256_cmp_ps(x0, z0, _CMP_GE_OQ));
+			__m256i yz = _mm256_castps_si256(_mm256_cmp_ps(y0, z0, _CMP_GE_OQ));
+			// masks to 0 or 1, andnot(a, b) is !a && b
+			__m256i i1 = _mm256_and_si256(_mm256_and_si256(xy, xz), one);
+			__m256i j1 = _mm256_and_si256(_mm256_andnot_si256(xy, yz), one);
+			__m256i k1 = _mm256_and_si256(_mm256_andnot_si256(_mm256_or_si256(xz, yz), all), one);
+			__m256i i2 = _mm256_and_si256(_mm256_or_si256(xy, xz), one);
+			__m256i j2 = _mm256_and_si256(_mm256_or_si256(_mm256_andnot_si256(xy, all), yz), one);
+			__m256i k2 = _mm256_and_si256(_mm256_andnot_si256(_mm256_and_si256(xz, yz), all), one);
+			__m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_cvtepi32_ps(i1)), g3);
+			__m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_cvtepi32_ps(j1)), g3);
+			__m256 z1 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_cvtepi32_ps(k1)), g3);
+			__m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_cvtepi32_ps(i2)), g3x2);
+			__m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_cvtepi32_ps(j2)), g3x2);
+			__m256 z2 = _mm256_add_ps(_mm256_sub_ps(z0, _mm256_cvtepi32_ps(k2)), g3x2);
+			const __m256 last = _mm256_set1_ps(3.0f * g_g3 - 1.0f);
+			__m256 x3 = _mm256_add_ps(x0, last);
+			__m256 y3 = _mm256_add_ps(y0, last);
+			__m256 z3 = _mm256_add_ps(z0, last);
+			__m256i ii = lattice_avx2(fi);
+			__m256i jj = lattice_avx2(fj);
+			__m256i kk = lattice_avx2(fk);
+			auto hash = [&](__m256i di, __m256i dj, __m256i dk) {
+				__m256i h = perm_avx2(t, _mm256_add_epi32(kk, dk));
+				h = perm_avx2(t, _mm256_add_epi32(_mm256_add_epi32(jj, dj), h));
+				return _mm256_add_epi32(_mm256_add_epi32(ii, di), h);
+			};
+			const __m256i zero = _mm256_setzero_si256();
+			__m256 n = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+				corner_avx2(t, hash(zero, zero, zero), r2, x0, y0, z0),
+				corner_avx2(t, hash(i1, j1, k1), r2, x1, y1, z1)),
+				corner_avx2(t, hash(i2, j2, k2), r2, x2, y2, z2)),
+				corner_avx2(t, hash(one, one, one), r2, x3, y3, z3));
+			return _mm256_mul_ps(_mm256_set1_ps(32.0f), n);
+		}
+
+		// z null for 2D noise
+		__m256 sample_avx2(const noise_tables& t, noise_type::enum_t type, __m256 x, __m256 y, const __m256* z)
+		{
+			if (z) {
+				return type == noise_type::simplex ? simplex3_avx2(t, x, y, *z) : value3_avx2(t, x, y, *z);
+			}
+			return type == noise_type::simplex ? simplex2_avx2(t, x, y) : value2_avx2(t, x, y);
+		}
+	}
+
+	//
+	// noise class
+	//
+	noise::noise(uint32_t seed)
+	{
+		reseed(seed);
+	}
+
+	void noise::reseed(uint32_t seed)
+	{
+		// splitmix64, the same tables from the same seed on every platform
+		uint64_t state = seed;
+		auto next = [&state]() {
+			uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return z ^ (z >> 31);
+		};
+		int32_t p[256];
+		iota(begin(p), end(p), 0);
+		for (int i = 255; i > 0; --i) {
+			swap(p[i], p[next() % (i + 1)]);
+		}
+		float values[256];
+		for (auto& v : values) {
+			v = static_cast<float>(next() >> 40) / float(1 << 24) * 2.0f - 1.0f;
+		}
+		for (int i = 0; i < 512; ++i) {
+			int h = p[i & 255];
+			_tables.perm[i] = h;
+			_tables.grad_x[i] = g_gradients[h % 12][0];
+			_tables.grad_y[i] = g_gradients[h % 12][1];
+			_tables.grad_z[i] = g_gradients[h % 12][2];
+			_tables.value[i] = values[h];
+		}
+	}
+
+	float noise::value(float x, float y) const
+	{
+		return value2(_tables, x, y);
+	}
+
+	float noise::value(float x, float y, float z) const
+	{
+		return value3(_tables, x, y, z);
+	}
+
+	float noise::simplex(float x, float y) const
+	{
+		return simplex2(_tables, x, y);
+	}
+
+	float noise::simplex(float x, float y, float z) const
+	{
+		return simplex3(_tables, x, y, z);
+	}
+
+	float noise::fbm(noise_type::enum_t type, float x, float y, const fbm_params& params) const
+	{
+		return fractal(params, [&](float f) { return sample(_tables, type, x * f, y * f); });
+	}
+
+	float noise::fbm(noise_type::enum_t type, float x, float y, float z, const fbm_params& params) const
+	{
+		return fractal(params, [&](float f) { return sample(_tables, type, x * f, y * f, z * f); });
+	}
+
+	void noise::fill(float* out, int w, int h, float x, float y, float step, noise_type::enum_t type, const fbm_params& params) const
+	{
+		if (g_has_avx2) {
+			fill_avx2(out, w, h, x, y, nullptr, step, type, params);
+		}
+		else {
+			fill_scalar(out, w, h, x, y, nullptr, step, type, params);
+		}
+	}
+
+	void noise::fill(float* out, int w, int h, float x, float y, float z, float step, noise_type::enum_t type, const fbm_params& params) const
+	{
+		if (g_has_avx2) {
+			fill_avx2(out, w, h, x, y, &z, step, type, params);
+		}
+		else {
+			fill_scalar(out, w, h, x, y, &z, step, type, params);
+		}
+	}
+
+	void noise::fill_scalar(float* out, int w, int h, float x, float y, const float* z, float step, noise_type::enum_t type, const fbm_params& params) const
+	{
+		for (int row = 0; row < h; ++row) {
+			float py = y + static_cast<float>(row) * step;
+			for (int col = 0; col < w; ++col) {
+				float px = x + static_cast<float>(col) * step;
+				*out++ = z ? fbm(type, px, py, *z, params) : fbm(type, px, py, params);
+			}
+		}
+	}
+
+	void noise::fill_avx2(float* out, int w, int h, float x, float y, const float* z, float step, noise_type::enum_t type, const fbm_params& params) const
+	{
+		const __m256 lane = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+		const __m256 vx = _mm256_set1_ps(x);
+		const __m256 vstep = _mm256_set1_ps(step);
+		const int octaves = max(params.octaves, 1);
+		// the same amplitudes and frequencies fractal() steps through
+		float total = 0.0f;
+		float a = 1.0f;
+		for (int o = 0; o < octaves; ++o) {
+			total += a;
+			a *= params.gain;
+		}
+		const __m256 scale = _mm256_set1_ps(1.0f / total);
+
+		for (int row = 0; row < h; ++row) {
+			float py = y + static_cast<float>(row) * step;
+			const __m256 vy = _mm256_set1_ps(py);
+			int col = 0;
+			for (; col + 8 <= w; col += 8) {
+				__m256 px = _mm256_add_ps(vx, _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(static_cast<float>(col)), lane), vstep));
+				__m256 sum = _mm256_setzero_ps();
+				float amplitude = 1.0f;
+				float frequency = 1.0f;
+				for (int o = 0; o < octaves; ++o) {
+					const __m256 f = _mm256_set1_ps(frequency);
+					__m256 pz = z ? _mm256_set1_ps(*z * frequency) : _mm256_setzero_ps();
+					__m256 n = sample_avx2(_tables, type, _mm256_mul_ps(px, f), _mm256_mul_ps(vy, f), z ? &pz : nullptr);
+					sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(amplitude), n));
+					amplitude *= params.gain;
+					frequency *= params.lacunarity;
+				}
+				_mm256_storeu_ps(out, _mm256_mul_ps(sum, scale));
+				out += 8;
+			}
+			// the few left over
+			for (; col < w; ++col) {
+				float px = x + static_cast<float>(col) * step;
+				*out++ = z ? fbm(type, px, py, *z, params) : fbm(type, px, py, params);
+			}
+		}
+	}
+}
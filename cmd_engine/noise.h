@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+namespace olc
+{
+	struct noise_type
+	{
+		enum enum_t
+		{
+			// smooth random values at the integer lattice, blocky at low octaves
+			value,
+			// gradient noise on a triangular lattice, no axis aligned artifacts
+			simplex,
+		};
+	};
+
+	// Fractal sum of octaves, each lacunarity times the frequency and gain times the amplitude of the one before
+	struct fbm_params
+	{
+		int octaves{ 1 };
+		float lacunarity{ 2.0f };
+		float gain{ 0.5f };
+	};
+
+	// The seeded lookup tables, doubled so lattice hashes index them without wrapping
+	struct noise_tables
+	{
+		alignas(32) int32_t perm[512];
+		alignas(32) float grad_x[512];
+		alignas(32) float grad_y[512];
+		alignas(32) float grad_z[512];
+		alignas(32) float value[512];
+	};
+
+	//
+	// 2D and 3D value and simplex noise for procedural terrain, clouds and textures. Samples are roughly in [-1, 1],
+	// the same seed gives the same noise everywhere. The pattern repeats every 256 units.
+	//
+	// fill evaluates a whole grid of samples, 8 at a time with AVX2 when the CPU has it. It gives exactly the values
+	// sampling the same points one at a time would, so a point query can check what was filled.
+	//
+	class noise
+	{
+	public:
+		explicit noise(uint32_t seed = 0);
+
+		void reseed(uint32_t seed);
+
+		float value(float x, float y) const;
+		float value(float x, float y, float z) const;
+		float simplex(float x, float y) const;
+		float simplex(float x, float y, float z) const;
+		// The octaves summed and scaled back to the range of one
+		float fbm(noise_type::enum_t type, float x, float y, const fbm_params& params = {}) const;
+		float fbm(noise_type::enum_t type, float x, float y, float z, const fbm_params& params = {}) const;
+
+		// w * h samples into out, row by row; sample (col, row) is at (x + col * step, y + row * step)
+		void fill(float* out, int w, int h, float x, float y, float step, noise_type::enum_t type, const fbm_params& params = {}) const;
+		// The same over the plane at z of 3D noise, move z over time to animate it
+		void fill(float* out, int w, int h, float x, float y, float z, float step, noise_type::enum_t type, const fbm_params& params = {}) const;
+
+	private:
+		void fill_scalar(float* out, int w, int h, float x, float y, const float* z, float step, noise_type::enum_t type, const fbm_params& params) const;
+		void fill_avx2(float* out, int w, int h, float x, float y, const float* z, float step, noise_type::enum_t type, const fbm_params& params) const;
+
+	private:
+		noise_tables _tables;
+	};
+}
@@ -0,0 +1,271 @@
+#include "particle_system.h"
+#include "cpu_features.h"
+#include "trace.h"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <immintrin.h>
+#include <new>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		const bool g_has_avx2 = cpu_has_avx2();
+
+		// For each 8 bit alive mask, the lanes to gather so the live ones end up packed at the front
+		struct compact_table
+		{
+			alignas(32) int32_t lanes[256][8];
+		};
+
+		constexpr compact_table make_compact_table()
+		{
+			compact_table t{};
+			for (int m = 0; m < 256; ++m) {
+				int n = 0;
+				for (int lane = 0; lane < 8; ++lane) {
+					if (m & (1 << lane)) {
+						t.lanes[m][n++] = lane;
+					}
+				}
+				// the rest are never read, anything valid will do
+				for (; n < 8; ++n) {
+					t.lanes[m][n] = 0;
+				}
+			}
+			return t;
+		}
+
+		constexpr compact_table g_compact = make_compact_table();
+
+		template<typename T, typename D>
+		unique_ptr<T[], D> make_aligned(size_t n)
+		{
+			void* p = _aligned_malloc(n * sizeof(T), 32);
+			if (!p) {
+				throw bad_alloc{};
+			}
+			memset(p, 0, n * sizeof(T));
+			return unique_ptr<T[], D>(static_cast<T*>(p));
+		}
+
+		wchar_t shade(float fraction)
+		{
+			if (fraction > 0.75f) {
+				return pixel_type::solid;
+			}
+			if (fraction > 0.5f) {
+				return pixel_type::threequarters;
+			}
+			if (fraction > 0.25f) {
+				return pixel_type::half;
+			}
+			return pixel_type::quarter;
+		}
+	}
+
+	particle_system::particle_system(size_t capacity)
+		: _capacity{ (max<size_t>(capacity, 1) + 7) & ~size_t{ 7 } }
+		, _x{ make_aligned<float, aligned_free>(_capacity) }
+		, _y{ make_aligned<float, aligned_free>(_capacity) }
+		, _vx{ make_aligned<float, aligned_free>(_capacity) }
+		, _vy{ make_aligned<float, aligned_free>(_capacity) }
+		, _life{ make_aligned<float, aligned_free>(_capacity) }
+		, _inv_life{ make_aligned<float, aligned_free>(_capacity) }
+		, _color{ make_aligned<int32_t, aligned_free>(_capacity) }
+	{
+	}
+
+	void particle_system::emit(float x, float y, float vx, float vy, float life, short color)
+	{
+		if (_size == _capacity || !(life > 0.0f)) {
+			return;
+		}
+		_x[_size] = x;
+		_y[_size] = y;
+		_vx[_size] = vx;
+		_vy[_size] = vy;
+		_life[_size] = life;
+		_inv_life[_size] = 1.0f / life;
+		_color[_size] = color;
+		++_size;
+	}
+
+	void particle_system::emit_burst(float x, float y, int count, float speed, float life, short color)
+	{
+		constexpr float two_pi = 6.2831853f;
+		auto next = [this] {
+			_seed ^= _seed << 13;
+			_seed ^= _seed >> 17;
+			_seed ^= _seed << 5;
+			return (_seed & 0xffffff) / float(0x1000000);
+		};
+		for (int i = 0; i < count && _size < _capacity; ++i) {
+			float a = next() * two_pi;
+			float s = next() * speed;
+			// a little spread in life so a burst doesn't vanish all on one frame
+			emit(x, y, cosf(a) * s, sinf(a) * s, life * (0.5f + 0.5f * next()), color);
+		}
+	}
+
+	void particle_system::update(float elapsed)
+	{
+		OLC_TRACE_ZONE("particles update");
+		if (g_has_avx2) {
+			update_avx2(elapsed);
+		}
+		else {
+			update_scalar(elapsed);
+		}
+	}
+
+	void particle_system::render(cmd_engine& engine) const
+	{
+		OLC_TRACE_ZONE("particles render");
+		if (g_has_avx2) {
+			render_avx2(engine);
+		}
+		else {
+			render_scalar(engine);
+		}
+	}
+
+	void particle_system::update_scalar(float dt)
+	{
+		float gx = _gx * dt;
+		float gy = _gy * dt;
+		size_t w = 0;
+		for (size_t i = 0; i < _size; ++i) {
+			float vx = _vx[i] + gx;
+			float vy = _vy[i] + gy;
+			float life = _life[i] - dt;
+			if (life > 0.0f) {
+				_x[w] = _x[i] + vx * dt;
+				_y[w] = _y[i] + vy * dt;
+				_vx[w] = vx;
+				_vy[w] = vy;
+				_life[w] = life;
+				_inv_life[w] = _inv_life[i];
+				_color[w] = _color[i];
+				++w;
+			}
+		}
+		_size = w;
+	}
+
+	void particle_system::update_avx2(float dt)
+	{
+		const __m256 vdt = _mm256_set1_ps(dt);
+		const __m256 vgx = _mm256_set1_ps(_gx * dt);
+		const __m256 vgy = _mm256_set1_ps(_gy * dt);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i size = _mm256_set1_epi32(static_cast<int>(_size));
+
+		// compacting in place is safe: the 8 lanes stored at w never reach past the 8 just loaded at i
+		size_t w = 0;
+		for (size_t i = 0; i < _size; i += 8) {
+			__m256 vx = _mm256_add_ps(_mm256_load_ps(&_vx[i]), vgx);
+			__m256 vy = _mm256_add_ps(_mm256_load_ps(&_vy[i]), vgy);
+			__m256 x = _mm256_fmadd_ps(vx, vdt, _mm256_load_ps(&_x[i]));
+			__m256 y = _mm256_fmadd_ps(vy, vdt, _mm256_load_ps(&_y[i]));
+			__m256 life = _mm256_sub_ps(_mm256_load_ps(&_life[i]), vdt);
+			__m256 inv_life = _mm256_load_ps(&_inv_life[i]);
+			__m256i color = _mm256_load_si256(reinterpret_cast<const __m256i*>(&_color[i]));
+
+			// lanes past the end hold leftovers of dead particles
+			__m256i index = _mm256_add_epi32(lane, _mm256_set1_epi32(static_cast<int>(i)));
+			__m256 in_range = _mm256_castsi256_ps(_mm256_cmpgt_epi32(size, index));
+			int alive = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(life, zero, _CMP_GT_OQ), in_range));
+			if (alive == 0) {
+				continue;
+			}
+
+			__m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(g_compact.lanes[alive]));
+			_mm256_storeu_ps(&_x[w], _mm256_permutevar8x32_ps(x, perm));
+			_mm256_storeu_ps(&_y[w], _mm256_permutevar8x32_ps(y, perm));
+			_mm256_storeu_ps(&_vx[w], _mm256_permutevar8x32_ps(vx, perm));
+			_mm256_storeu_ps(&_vy[w], _mm256_permutevar8x32_ps(vy, perm));
+			_mm256_storeu_ps(&_life[w], _mm256_permutevar8x32_ps(life, perm));
+			_mm256_storeu_ps(&_inv_life[w], _mm256_permutevar8x32_ps(inv_life, perm));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&_color[w]), _mm256_permutevar8x32_epi32(color, perm));
+			w += popcount(static_cast<unsigned>(alive));
+		}
+		_size = w;
+	}
+
+	void particle_system::render_scalar(cmd_engine& engine) const
+	{
+		CHAR_INFO* screen = engine._screen;
+		uint8_t* dirty = engine._row_dirty.data();
+		for (size_t i = 0; i < _size; ++i) {
+			int x = static_cast<int>(floorf(_x[i]));
+			int y = static_cast<int>(floorf(_y[i]));
+			if (engine.out_of_bound(x, y)) {
+				continue;
+			}
+			auto& ci = screen[engine.screen_index(x, y)];
+			ci.Char.UnicodeChar = shade(_life[i] * _inv_life[i]);
+			ci.Attributes = static_cast<WORD>(_color[i]);
+			dirty[y] = 1;
+		}
+	}
+
+	void particle_system::render_avx2(cmd_engine& engine) const
+	{
+		CHAR_INFO* screen = engine._screen;
+		uint8_t* dirty = engine._row_dirty.data();
+		const __m256i width = _mm256_set1_epi32(engine._width);
+		const __m256i height = _mm256_set1_epi32(engine._height);
+		const __m256i stride = _mm256_set1_epi32(engine._stride);
+		const __m256i minus_one = _mm256_set1_epi32(-1);
+		const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i size = _mm256_set1_epi32(static_cast<int>(_size));
+		const __m256 quarter = _mm256_set1_ps(0.25f);
+		const __m256 half = _mm256_set1_ps(0.5f);
+		const __m256 threequarters = _mm256_set1_ps(0.75f);
+
+		alignas(32) int32_t cells[8];
+		alignas(32) int32_t rows[8];
+		alignas(32) int32_t glyphs[8];
+		for (size_t i = 0; i < _size; i += 8) {
+			// cell coordinates and visibility 8 at a time, the scattered stores are left to scalar code
+			__m256i x = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_load_ps(&_x[i])));
+			__m256i y = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_load_ps(&_y[i])));
+			__m256i index = _mm256_add_epi32(lane, _mm256_set1_epi32(static_cast<int>(i)));
+			__m256i visible = _mm256_and_si256(
+				_mm256_and_si256(_mm256_cmpgt_epi32(x, minus_one), _mm256_cmpgt_epi32(width, x)),
+				_mm256_and_si256(_mm256_cmpgt_epi32(y, minus_one), _mm256_cmpgt_epi32(height, y)));
+			visible = _mm256_and_si256(visible, _mm256_cmpgt_epi32(size, index));
+			unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(visible)));
+			if (mask == 0) {
+				continue;
+			}
+
+			__m256 fraction = _mm256_mul_ps(_mm256_load_ps(&_life[i]), _mm256_load_ps(&_inv_life[i]));
+			__m256i glyph = _mm256_set1_epi32(pixel_type::quarter);
+			glyph = _mm256_blendv_epi8(glyph, _mm256_set1_epi32(pixel_type::half),
+				_mm256_castps_si256(_mm256_cmp_ps(fraction, quarter, _CMP_GT_OQ)));
+			glyph = _mm256_blendv_epi8(glyph, _mm256_set1_epi32(pixel_type::threequarters),
+				_mm256_castps_si256(_mm256_cmp_ps(fraction, half, _CMP_GT_OQ)));
+			glyph = _mm256_blendv_epi8(glyph, _mm256_set1_epi32(pixel_type::solid),
+				_mm256_castps_si256(_mm256_cmp_ps(fraction, threequarters, _CMP_GT_OQ)));
+
+			_mm256_store_si256(reinterpret_cast<__m256i*>(cells), _mm256_add_epi32(_mm256_mullo_epi32(y, stride), x));
+			_mm256_store_si256(reinterpret_cast<__m256i*>(rows), y);
+			_mm256_store_si256(reinterpret_cast<__m256i*>(glyphs), glyph);
+			// in lane order, so overlapping particles end up the same as the scalar path
+			for (; mask; mask &= mask - 1) {
+				int l = countr_zero(mask);
+				auto& ci = screen[cells[l]];
+				ci.Char.UnicodeChar = static_cast<wchar_t>(glyphs[l]);
+				ci.Attributes = static_cast<WORD>(_color[i + l]);
+				dirty[rows[l]] = 1;
+			}
+		}
+	}
+}
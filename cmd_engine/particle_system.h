@@ -0,0 +1,75 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <cstddef>
+#include <cstdint>
+#include <malloc.h>
+#include <memory>
+
+namespace olc
+{
+	//
+	// Large numbers of short lived points: explosions, sparks, rain.
+	//
+	// Particles are kept as structure of arrays and updated 8 at a time with AVX2 when the CPU has it (scalar
+	// otherwise): velocity picks up gravity, position integrates, life runs down, and dead particles are squeezed
+	// out in the same pass so the live ones stay packed at the front. render() writes the live particles straight
+	// into the engine's screen, with the glyph fading from solid to quarter shade as the particle ages.
+	//
+	// Capacity is fixed at construction, emitting into a full system drops the new particles.
+	//
+	class particle_system
+	{
+	public:
+		explicit particle_system(size_t capacity);
+
+		particle_system(const particle_system&) = delete;
+		particle_system& operator=(const particle_system&) = delete;
+
+		// life is in seconds
+		void emit(float x, float y, float vx, float vy, float life, short color = color_t::fg_white);
+		// count particles from (x, y) in random directions at up to speed
+		void emit_burst(float x, float y, int count, float speed, float life, short color = color_t::fg_white);
+
+		// acceleration applied to every particle, e.g. (0, 20) to fall
+		void set_gravity(float gx, float gy) { _gx = gx; _gy = gy; }
+
+		void update(float elapsed);
+		void render(cmd_engine& engine) const;
+		void clear() { _size = 0; }
+
+		size_t size() const { return _size; }
+		size_t capacity() const { return _capacity; }
+
+	private:
+		struct aligned_free
+		{
+			void operator()(void* p) const { _aligned_free(p); }
+		};
+		template<typename T>
+		using aligned_array = std::unique_ptr<T[], aligned_free>;
+
+		void update_scalar(float elapsed);
+		void update_avx2(float elapsed);
+		void render_scalar(cmd_engine& engine) const;
+		void render_avx2(cmd_engine& engine) const;
+
+	private:
+		// padded to a multiple of 8 so the vector loops never need a scalar tail
+		size_t _capacity;
+		size_t _size{ 0 };
+		float _gx{ 0.0f };
+		float _gy{ 0.0f };
+		uint32_t _seed{ 0x2545f491u };
+
+		aligned_array<float> _x;
+		aligned_array<float> _y;
+		aligned_array<float> _vx;
+		aligned_array<float> _vy;
+		// seconds left, and 1 / the life it started with, for the shade
+		aligned_array<float> _life;
+		aligned_array<float> _inv_life;
+		// 32 bit so it moves with the same shuffles as the floats
+		aligned_array<int32_t> _color;
+	};
+}
@@ -0,0 +1,472 @@
+#include "pathfinding.h"
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		// costs in fixed point, so paths of equal length tie exactly and the heap can break the ties
+		constexpr uint32_t g_straight = 1000;
+		constexpr uint32_t g_diagonal = 1414;
+
+		struct offset
+		{
+			int dx;
+			int dy;
+			uint32_t cost;
+		};
+
+		// straight ones first, and each next to its opposite so k ^ 1 reverses k
+		constexpr offset g_neighbours[8] = {
+			{ 1, 0, g_straight }, { -1, 0, g_straight }, { 0, 1, g_straight }, { 0, -1, g_straight },
+			{ 1, 1, g_diagonal }, { -1, -1, g_diagonal }, { 1, -1, g_diagonal }, { -1, 1, g_diagonal },
+		};
+		constexpr uint8_t g_no_direction = 8;
+
+		// exact cost without walls: diagonal steps while both axes differ, straight for the rest
+		uint32_t octile(int x1, int y1, int x2, int y2)
+		{
+			auto dx = static_cast<uint32_t>(abs(x1 - x2));
+			auto dy = static_cast<uint32_t>(abs(y1 - y2));
+			return g_straight * max(dx, dy) + (g_diagonal - g_straight) * min(dx, dy);
+		}
+
+		int sign(int v)
+		{
+			return (v > 0) - (v < 0);
+		}
+
+		// a diagonal step may not squeeze between two blocked cells or round a blocked corner
+		bool can_step(const grid_map& map, int x, int y, int dx, int dy)
+		{
+			return map.passable(x + dx, y + dy) && (!dx || !dy || (map.passable(x + dx, y) && map.passable(x, y + dy)));
+		}
+
+		// bit k set if the step to g_neighbours[k] is allowed from (x, y), from the 3x3 cells around it
+		uint32_t allowed_steps(const grid_map& map, int x, int y)
+		{
+			auto above = static_cast<uint32_t>(map.row_bits(x - 1, y - 1) & 7);
+			auto row = static_cast<uint32_t>(map.row_bits(x - 1, y) & 7);
+			auto below = static_cast<uint32_t>(map.row_bits(x - 1, y + 1) & 7);
+			uint32_t e = (row >> 2) & 1;
+			uint32_t w = row & 1;
+			uint32_t s = (below >> 1) & 1;
+			uint32_t n = (above >> 1) & 1;
+			return e | (w << 1) | (s << 2) | (n << 3) |
+				((e & s & (below >> 2)) << 4) |
+				((w & n & above) << 5) |
+				((e & n & (above >> 2)) << 6) |
+				((w & s & below) << 7);
+		}
+
+		void fill_lines(vector<uint64_t>& bits, int words_per_line, int length, int lines, bool passable)
+		{
+			uint64_t last = (length & 63) ? (uint64_t{ 1 } << (length & 63)) - 1 : ~uint64_t{ 0 };
+			for (int l = 0; l < lines; ++l) {
+				uint64_t* p = bits.data() + static_cast<size_t>(l) * words_per_line;
+				for (int w = 0; w < words_per_line; ++w) {
+					p[w] = passable ? (w == words_per_line - 1 ? last : ~uint64_t{ 0 }) : 0;
+				}
+			}
+		}
+	}
+
+	//
+	// grid_map class
+	//
+	grid_map::grid_map(int w, int h)
+		: _width{ w }
+		, _height{ h }
+		, _words_per_row{ (w + 63) / 64 }
+		, _words_per_column{ (h + 63) / 64 }
+		, _rows(static_cast<size_t>(_words_per_row) * h)
+		, _columns(static_cast<size_t>(_words_per_column) * w)
+	{
+		fill(true);
+	}
+
+	void grid_map::set_passable(int x, int y, bool passable)
+	{
+		if (x < 0 || x >= _width || y < 0 || y >= _height) {
+			return;
+		}
+		auto set_bit = [passable](uint64_t& word, int bit) {
+			word = passable ? word | (uint64_t{ 1 } << bit) : word & ~(uint64_t{ 1 } << bit);
+		};
+		set_bit(_rows[y * _words_per_row + (x >> 6)], x & 63);
+		set_bit(_columns[x * _words_per_column + (y >> 6)], y & 63);
+	}
+
+	void grid_map::fill(bool passable)
+	{
+		fill_lines(_rows, _words_per_row, _width, _height, passable);
+		fill_lines(_columns, _words_per_column, _height, _width, passable);
+	}
+
+	uint64_t grid_map::extract(const vector<uint64_t>& bits, int words_per_line, int length, int lines, int at, int line)
+	{
+		if (line < 0 || line >= lines || at >= length || at <= -64) {
+			return 0;
+		}
+		const uint64_t* p = bits.data() + static_cast<size_t>(line) * words_per_line;
+		auto word = [p, words_per_line](int w) {
+			return w >= 0 && w < words_per_line ? p[w] : 0;
+		};
+		// floors for negative at too
+		int w = at >> 6;
+		int shift = at & 63;
+		uint64_t lo = word(w);
+		return shift ? (lo >> shift) | (word(w + 1) << (64 - shift)) : lo;
+	}
+
+	//
+	// path_finder class
+	//
+	path_finder::path_finder(const grid_map& map)
+		: _map{ map }, _width{ map.width() }, _nodes(static_cast<size_t>(map.width()) * map.height())
+	{
+	}
+
+	bool path_finder::begin(grid_point from, grid_point to)
+	{
+		_heap.clear();
+		_expanded = 0;
+		_cost = 0;
+		if (!_map.passable(from.x, from.y) || !_map.passable(to.x, to.y)) {
+			return false;
+		}
+		if (++_generation == 0) {
+			// wrapped, every node could look current again
+			for (auto& n : _nodes) {
+				n.generation = 0;
+			}
+			_generation = 1;
+		}
+		relax(index(from.x, from.y), npos, 0, to);
+		return true;
+	}
+
+	void path_finder::relax(uint32_t i, uint32_t parent, uint32_t g, grid_point to)
+	{
+		auto& n = _nodes[i];
+		if (n.generation != _generation) {
+			auto pos = static_cast<uint32_t>(_heap.size());
+			n = { g, parent, _generation, pos };
+			_heap.push_back({ g + octile(static_cast<int>(i % _width), static_cast<int>(i / _width), to.x, to.y), g, i });
+			sift_up(pos);
+		}
+		else if (n.heap_index != npos && g < n.g) {
+			// the heuristic is consistent, a closed node never gets shorter
+			n.g = g;
+			n.parent = parent;
+			auto& e = _heap[n.heap_index];
+			e.f -= e.g - g;
+			e.g = g;
+			sift_up(n.heap_index);
+		}
+	}
+
+	uint32_t path_finder::pop()
+	{
+		uint32_t top = _heap.front().node;
+		_nodes[top].heap_index = npos;
+		auto last = _heap.back();
+		_heap.pop_back();
+		if (!_heap.empty()) {
+			_heap[0] = last;
+			sift_down(0);
+		}
+		return top;
+	}
+
+	void path_finder::sift_up(uint32_t pos)
+	{
+		auto e = _heap[pos];
+		while (pos > 0) {
+			uint32_t parent = (pos - 1) / 2;
+			if (!before(e, _heap[parent])) {
+				break;
+			}
+			_heap[pos] = _heap[parent];
+			_nodes[_heap[pos].node].heap_index = pos;
+			pos = parent;
+		}
+		_heap[pos] = e;
+		_nodes[e.node].heap_index = pos;
+	}
+
+	void path_finder::sift_down(uint32_t pos)
+	{
+		auto e = _heap[pos];
+		auto size = static_cast<uint32_t>(_heap.size());
+		for (;;) {
+			uint32_t child = pos * 2 + 1;
+			if (child >= size) {
+				break;
+			}
+			if (child + 1 < size && before(_heap[child + 1], _heap[child])) {
+				++child;
+			}
+			if (!before(_heap[child], e)) {
+				break;
+			}
+			_heap[pos] = _heap[child];
+			_nodes[_heap[pos].node].heap_index = pos;
+			pos = child;
+		}
+		_heap[pos] = e;
+		_nodes[e.node].heap_index = pos;
+	}
+
+	bool path_finder::find_path(grid_point from, grid_point to, vector<grid_point>& path)
+	{
+		path.clear();
+		if (!begin(from, to)) {
+			return false;
+		}
+		uint32_t goal = index(to.x, to.y);
+		while (!_heap.empty()) {
+			uint32_t i = pop();
+			++_expanded;
+			if (i == goal) {
+				build_path(to, path);
+				return true;
+			}
+			int x = static_cast<int>(i % _width);
+			int y = static_cast<int>(i / _width);
+			uint32_t g = _nodes[i].g;
+			for (uint32_t steps = allowed_steps(_map, x, y); steps; steps &= steps - 1) {
+				const auto& o = g_neighbours[countr_zero(steps)];
+				relax(index(x + o.dx, y + o.dy), i, g + o.cost, to);
+			}
+		}
+		return false;
+	}
+
+	int path_finder::jump_straight(int x, int y, int dx, int dy, grid_point to) const
+	{
+		// the same along a column as along a row, with the axes swapped
+		bool vertical = dx == 0;
+		int d = vertical ? dy : dx;
+		int pos = vertical ? y : x;
+		int line = vertical ? x : y;
+		int goal = (vertical ? to.x : to.y) == line ? (vertical ? to.y : to.x) : INT_MIN;
+		auto bits = [this, vertical](int at, int l) {
+			return vertical ? _map.column_bits(l, at) : _map.row_bits(at, l);
+		};
+
+		// Stops on the first cell that's blocked (no jump point), the goal, or where a wall beside the line ends:
+		// the cell beside it then can't be reached any shorter than through here.
+		for (int p = pos;;) {
+			if (d > 0) {
+				uint64_t here = bits(p + 1, line);
+				uint64_t stop = ~here |
+					(bits(p + 1, line - 1) & ~bits(p, line - 1)) |
+					(bits(p + 1, line + 1) & ~bits(p, line + 1));
+				if (goal > p && goal <= p + 64) {
+					stop |= uint64_t{ 1 } << (goal - p - 1);
+				}
+				if (stop) {
+					int k = countr_zero(stop);
+					return ((here >> k) & 1) ? p + 1 + k - pos : 0;
+				}
+				p += 64;
+			}
+			else {
+				uint64_t here = bits(p - 64, line);
+				uint64_t stop = ~here |
+					(bits(p - 64, line - 1) & ~bits(p - 63, line - 1)) |
+					(bits(p - 64, line + 1) & ~bits(p - 63, line + 1));
+				if (goal >= p - 64 && goal < p) {
+					stop |= uint64_t{ 1 } << (goal - (p - 64));
+				}
+				if (stop) {
+					int k = 63 - countl_zero(stop);
+					return ((here >> k) & 1) ? pos - (p - 64 + k) : 0;
+				}
+				p -= 64;
+			}
+		}
+	}
+
+	bool path_finder::jump(int& x, int& y, int dx, int dy, grid_point to) const
+	{
+		if (!dx || !dy) {
+			int k = jump_straight(x, y, dx, dy, to);
+			x += dx * k;
+			y += dy * k;
+			return k > 0;
+		}
+		for (;;) {
+			if (!can_step(_map, x, y, dx, dy)) {
+				return false;
+			}
+			x += dx;
+			y += dy;
+			// a diagonal stops where one of its straight arms finds something
+			if ((x == to.x && y == to.y) || jump_straight(x, y, dx, 0, to) || jump_straight(x, y, 0, dy, to)) {
+				return true;
+			}
+		}
+	}
+
+	bool path_finder::find_path_jps(grid_point from, grid_point to, vector<grid_point>& path)
+	{
+		path.clear();
+		if (!begin(from, to)) {
+			return false;
+		}
+		uint32_t goal = index(to.x, to.y);
+		while (!_heap.empty()) {
+			uint32_t i = pop();
+			++_expanded;
+			if (i == goal) {
+				build_path(to, path);
+				return true;
+			}
+			int x = static_cast<int>(i % _width);
+			int y = static_cast<int>(i / _width);
+			uint32_t parent = _nodes[i].parent;
+			uint32_t g = _nodes[i].g;
+
+			// the directions worth jumping in given the one we came from, every direction at the start
+			int dirs[8][2];
+			int ndirs = 0;
+			auto add = [&](int dx, int dy) {
+				dirs[ndirs][0] = dx;
+				dirs[ndirs][1] = dy;
+				++ndirs;
+			};
+			if (parent == npos) {
+				for (const auto& o : g_neighbours) {
+					add(o.dx, o.dy);
+				}
+			}
+			else {
+				int dx = sign(x - static_cast<int>(parent % _width));
+				int dy = sign(y - static_cast<int>(parent / _width));
+				if (dx && dy) {
+					add(dx, dy);
+					add(dx, 0);
+					add(0, dy);
+				}
+				else if (dx) {
+					add(dx, 0);
+					add(dx, 1);
+					add(dx, -1);
+					add(0, 1);
+					add(0, -1);
+				}
+				else {
+					add(0, dy);
+					add(1, dy);
+					add(-1, dy);
+					add(1, 0);
+					add(-1, 0);
+				}
+			}
+
+			for (int d = 0; d < ndirs; ++d) {
+				int jx = x;
+				int jy = y;
+				if (jump(jx, jy, dirs[d][0], dirs[d][1], to)) {
+					// a straight or diagonal line, so the octile distance is its exact cost
+					relax(index(jx, jy), i, g + octile(x, y, jx, jy), to);
+				}
+			}
+		}
+		return false;
+	}
+
+	void path_finder::build_path(grid_point to, vector<grid_point>& path)
+	{
+		uint32_t i = index(to.x, to.y);
+		_cost = _nodes[i].g;
+		grid_point p = to;
+		path.push_back(p);
+		while (_nodes[i].parent != npos) {
+			uint32_t parent = _nodes[i].parent;
+			grid_point q{ static_cast<int>(parent % _width), static_cast<int>(parent / _width) };
+			// jump points are joined by straight or diagonal lines, walk the cells in between
+			int dx = sign(q.x - p.x);
+			int dy = sign(q.y - p.y);
+			while (p != q) {
+				p.x += dx;
+				p.y += dy;
+				path.push_back(p);
+			}
+			i = parent;
+		}
+		reverse(path.begin(), path.end());
+	}
+
+	//
+	// flow_field class
+	//
+	flow_field::flow_field(const grid_map& map)
+		: _map{ map }
+	{
+	}
+
+	void flow_field::build(const vector<grid_point>& targets)
+	{
+		int w = _map.width();
+		size_t n = static_cast<size_t>(w) * _map.height();
+		_distance.assign(n, unreachable);
+		_direction.assign(n, g_no_direction);
+		_queue.resize(n);
+
+		// breadth first from all targets together, each cell is reached first from its nearest one
+		size_t head = 0;
+		size_t tail = 0;
+		for (const auto& t : targets) {
+			if (_map.passable(t.x, t.y)) {
+				auto i = static_cast<uint32_t>(t.y * w + t.x);
+				if (_distance[i] != 0) {
+					_distance[i] = 0;
+					_queue[tail++] = i;
+				}
+			}
+		}
+		while (head < tail) {
+			uint32_t i = _queue[head++];
+			int x = static_cast<int>(i % w);
+			int y = static_cast<int>(i / w);
+			uint32_t d = _distance[i] + 1;
+			for (uint32_t steps = allowed_steps(_map, x, y); steps; steps &= steps - 1) {
+				int k = countr_zero(steps);
+				const auto& o = g_neighbours[k];
+				auto j = static_cast<uint32_t>((y + o.dy) * w + x + o.dx);
+				if (_distance[j] == unreachable) {
+					_distance[j] = d;
+					// back the way the search came
+					_direction[j] = static_cast<uint8_t>(k ^ 1);
+					_queue[tail++] = j;
+				}
+			}
+		}
+	}
+
+	uint32_t flow_field::distance(int x, int y) const
+	{
+		if (x < 0 || x >= _map.width() || y < 0 || y >= _map.height() || _distance.empty()) {
+			return unreachable;
+		}
+		return _distance[y * _map.width() + x];
+	}
+
+	grid_point flow_field::direction(int x, int y) const
+	{
+		if (x < 0 || x >= _map.width() || y < 0 || y >= _map.height() || _direction.empty()) {
+			return { 0, 0 };
+		}
+		uint8_t k = _direction[y * _map.width() + x];
+		return k == g_no_direction ? grid_point{ 0, 0 } : grid_point{ g_neighbours[k].dx, g_neighbours[k].dy };
+	}
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace olc
+{
+	struct grid_point
+	{
+		int x;
+		int y;
+
+		bool operator==(const grid_point&) const = default;
+	};
+
+	//
+	// Which cells of a grid can be walked, one bit per cell. Outside the grid is never passable.
+	//
+	// The bits are kept by rows and again by columns, so searches can test 64 cells along either axis at once.
+	//
+	class grid_map
+	{
+	public:
+		// Every cell passable to start with
+		grid_map(int w, int h);
+
+		int width() const { return _width; }
+		int height() const { return _height; }
+
+		bool passable(int x, int y) const
+		{
+			if (x < 0 || x >= _width || y < 0 || y >= _height) {
+				return false;
+			}
+			return (_rows[y * _words_per_row + (x >> 6)] >> (x & 63)) & 1;
+		}
+		void set_passable(int x, int y, bool passable);
+		void fill(bool passable);
+
+		// The 64 cells of row y from x on, bit 0 being (x, y); cells outside the grid are 0
+		uint64_t row_bits(int x, int y) const { return extract(_rows, _words_per_row, _width, _height, x, y); }
+		// The 64 cells of column x from y on, bit 0 being (x, y)
+		uint64_t column_bits(int x, int y) const { return extract(_columns, _words_per_column, _height, _width, y, x); }
+
+	private:
+		static uint64_t extract(const std::vector<uint64_t>& bits, int words_per_line, int length, int lines, int at, int line);
+
+	private:
+		int _width;
+		int _height;
+		int _words_per_row;
+		int _words_per_column;
+		// padding bits past the end of a line are always 0
+		std::vector<uint64_t> _rows;
+		std::vector<uint64_t> _columns;
+	};
+
+	//
+	// Shortest paths between two cells of a grid_map, moving to any of the 8 neighbours. Straight steps cost 1 and
+	// diagonal ones 1.414; a diagonal step never cuts the corner of a blocked cell.
+	//
+	// find_path is A* with a binary heap open set. find_path_jps is Jump Point Search, which finds equally short
+	// paths but only puts the cells where a path may turn on the heap, so it's several times faster on open maps
+	// where every step costs the same. Both expand to a path of neighbouring cells, from included to to included.
+	//
+	// The per cell search state is allocated once for the map's size and marked stale between queries by bumping a
+	// generation counter instead of being cleared, so a query costs only the cells it touches and, once the heap and
+	// the caller's path vector have grown, never allocates. Not thread safe, give each thread its own path_finder.
+	//
+	class path_finder
+	{
+	public:
+		// The map is referenced, not copied, and may change between queries but not its size
+		explicit path_finder(const grid_map& map);
+
+		// False, with path empty, if to can't be reached
+		bool find_path(grid_point from, grid_point to, std::vector<grid_point>& path);
+		bool find_path_jps(grid_point from, grid_point to, std::vector<grid_point>& path);
+
+		// Length of the last path found, in steps weighted as above
+		float cost() const { return _cost / 1000.0f; }
+		// Cells taken off the open set by the last query
+		size_t expanded() const { return _expanded; }
+
+	private:
+		static constexpr uint32_t npos = UINT32_MAX;
+
+		// costs are fixed point, 1000 a straight step
+		struct node
+		{
+			uint32_t g;
+			uint32_t parent;
+			// node is stale unless this matches _generation
+			uint32_t generation;
+			// position in _heap, npos once closed
+			uint32_t heap_index;
+		};
+
+		// the costs are copied in so ordering the heap doesn't chase the nodes
+		struct open_entry
+		{
+			uint32_t f;
+			uint32_t g;
+			uint32_t node;
+		};
+
+		// Starts a query, false if either end isn't passable
+		bool begin(grid_point from, grid_point to);
+		// Opens or improves the cell at index i reached from parent with cost g
+		void relax(uint32_t i, uint32_t parent, uint32_t g, grid_point to);
+		uint32_t pop();
+		// heap order, ties go to the entry further along which heads straight for the goal on open ground
+		static bool before(const open_entry& a, const open_entry& b) { return a.f < b.f || (a.f == b.f && a.g > b.g); }
+		void sift_up(uint32_t pos);
+		void sift_down(uint32_t pos);
+		// Walks from (x, y) in direction (dx, dy) until a cell where the path may have to turn; false if it runs
+		// into a wall first. Leaves (x, y) on the jump point.
+		bool jump(int& x, int& y, int dx, int dy, grid_point to) const;
+		// jump along a row (dy == 0) or a column, 64 cells at a time. Returns the cells to the jump point, 0 if none.
+		int jump_straight(int x, int y, int dx, int dy, grid_point to) const;
+		// Follows the parents back from to and fills in the cells between jump points
+		void build_path(grid_point to, std::vector<grid_point>& path);
+
+		uint32_t index(int x, int y) const { return static_cast<uint32_t>(y) * _width + x; }
+
+	private:
+		const grid_map& _map;
+		int _width;
+		std::vector<node> _nodes;
+		std::vector<open_entry> _heap;
+		uint32_t _generation{ 0 };
+		uint32_t _cost{ 0 };
+		size_t _expanded{ 0 };
+	};
+
+	//
+	// Steps toward the nearest of a set of targets from every cell of a grid_map, for many agents heading to the
+	// same places: one breadth first search from all targets at once, then each agent only looks up its cell.
+	// Moves are to the 8 neighbours without cutting corners, all one step.
+	//
+	// Rebuilding reuses the buffers, it never allocates once built for the map's size.
+	//
+	class flow_field
+	{
+	public:
+		static constexpr uint32_t unreachable = UINT32_MAX;
+
+	public:
+		// The map is referenced, not copied, and may change between builds but not its size
+		explicit flow_field(const grid_map& map);
+
+		void build(const std::vector<grid_point>& targets);
+
+		// Steps to the nearest target, unreachable if none can be reached
+		uint32_t distance(int x, int y) const;
+		// The step to take from (x, y), each of x and y -1, 0 or 1; {0, 0} on a target or when unreachable
+		grid_point direction(int x, int y) const;
+
+	private:
+		const grid_map& _map;
+		std::vector<uint32_t> _distance;
+		// index into the neighbour offsets, 8 for none
+		std::vector<uint8_t> _direction;
+		std::vector<uint32_t> _queue;
+	};
+}
@@ -0,0 +1,774 @@
+#include "physics.h"
+#include "cmd_engine.h"
+#include "job_system.h"
+#include "trace.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		constexpr int g_max_steps = 8;
+		// penetration left alone so resting contacts stay touching, and how much of the rest is pushed out per step
+		constexpr float g_slop = 0.02f;
+		constexpr float g_baumgarte = 0.2f;
+		// and at most this much of it, bodies dropped deep inside each other ease apart instead of flying off
+		constexpr float g_max_correction = 0.2f;
+		// slower impacts don't bounce
+		constexpr float g_bounce_speed = 1.0f;
+		// the furthest a body moves in a step, under the thinnest wall so a squeezed pile can't pop through it
+		constexpr float g_max_translation = 1.0f;
+		// shorter polygon edges, or corners turning less (the sine of the angle), are repeated or collinear points
+		constexpr float g_min_edge = 0.001f;
+		constexpr float g_min_turn = 0.001f;
+
+		constexpr int mv = physics_world::max_vertices;
+
+		float cross(float ax, float ay, float bx, float by)
+		{
+			return ax * by - ay * bx;
+		}
+
+		uint64_t pair_key(uint32_t a, uint32_t b)
+		{
+			return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+		}
+
+		struct clip_vertex
+		{
+			float x;
+			float y;
+			uint32_t id;
+		};
+
+		// Keeps the part of the segment with dot(n, p) <= offset, a cut end takes the plane's id
+		int clip(const clip_vertex in[2], clip_vertex out[2], float nx, float ny, float offset, uint32_t id)
+		{
+			int n = 0;
+			float d0 = nx * in[0].x + ny * in[0].y - offset;
+			float d1 = nx * in[1].x + ny * in[1].y - offset;
+			if (d0 <= 0.0f) {
+				out[n++] = in[0];
+			}
+			if (d1 <= 0.0f) {
+				out[n++] = in[1];
+			}
+			if (d0 * d1 < 0.0f) {
+				float t = d0 / (d0 - d1);
+				out[n++] = { in[0].x + t * (in[1].x - in[0].x), in[0].y + t * (in[1].y - in[0].y), id };
+			}
+			return n;
+		}
+
+		uint32_t find_root(vector<uint32_t>& parent, uint32_t i)
+		{
+			while (parent[i] != i) {
+				parent[i] = parent[parent[i]];
+				i = parent[i];
+			}
+			return i;
+		}
+	}
+
+	//
+	// physics_world class
+	//
+	physics_world::physics_world(float timestep)
+		: _timestep{ timestep }
+	{
+	}
+
+	physics_world::body_id physics_world::add_body(shape_type::enum_t type, float x, float y, float angle)
+	{
+		body_id id;
+		if (!_free.empty()) {
+			id = _free.back();
+			_free.pop_back();
+		}
+		else {
+			id = static_cast<body_id>(_x.size());
+			for (auto* v : { &_x, &_y, &_angle, &_vx, &_vy, &_w, &_inv_mass, &_inv_inertia, &_friction, &_restitution,
+				&_radius, &_min_x, &_min_y, &_max_x, &_max_y }) {
+				v->push_back(0.0f);
+			}
+			_type.push_back(0);
+			_alive.push_back(0);
+			_vertex_count.push_back(0);
+			_shapes.emplace_back();
+			for (auto* v : { &_local_x, &_local_y, &_local_nx, &_local_ny, &_world_x, &_world_y, &_world_nx, &_world_ny }) {
+				v->resize(v->size() + mv, 0.0f);
+			}
+		}
+		_x[id] = x;
+		_y[id] = y;
+		_angle[id] = angle;
+		_vx[id] = 0.0f;
+		_vy[id] = 0.0f;
+		_w[id] = 0.0f;
+		_friction[id] = 0.5f;
+		_restitution[id] = 0.2f;
+		_type[id] = type;
+		_alive[id] = 1;
+		_vertex_count[id] = 0;
+		_shapes[id].clear();
+		// placed by the next step's insertion sort
+		_order.push_back(id);
+		return id;
+	}
+
+	physics_world::body_id physics_world::add_circle(float x, float y, float radius, float density)
+	{
+		auto id = add_body(shape_type::circle, x, y, 0.0f);
+		float mass = density * 3.14159265f * radius * radius;
+		_inv_mass[id] = mass > 0.0f ? 1.0f / mass : 0.0f;
+		_inv_inertia[id] = mass > 0.0f ? 2.0f / (mass * radius * radius) : 0.0f;
+		_radius[id] = radius;
+		return id;
+	}
+
+	physics_world::body_id physics_world::add_polygon(const model& shape, float x, float y, float angle, float density)
+	{
+		int n = static_cast<int>(shape.size());
+		if (n < 3 || n > max_vertices) {
+			throw olc_exception(L"A physics polygon needs 3 to 8 vertices");
+		}
+		model m = shape;
+		float area = 0.0f;
+		float cx = 0.0f;
+		float cy = 0.0f;
+		for (int i = 0; i < n; ++i) {
+			auto [x1, y1] = m[i];
+			auto [x2, y2] = m[(i + 1) % n];
+			float a = 0.5f * cross(x1, y1, x2, y2);
+			area += a;
+			cx += a * (x1 + x2) / 3.0f;
+			cy += a * (y1 + y2) / 3.0f;
+		}
+		if (fabsf(area) < FLT_EPSILON) {
+			throw olc_exception(L"A physics polygon can't be flat");
+		}
+		cx /= area;
+		cy /= area;
+		// counter clockwise from here on, which puts the edge normals outward
+		if (area < 0.0f) {
+			reverse(m.begin(), m.end());
+			area = -area;
+		}
+		for (auto& [vx, vy] : m) {
+			vx -= cx;
+			vy -= cy;
+		}
+		float inertia = 0.0f;
+		float radius = 0.0f;
+		for (int i = 0; i < n; ++i) {
+			auto [x1, y1] = m[i];
+			auto [x2, y2] = m[(i + 1) % n];
+			auto [x3, y3] = m[(i + 2) % n];
+			// a zero length edge has no normal, and collinear ones are one face the contacts would pick between
+			float len1 = sqrtf((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+			float len2 = sqrtf((x3 - x2) * (x3 - x2) + (y3 - y2) * (y3 - y2));
+			if (len1 < g_min_edge || len2 < g_min_edge) {
+				throw olc_exception(L"A physics polygon can't repeat a point");
+			}
+			float turn = cross(x2 - x1, y2 - y1, x3 - x2, y3 - y2);
+			if (turn < -g_min_turn * len1 * len2) {
+				throw olc_exception(L"A physics polygon must be convex");
+			}
+			if (turn < g_min_turn * len1 * len2) {
+				throw olc_exception(L"A physics polygon can't have three points in a line");
+			}
+			inertia += cross(x1, y1, x2, y2) * (x1 * x1 + x1 * x2 + x2 * x2 + y1 * y1 + y1 * y2 + y2 * y2) / 12.0f;
+			radius = max(radius, sqrtf(x1 * x1 + y1 * y1));
+		}
+
+		// placed at the centroid, so the shape as given lands where asked
+		float c = cosf(angle);
+		float s = sinf(angle);
+		auto id = add_body(shape_type::polygon, x + c * cx - s * cy, y + s * cx + c * cy, angle);
+		float mass = density * area;
+		_inv_mass[id] = mass > 0.0f ? 1.0f / mass : 0.0f;
+		_inv_inertia[id] = mass > 0.0f ? 1.0f / (density * inertia) : 0.0f;
+		_radius[id] = radius;
+		_vertex_count[id] = static_cast<uint8_t>(n);
+		for (int i = 0; i < n; ++i) {
+			auto [x1, y1] = m[i];
+			auto [x2, y2] = m[(i + 1) % n];
+			float len = sqrtf((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+			_local_x[id * mv + i] = x1;
+			_local_y[id * mv + i] = y1;
+			_local_nx[id * mv + i] = (y2 - y1) / len;
+			_local_ny[id * mv + i] = -(x2 - x1) / len;
+		}
+		_shapes[id] = move(m);
+		return id;
+	}
+
+	void physics_world::remove(body_id id)
+	{
+		_alive[id] = 0;
+		_free.push_back(id);
+		_order.erase(find(_order.begin(), _order.end(), id));
+		// a body reusing the id mustn't pick up its contacts
+		auto touches = [id](const contact& c) { return c.a == id || c.b == id; };
+		_contacts.erase(remove_if(_contacts.begin(), _contacts.end(), touches), _contacts.end());
+	}
+
+	void physics_world::set_position(body_id id, float x, float y, float angle)
+	{
+		_x[id] = x;
+		_y[id] = y;
+		_angle[id] = angle;
+	}
+
+	void physics_world::apply_impulse(body_id id, float ix, float iy)
+	{
+		_vx[id] += ix * _inv_mass[id];
+		_vy[id] += iy * _inv_mass[id];
+	}
+
+	void physics_world::set_material(body_id id, float friction, float restitution)
+	{
+		_friction[id] = friction;
+		_restitution[id] = restitution;
+	}
+
+	int physics_world::update(float elapsed)
+	{
+		_accumulator += elapsed;
+		int steps = 0;
+		while (_accumulator >= _timestep && steps < g_max_steps) {
+			step();
+			_accumulator -= _timestep;
+			++steps;
+		}
+		if (steps == g_max_steps) {
+			_accumulator = 0.0f;
+		}
+		return steps;
+	}
+
+	void physics_world::step()
+	{
+		OLC_TRACE_ZONE("physics step");
+		update_bounds();
+		find_contacts();
+
+		float dt = _timestep;
+		for (auto id : _order) {
+			if (_inv_mass[id] > 0.0f) {
+				_vx[id] += _gx * dt;
+				_vy[id] += _gy * dt;
+			}
+		}
+
+		build_islands();
+		int islands = static_cast<int>(island_count());
+		if (_jobs && islands > 1) {
+			// a few chunks per thread so an island much bigger than the rest doesn't hold up the others
+			int grain = max(1, islands / static_cast<int>(_jobs->thread_count() * 4));
+			_jobs->parallel_for_rows(0, islands, grain, [this](int begin, int end) { solve_islands(begin, end); });
+		}
+		else {
+			solve_islands(0, islands);
+		}
+
+		integrate_positions();
+	}
+
+	void physics_world::update_bounds()
+	{
+		for (auto id : _order) {
+			if (_type[id] == shape_type::circle) {
+				float r = _radius[id];
+				_min_x[id] = _x[id] - r;
+				_min_y[id] = _y[id] - r;
+				_max_x[id] = _x[id] + r;
+				_max_y[id] = _y[id] + r;
+				continue;
+			}
+			float c = cosf(_angle[id]);
+			float s = sinf(_angle[id]);
+			float min_x = FLT_MAX;
+			float min_y = FLT_MAX;
+			float max_x = -FLT_MAX;
+			float max_y = -FLT_MAX;
+			size_t base = static_cast<size_t>(id) * mv;
+			for (int i = 0; i < _vertex_count[id]; ++i) {
+				float lx = _local_x[base + i];
+				float ly = _local_y[base + i];
+				float wx = _x[id] + c * lx - s * ly;
+				float wy = _y[id] + s * lx + c * ly;
+				_world_x[base + i] = wx;
+				_world_y[base + i] = wy;
+				_world_nx[base + i] = c * _local_nx[base + i] - s * _local_ny[base + i];
+				_world_ny[base + i] = s * _local_nx[base + i] + c * _local_ny[base + i];
+				min_x = min(min_x, wx);
+				min_y = min(min_y, wy);
+				max_x = max(max_x, wx);
+				max_y = max(max_y, wy);
+			}
+			_min_x[id] = min_x;
+			_min_y[id] = min_y;
+			_max_x[id] = max_x;
+			_max_y[id] = max_y;
+		}
+	}
+
+	void physics_world::find_contacts()
+	{
+		// nearly sorted from last step, insertion sort only moves what changed places
+		for (size_t i = 1; i < _order.size(); ++i) {
+			body_id id = _order[i];
+			float key = _min_x[id];
+			size_t j = i;
+			for (; j > 0 && _min_x[_order[j - 1]] > key; --j) {
+				_order[j] = _order[j - 1];
+			}
+			_order[j] = id;
+		}
+
+		_pairs.clear();
+		for (size_t i = 0; i < _order.size(); ++i) {
+			body_id a = _order[i];
+			float max_x = _max_x[a];
+			for (size_t j = i + 1; j < _order.size() && _min_x[_order[j]] <= max_x; ++j) {
+				body_id b = _order[j];
+				if (_max_y[a] < _min_y[b] || _max_y[b] < _min_y[a] || (_inv_mass[a] == 0.0f && _inv_mass[b] == 0.0f)) {
+					continue;
+				}
+				_pairs.push_back(pair_key(a, b));
+			}
+		}
+		// in key order, so the contacts come out sorted like last step's
+		sort(_pairs.begin(), _pairs.end());
+
+		swap(_contacts, _previous);
+		_contacts.clear();
+		size_t prev = 0;
+		for (auto key : _pairs) {
+			contact c;
+			if (!collide(static_cast<body_id>(key >> 32), static_cast<body_id>(key), c)) {
+				continue;
+			}
+			c.key = key;
+			c.friction = sqrtf(_friction[c.a] * _friction[c.b]);
+			c.restitution = max(_restitution[c.a], _restitution[c.b]);
+			for (int i = 0; i < c.count; ++i) {
+				c.points[i].normal_impulse = 0.0f;
+				c.points[i].tangent_impulse = 0.0f;
+				c.points[i].resting = false;
+			}
+			// the same points as last step start from the impulses they ended with
+			for (; prev < _previous.size() && _previous[prev].key < key; ++prev) {
+			}
+			if (prev < _previous.size() && _previous[prev].key == key) {
+				const auto& old = _previous[prev];
+				for (int i = 0; i < c.count; ++i) {
+					for (int k = 0; k < old.count; ++k) {
+						if (old.points[k].feature == c.points[i].feature) {
+							c.points[i].normal_impulse = old.points[k].normal_impulse;
+							c.points[i].tangent_impulse = old.points[k].tangent_impulse;
+							c.points[i].resting = true;
+						}
+					}
+				}
+			}
+			_contacts.push_back(c);
+		}
+	}
+
+	bool physics_world::collide(body_id a, body_id b, contact& c) const
+	{
+		bool poly_a = _type[a] == shape_type::polygon;
+		bool poly_b = _type[b] == shape_type::polygon;
+		if (poly_a && poly_b) {
+			return collide_polygons(a, b, c);
+		}
+		if (poly_a) {
+			return collide_polygon_circle(a, b, c);
+		}
+		if (poly_b) {
+			return collide_polygon_circle(b, a, c);
+		}
+		return collide_circles(a, b, c);
+	}
+
+	bool physics_world::collide_circles(body_id a, body_id b, contact& c) const
+	{
+		float dx = _x[b] - _x[a];
+		float dy = _y[b] - _y[a];
+		float r = _radius[a] + _radius[b];
+		float d2 = dx * dx + dy * dy;
+		if (d2 > r * r) {
+			return false;
+		}
+		float d = sqrtf(d2);
+		c.a = a;
+		c.b = b;
+		c.nx = d > FLT_EPSILON ? dx / d : 1.0f;
+		c.ny = d > FLT_EPSILON ? dy / d : 0.0f;
+		c.count = 1;
+		auto& p = c.points[0];
+		p.depth = r - d;
+		// halfway through the overlap
+		float along = _radius[a] - 0.5f * p.depth;
+		p.x = _x[a] + c.nx * along;
+		p.y = _y[a] + c.ny * along;
+		p.feature = 0;
+		return true;
+	}
+
+	bool physics_world::collide_polygon_circle(body_id a, body_id b, contact& c) const
+	{
+		size_t base = static_cast<size_t>(a) * mv;
+		int n = _vertex_count[a];
+		float cx = _x[b];
+		float cy = _y[b];
+		float r = _radius[b];
+
+		// the face the center is furthest in front of
+		int edge = 0;
+		float separation = -FLT_MAX;
+		for (int i = 0; i < n; ++i) {
+			float s = _world_nx[base + i] * (cx - _world_x[base + i]) + _world_ny[base + i] * (cy - _world_y[base + i]);
+			if (s > r) {
+				return false;
+			}
+			if (s > separation) {
+				separation = s;
+				edge = i;
+			}
+		}
+
+		float v1x = _world_x[base + edge];
+		float v1y = _world_y[base + edge];
+		float v2x = _world_x[base + (edge + 1) % n];
+		float v2y = _world_y[base + (edge + 1) % n];
+		float nx = _world_nx[base + edge];
+		float ny = _world_ny[base + edge];
+		uint32_t feature = edge;
+		// past either end of the face the nearest point is its corner
+		float vx = 0.0f;
+		float vy = 0.0f;
+		bool corner = false;
+		if (separation > 0.0f) {
+			if ((cx - v1x) * (v2x - v1x) + (cy - v1y) * (v2y - v1y) <= 0.0f) {
+				vx = v1x;
+				vy = v1y;
+				corner = true;
+			}
+			else if ((cx - v2x) * (v1x - v2x) + (cy - v2y) * (v1y - v2y) <= 0.0f) {
+				vx = v2x;
+				vy = v2y;
+				corner = true;
+				feature = (edge + 1) % n;
+			}
+		}
+		if (corner) {
+			float dx = cx - vx;
+			float dy = cy - vy;
+			float d2 = dx * dx + dy * dy;
+			if (d2 > r * r) {
+				return false;
+			}
+			float d = sqrtf(d2);
+			nx = d > FLT_EPSILON ? dx / d : nx;
+			ny = d > FLT_EPSILON ? dy / d : ny;
+			separation = d;
+			feature |= 0x100;
+		}
+
+		c.a = a;
+		c.b = b;
+		c.nx = nx;
+		c.ny = ny;
+		c.count = 1;
+		auto& p = c.points[0];
+		p.depth = r - separation;
+		// halfway between the polygon's surface and the circle's
+		float back = 0.5f * (r + separation);
+		p.x = cx - nx * back;
+		p.y = cy - ny * back;
+		p.feature = feature;
+		return true;
+	}
+
+	float physics_world::max_separation(body_id a, body_id b, int& edge) const
+	{
+		size_t base_a = static_cast<size_t>(a) * mv;
+		size_t base_b = static_cast<size_t>(b) * mv;
+		int na = _vertex_count[a];
+		int nb = _vertex_count[b];
+		float best = -FLT_MAX;
+		for (int i = 0; i < na; ++i) {
+			float nx = _world_nx[base_a + i];
+			float ny = _world_ny[base_a + i];
+			float ax = _world_x[base_a + i];
+			float ay = _world_y[base_a + i];
+			// b's deepest vertex past this face
+			float s = FLT_MAX;
+			for (int j = 0; j < nb; ++j) {
+				s = min(s, nx * (_world_x[base_b + j] - ax) + ny * (_world_y[base_b + j] - ay));
+			}
+			if (s > best) {
+				best = s;
+				edge = i;
+			}
+		}
+		return best;
+	}
+
+	bool physics_world::collide_polygons(body_id a, body_id b, contact& c) const
+	{
+		int edge_a = 0;
+		float sep_a = max_separation(a, b, edge_a);
+		if (sep_a > 0.0f) {
+			return false;
+		}
+		int edge_b = 0;
+		float sep_b = max_separation(b, a, edge_b);
+		if (sep_b > 0.0f) {
+			return false;
+		}
+
+		// the reference face is the least penetrating one, a's unless b's is clearly better so it doesn't flicker
+		body_id ref = a;
+		body_id inc = b;
+		int edge = edge_a;
+		bool flip = false;
+		if (sep_b > sep_a + 0.1f * g_slop) {
+			ref = b;
+			inc = a;
+			edge = edge_b;
+			flip = true;
+		}
+		size_t base_r = static_cast<size_t>(ref) * mv;
+		size_t base_i = static_cast<size_t>(inc) * mv;
+		int nr = _vertex_count[ref];
+		int ni = _vertex_count[inc];
+		float nx = _world_nx[base_r + edge];
+		float ny = _world_ny[base_r + edge];
+
+		// the incident face is the one facing the reference face the most
+		int inc_edge = 0;
+		float facing = FLT_MAX;
+		for (int i = 0; i < ni; ++i) {
+			float d = nx * _world_nx[base_i + i] + ny * _world_ny[base_i + i];
+			if (d < facing) {
+				facing = d;
+				inc_edge = i;
+			}
+		}
+		int inc_next = (inc_edge + 1) % ni;
+		clip_vertex incident[2] = {
+			{ _world_x[base_i + inc_edge], _world_y[base_i + inc_edge], static_cast<uint32_t>(inc_edge) },
+			{ _world_x[base_i + inc_next], _world_y[base_i + inc_next], static_cast<uint32_t>(inc_next) },
+		};
+
+		// cut it to the reference face's width
+		float v1x = _world_x[base_r + edge];
+		float v1y = _world_y[base_r + edge];
+		float v2x = _world_x[base_r + (edge + 1) % nr];
+		float v2y = _world_y[base_r + (edge + 1) % nr];
+		float tx = v2x - v1x;
+		float ty = v2y - v1y;
+		float len = sqrtf(tx * tx + ty * ty);
+		tx /= len;
+		ty /= len;
+		clip_vertex side1[2];
+		clip_vertex side2[2];
+		if (clip(incident, side1, -tx, -ty, -(tx * v1x + ty * v1y), 0x10) < 2) {
+			return false;
+		}
+		if (clip(side1, side2, tx, ty, tx * v2x + ty * v2y, 0x20) < 2) {
+			return false;
+		}
+
+		// What's left behind the reference face is touching. A point is known by the end of the reference face it's
+		// nearer to rather than by the vertex or clip plane that made it: boxes of the same width swap between the
+		// two every few steps and would lose their warm start each time.
+		if (tx * side2[0].x + ty * side2[0].y > tx * side2[1].x + ty * side2[1].y) {
+			swap(side2[0], side2[1]);
+		}
+		float front = nx * v1x + ny * v1y;
+		c.count = 0;
+		for (uint32_t slot = 0; slot < 2; ++slot) {
+			const auto& v = side2[slot];
+			float s = nx * v.x + ny * v.y - front;
+			if (s <= 0.0f) {
+				auto& p = c.points[c.count++];
+				p.depth = -s;
+				p.x = v.x - nx * 0.5f * s;
+				p.y = v.y - ny * 0.5f * s;
+				p.feature = (flip ? 0x10000u : 0u) | (static_cast<uint32_t>(edge) << 8) | slot;
+			}
+		}
+		if (c.count == 0) {
+			return false;
+		}
+		c.a = a;
+		c.b = b;
+		c.nx = flip ? -nx : nx;
+		c.ny = flip ? -ny : ny;
+		return true;
+	}
+
+	void physics_world::build_islands()
+	{
+		// moving bodies touching are in the same island, static ones don't join islands
+		_parent.resize(_x.size());
+		for (auto id : _order) {
+			_parent[id] = id;
+		}
+		for (const auto& c : _contacts) {
+			if (_inv_mass[c.a] > 0.0f && _inv_mass[c.b] > 0.0f) {
+				uint32_t ra = find_root(_parent, c.a);
+				uint32_t rb = find_root(_parent, c.b);
+				_parent[max(ra, rb)] = min(ra, rb);
+			}
+		}
+
+		// number the islands by their roots, then group the contacts by island with a counting sort
+		_island_of.assign(_x.size(), UINT32_MAX);
+		_island_start.clear();
+		auto island = [this](const contact& c) {
+			body_id moving = _inv_mass[c.a] > 0.0f ? c.a : c.b;
+			uint32_t root = find_root(_parent, moving);
+			if (_island_of[root] == UINT32_MAX) {
+				_island_of[root] = static_cast<uint32_t>(_island_start.size());
+				_island_start.push_back(0);
+			}
+			return _island_of[root];
+		};
+		for (const auto& c : _contacts) {
+			++_island_start[island(c)];
+		}
+		uint32_t total = 0;
+		for (auto& start : _island_start) {
+			uint32_t count = start;
+			start = total;
+			total += count;
+		}
+		_island_start.push_back(total);
+		_island_contacts.resize(_contacts.size());
+		for (uint32_t i = 0; i < _contacts.size(); ++i) {
+			_island_contacts[_island_start[island(_contacts[i])]++] = i;
+		}
+		// the fill moved each start to the next island's
+		for (size_t i = _island_start.size() - 1; i > 0; --i) {
+			_island_start[i] = _island_start[i - 1];
+		}
+		_island_start[0] = 0;
+	}
+
+	void physics_world::solve_islands(int begin, int end)
+	{
+		float inv_dt = 1.0f / _timestep;
+		const uint32_t* first = _island_contacts.data() + _island_start[begin];
+		const uint32_t* last = _island_contacts.data() + _island_start[end];
+
+		// a static body's velocity is never written, islands share nothing else
+		auto apply = [this](const contact& c, const contact_point& p, float px, float py) {
+			body_id a = c.a;
+			body_id b = c.b;
+			if (_inv_mass[a] > 0.0f) {
+				_vx[a] -= px * _inv_mass[a];
+				_vy[a] -= py * _inv_mass[a];
+				_w[a] -= cross(p.rax, p.ray, px, py) * _inv_inertia[a];
+			}
+			if (_inv_mass[b] > 0.0f) {
+				_vx[b] += px * _inv_mass[b];
+				_vy[b] += py * _inv_mass[b];
+				_w[b] += cross(p.rbx, p.rby, px, py) * _inv_inertia[b];
+			}
+		};
+		// velocity of b relative to a at the point
+		auto relative = [this](const contact& c, const contact_point& p, float& dvx, float& dvy) {
+			dvx = _vx[c.b] - _w[c.b] * p.rby - _vx[c.a] + _w[c.a] * p.ray;
+			dvy = _vy[c.b] + _w[c.b] * p.rbx - _vy[c.a] - _w[c.a] * p.rax;
+		};
+
+		for (auto it = first; it != last; ++it) {
+			auto& c = _contacts[*it];
+			float ima = _inv_mass[c.a];
+			float imb = _inv_mass[c.b];
+			float iia = _inv_inertia[c.a];
+			float iib = _inv_inertia[c.b];
+			float tx = -c.ny;
+			float ty = c.nx;
+			for (int i = 0; i < c.count; ++i) {
+				auto& p = c.points[i];
+				p.rax = p.x - _x[c.a];
+				p.ray = p.y - _y[c.a];
+				p.rbx = p.x - _x[c.b];
+				p.rby = p.y - _y[c.b];
+				float rna = cross(p.rax, p.ray, c.nx, c.ny);
+				float rnb = cross(p.rbx, p.rby, c.nx, c.ny);
+				p.normal_mass = 1.0f / (ima + imb + iia * rna * rna + iib * rnb * rnb);
+				float rta = cross(p.rax, p.ray, tx, ty);
+				float rtb = cross(p.rbx, p.rby, tx, ty);
+				p.tangent_mass = 1.0f / (ima + imb + iia * rta * rta + iib * rtb * rtb);
+				p.bias = g_baumgarte * inv_dt * clamp(p.depth - g_slop, 0.0f, g_max_correction);
+				float dvx;
+				float dvy;
+				relative(c, p, dvx, dvy);
+				float vn = dvx * c.nx + dvy * c.ny;
+				// bouncing every step a rocking body's corner comes down would keep it rocking for ever
+				if (!p.resting && vn < -g_bounce_speed) {
+					p.bias = max(p.bias, -c.restitution * vn);
+				}
+				apply(c, p, c.nx * p.normal_impulse + tx * p.tangent_impulse, c.ny * p.normal_impulse + ty * p.tangent_impulse);
+			}
+		}
+
+		for (int iteration = 0; iteration < _iterations; ++iteration) {
+			for (auto it = first; it != last; ++it) {
+				auto& c = _contacts[*it];
+				float tx = -c.ny;
+				float ty = c.nx;
+				for (int i = 0; i < c.count; ++i) {
+					auto& p = c.points[i];
+					float dvx;
+					float dvy;
+
+					// friction, at most friction times the push apart
+					relative(c, p, dvx, dvy);
+					float limit = c.friction * p.normal_impulse;
+					float tangent = clamp(p.tangent_impulse - (dvx * tx + dvy * ty) * p.tangent_mass, -limit, limit);
+					float dt = tangent - p.tangent_impulse;
+					p.tangent_impulse = tangent;
+					apply(c, p, tx * dt, ty * dt);
+
+					// push apart, never pull together
+					relative(c, p, dvx, dvy);
+					float normal = max(p.normal_impulse + (p.bias - (dvx * c.nx + dvy * c.ny)) * p.normal_mass, 0.0f);
+					float dn = normal - p.normal_impulse;
+					p.normal_impulse = normal;
+					apply(c, p, c.nx * dn, c.ny * dn);
+				}
+			}
+		}
+	}
+
+	void physics_world::integrate_positions()
+	{
+		float dt = _timestep;
+		for (auto id : _order) {
+			if (_inv_mass[id] > 0.0f) {
+				float move_sq = (_vx[id] * _vx[id] + _vy[id] * _vy[id]) * dt * dt;
+				if (move_sq > g_max_translation * g_max_translation) {
+					float scale = g_max_translation / sqrtf(move_sq);
+					_vx[id] *= scale;
+					_vy[id] *= scale;
+				}
+				_x[id] += _vx[id] * dt;
+				_y[id] += _vy[id] * dt;
+				_angle[id] += _w[id] * dt;
+			}
+		}
+	}
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace olc
+{
+	class job_system;
+
+	struct shape_type
+	{
+		enum enum_t : uint8_t
+		{
+			circle, polygon,
+		};
+	};
+
+	//
+	// 2D rigid body physics for circles and convex polygons, units about a console cell.
+	//
+	// Bodies are kept as structure of arrays indexed by body id. Each fixed step:
+	// - broadphase: sweep and prune along x over the bounding boxes. The sweep order carries over from the last
+	//   step and is fixed up by insertion sort, nearly free since bodies barely move in a step.
+	// - narrowphase: separating axis test, clipping the incident edge for up to 2 contact points per pair.
+	// - solver: sequential impulses with friction and restitution, warm started from the impulses the same contact
+	//   points took last step, which is what lets stacks settle.
+	// - semi-implicit Euler integration.
+	//
+	// Bodies resting on each other form islands that share no moving body. With a job_system set the islands are
+	// solved in parallel, each on one thread in the same order as alone, so the result is the same either way.
+	// One big pile is one island though, that only ever gets one thread.
+	//
+	class physics_world
+	{
+	public:
+		using body_id = uint32_t;
+		// polygon vertices, as draw_wire_polygon takes them
+		using model = std::vector<std::pair<float, float>>;
+
+		static constexpr int max_vertices = 8;
+
+	public:
+		explicit physics_world(float timestep = 1.0f / 60.0f);
+
+		// density 0 makes a static body, which never moves
+		body_id add_circle(float x, float y, float radius, float density = 1.0f);
+		// Convex, 3 to max_vertices distinct points in either winding and no three in a line, throws olc_exception
+		// otherwise. The body's position is the polygon's centroid and the shape is shifted to put it at the origin:
+		// draw it with shape(id).
+		body_id add_polygon(const model& shape, float x, float y, float angle = 0.0f, float density = 1.0f);
+		// The id is reused by a later add
+		void remove(body_id id);
+
+		bool contains(body_id id) const { return id < _alive.size() && _alive[id]; }
+		size_t size() const { return _order.size(); }
+
+		void set_gravity(float gx, float gy) { _gx = gx; _gy = gy; }
+		// Solver passes per step, more make stacks stiffer
+		void set_iterations(int iterations) { _iterations = iterations; }
+		// Solves islands on jobs, nullptr solves them all on the calling thread
+		void set_job_system(job_system* jobs) { _jobs = jobs; }
+
+		float x(body_id id) const { return _x[id]; }
+		float y(body_id id) const { return _y[id]; }
+		float angle(body_id id) const { return _angle[id]; }
+		float vx(body_id id) const { return _vx[id]; }
+		float vy(body_id id) const { return _vy[id]; }
+		float angular_velocity(body_id id) const { return _w[id]; }
+		bool is_static(body_id id) const { return _inv_mass[id] == 0.0f; }
+
+		void set_position(body_id id, float x, float y, float angle);
+		void set_velocity(body_id id, float vx, float vy) { _vx[id] = vx; _vy[id] = vy; }
+		void set_angular_velocity(body_id id, float w) { _w[id] = w; }
+		// An instant push through the center of mass
+		void apply_impulse(body_id id, float ix, float iy);
+		// friction 0 slides forever, restitution 1 bounces back as fast as it came
+		void set_material(body_id id, float friction, float restitution);
+
+		shape_type::enum_t type(body_id id) const { return static_cast<shape_type::enum_t>(_type[id]); }
+		// The circle's radius, or the distance to a polygon's furthest vertex
+		float radius(body_id id) const { return _radius[id]; }
+		// A polygon's vertices around its centroid, empty for a circle
+		const model& shape(body_id id) const { return _shapes[id]; }
+
+		// Advances by elapsed in fixed steps, the remainder carries over to the next call. Returns the steps taken,
+		// at most 8: after a long hitch the world slows down rather than falls further behind.
+		int update(float elapsed);
+		void step();
+
+		size_t contact_count() const { return _contacts.size(); }
+		size_t island_count() const { return _island_start.empty() ? 0 : _island_start.size() - 1; }
+
+		// Calls f(a, b, nx, ny) for every pair touching after the last step, the normal pointing from a to b
+		template<typename F>
+		void for_each_contact(F&& f) const
+		{
+			for (const auto& c : _contacts) {
+				f(c.a, c.b, c.nx, c.ny);
+			}
+		}
+
+	private:
+		struct contact_point
+		{
+			float x;
+			float y;
+			float depth;
+			// which features of the two shapes made the point, to find it again next step
+			uint32_t feature;
+			float normal_impulse;
+			float tangent_impulse;
+			// touching last step too, only a fresh impact bounces
+			bool resting;
+			// solver state, from the bodies' centers to the point
+			float rax;
+			float ray;
+			float rbx;
+			float rby;
+			float normal_mass;
+			float tangent_mass;
+			float bias;
+		};
+
+		struct contact
+		{
+			// the pair, lower id first, the same however a and b are ordered
+			uint64_t key;
+			body_id a;
+			body_id b;
+			// from a to b
+			float nx;
+			float ny;
+			float friction;
+			float restitution;
+			int count;
+			contact_point points[2];
+		};
+
+		body_id add_body(shape_type::enum_t type, float x, float y, float angle);
+		void update_bounds();
+		void find_contacts();
+		bool collide(body_id a, body_id b, contact& c) const;
+		bool collide_circles(body_id a, body_id b, contact& c) const;
+		bool collide_polygon_circle(body_id a, body_id b, contact& c) const;
+		bool collide_polygons(body_id a, body_id b, contact& c) const;
+		// The edge of a whose outward normal has b furthest in front of it, and that distance
+		float max_separation(body_id a, body_id b, int& edge) const;
+		void build_islands();
+		// Prepares, warm starts and iterates the contacts of islands [begin, end)
+		void solve_islands(int begin, int end);
+		void integrate_positions();
+
+	private:
+		float _timestep;
+		float _accumulator{ 0.0f };
+		float _gx{ 0.0f };
+		float _gy{ 0.0f };
+		int _iterations{ 8 };
+		job_system* _jobs{ nullptr };
+
+		// bodies
+		std::vector<float> _x;
+		std::vector<float> _y;
+		std::vector<float> _angle;
+		std::vector<float> _vx;
+		std::vector<float> _vy;
+		std::vector<float> _w;
+		std::vector<float> _inv_mass;
+		std::vector<float> _inv_inertia;
+		std::vector<float> _friction;
+		std::vector<float> _restitution;
+		std::vector<float> _radius;
+		std::vector<float> _min_x;
+		std::vector<float> _min_y;
+		std::vector<float> _max_x;
+		std::vector<float> _max_y;
+		std::vector<uint8_t> _type;
+		std::vector<uint8_t> _alive;
+		std::vector<uint8_t> _vertex_count;
+		std::vector<model> _shapes;
+		std::vector<body_id> _free;
+
+		// polygon vertices and edge normals, max_vertices per body; local to the body and in the world this step
+		std::vector<float> _local_x;
+		std::vector<float> _local_y;
+		std::vector<float> _local_nx;
+		std::vector<float> _local_ny;
+		std::vector<float> _world_x;
+		std::vector<float> _world_y;
+		std::vector<float> _world_nx;
+		std::vector<float> _world_ny;
+
+		// live bodies by their bounding box's min_x as of the last step
+		std::vector<body_id> _order;
+		std::vector<uint64_t> _pairs;
+		// sorted by key, last step's kept to warm start this one's
+		std::vector<contact> _contacts;
+		std::vector<contact> _previous;
+
+		// union find parents, then contact indices grouped by island with where each island starts
+		std::vector<uint32_t> _parent;
+		std::vector<uint32_t> _island_of;
+		std::vector<uint32_t> _island_contacts;
+		std::vector<uint32_t> _island_start;
+	};
+}
@@ -0,0 +1,160 @@
+#include "script.h"
+#include "cmd_engine.h"
+#include <algorithm>
+#include <array>
+#include <new>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		// coroutine frames are rounded up to 64 bytes, frames up to 4 KB are kept for reuse
+		constexpr size_t g_frame_granularity = 64;
+		constexpr size_t g_frame_classes = 64;
+
+		struct free_frame
+		{
+			free_frame* next;
+		};
+
+		//
+		// Free lists of coroutine frames by size class. Never shrinks while the thread runs, a game keeps spawning
+		// the same few scripts.
+		//
+		struct frame_pool
+		{
+			array<free_frame*, g_frame_classes> heads{};
+
+			~frame_pool()
+			{
+				for (auto head : heads) {
+					while (head) {
+						auto next = head->next;
+						::operator delete(head);
+						head = next;
+					}
+				}
+			}
+		};
+
+		thread_local frame_pool t_frame_pool;
+
+		size_t frame_class(size_t size)
+		{
+			return (max<size_t>(size, 1) + g_frame_granularity - 1) / g_frame_granularity;
+		}
+	}
+
+	//
+	// script class
+	//
+	void* script::promise_type::operator new(size_t size)
+	{
+		size_t c = frame_class(size);
+		if (c > g_frame_classes) {
+			return ::operator new(size);
+		}
+		auto& head = t_frame_pool.heads[c - 1];
+		if (head) {
+			auto p = head;
+			head = p->next;
+			return p;
+		}
+		return ::operator new(c * g_frame_granularity);
+	}
+
+	void script::promise_type::operator delete(void* p, size_t size)
+	{
+		size_t c = frame_class(size);
+		if (c > g_frame_classes) {
+			::operator delete(p);
+			return;
+		}
+		auto& head = t_frame_pool.heads[c - 1];
+		auto f = static_cast<free_frame*>(p);
+		f->next = head;
+		head = f;
+	}
+
+	//
+	// script_scheduler class
+	//
+	void script_scheduler::wait::await_suspend(coroutine_handle<script::promise_type> h) const
+	{
+		auto owner = h.promise().owner;
+		entry& e = *owner->_current;
+		e.resume = h;
+		e.kind = kind;
+		e.until = owner->_time + seconds;
+		e.key = key;
+	}
+
+	void script_scheduler::spawn(script s)
+	{
+		if (!s._handle || s._handle.done()) {
+			return;
+		}
+		auto h = exchange(s._handle, nullptr);
+		h.promise().owner = this;
+		_spawned.push_back({ h, h });
+	}
+
+	bool script_scheduler::ready(const entry& e, const cmd_engine& engine) const
+	{
+		switch (e.kind) {
+		case wait_kind::seconds:
+			return _time >= e.until;
+		case wait_kind::key:
+			return engine.get_key(e.key).pressed;
+		default:
+			return true;
+		}
+	}
+
+	void script_scheduler::tick(const cmd_engine& engine, float elapsed)
+	{
+		_time += elapsed;
+
+		// scripts spawned since the last tick start now, ones spawned during this tick wait for the next
+		if (!_spawned.empty()) {
+			_scripts.insert(_scripts.end(), _spawned.begin(), _spawned.end());
+			_spawned.clear();
+		}
+
+		exception_ptr error;
+		for (auto& e : _scripts) {
+			if (!ready(e, engine)) {
+				continue;
+			}
+			_current = &e;
+			e.resume.resume();
+			_current = nullptr;
+			if (e.root.done()) {
+				if (!error) {
+					error = e.root.promise().exception;
+				}
+				e.root.destroy();
+				e.root = nullptr;
+			}
+		}
+
+		_scripts.erase(remove_if(_scripts.begin(), _scripts.end(), [](const entry& e) { return !e.root; }), _scripts.end());
+		if (error) {
+			rethrow_exception(error);
+		}
+	}
+
+	void script_scheduler::clear()
+	{
+		for (auto& e : _scripts) {
+			e.root.destroy();
+		}
+		for (auto& e : _spawned) {
+			e.root.destroy();
+		}
+		_scripts.clear();
+		_spawned.clear();
+	}
+}
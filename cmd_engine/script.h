@@ -0,0 +1,184 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+#include <vector>
+
+namespace olc
+{
+	class cmd_engine;
+	class script_scheduler;
+
+	//
+	// A coroutine that runs across frames, for sequences that would otherwise be state machines:
+	//
+	//     script flash_lines(...)
+	//     {
+	//         for (int i = 0; i < 3; ++i) {
+	//             draw the lines
+	//             co_await wait_seconds(0.1f);
+	//         }
+	//     }
+	//
+	// Hand it to cmd_engine::scripts().spawn() to run it from the next frame on, or co_await it from another script
+	// to run it to completion as a step of that one. A script that is never spawned or awaited never runs.
+	//
+	// Coroutine frames come from a per thread pool of size classes, so starting scripts every frame costs no heap
+	// allocation once the pool has warmed up. Scripts belong to the game thread.
+	//
+	class script
+	{
+	public:
+		struct promise_type
+		{
+			script get_return_object() { return script{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+
+			// a nested script hands control straight back to the one awaiting it
+			struct final_awaiter
+			{
+				bool await_ready() noexcept { return false; }
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+				{
+					auto continuation = h.promise().continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+				void await_resume() noexcept {}
+			};
+			final_awaiter final_suspend() noexcept { return {}; }
+
+			void return_void() {}
+			void unhandled_exception() { exception = std::current_exception(); }
+
+			static void* operator new(size_t size);
+			static void operator delete(void* p, size_t size);
+
+			script_scheduler* owner{ nullptr };
+			std::coroutine_handle<> continuation;
+			std::exception_ptr exception;
+		};
+
+	public:
+		script() = default;
+		script(script&& other) noexcept : _handle{ std::exchange(other._handle, nullptr) } {}
+		script& operator=(script&& other) noexcept
+		{
+			if (this != &other) {
+				reset();
+				_handle = std::exchange(other._handle, nullptr);
+			}
+			return *this;
+		}
+		~script() { reset(); }
+
+		script(const script&) = delete;
+		script& operator=(const script&) = delete;
+
+		bool valid() const { return static_cast<bool>(_handle); }
+
+		// co_await on a script runs it inside the awaiting one, exceptions thrown in it come out of the co_await
+		bool await_ready() const noexcept { return !_handle || _handle.done(); }
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> awaiting) noexcept
+		{
+			_handle.promise().owner = awaiting.promise().owner;
+			_handle.promise().continuation = awaiting;
+			return _handle;
+		}
+		void await_resume()
+		{
+			if (_handle && _handle.promise().exception) {
+				std::rethrow_exception(_handle.promise().exception);
+			}
+		}
+
+	private:
+		friend class script_scheduler;
+
+		explicit script(std::coroutine_handle<promise_type> h) : _handle{ h } {}
+
+		void reset()
+		{
+			if (_handle) {
+				_handle.destroy();
+				_handle = nullptr;
+			}
+		}
+
+		std::coroutine_handle<promise_type> _handle;
+	};
+
+	//
+	// Runs the spawned scripts once per frame, before on_user_update. Each script runs until its next co_await of
+	// one of the waits below, on the game thread, so it can touch game state freely.
+	//
+	class script_scheduler
+	{
+	public:
+		enum class wait_kind
+		{
+			frame,
+			seconds,
+			key,
+		};
+
+		// What a suspended script waits for
+		struct wait
+		{
+			wait_kind kind;
+			float seconds;
+			int key;
+
+			bool await_ready() const noexcept { return kind == wait_kind::seconds && seconds <= 0.0f; }
+			void await_suspend(std::coroutine_handle<script::promise_type> h) const;
+			void await_resume() const noexcept {}
+		};
+
+	public:
+		script_scheduler() = default;
+		~script_scheduler() { clear(); }
+
+		script_scheduler(const script_scheduler&) = delete;
+		script_scheduler& operator=(const script_scheduler&) = delete;
+
+		// Starts s on the next tick
+		void spawn(script s);
+		// Resumes every script whose wait is over. An exception escaping a script ends it and is rethrown here.
+		void tick(const cmd_engine& engine, float elapsed);
+		// Destroys every script where it stands
+		void clear();
+
+		size_t size() const { return _scripts.size() + _spawned.size(); }
+		// seconds of ticks so far
+		float time() const { return _time; }
+
+	private:
+		struct entry
+		{
+			// the spawned script, owning every script nested in it
+			std::coroutine_handle<script::promise_type> root;
+			// innermost script, where the wait was reached
+			std::coroutine_handle<> resume;
+			wait_kind kind{ wait_kind::frame };
+			float until{ 0.0f };
+			int key{ 0 };
+		};
+
+		bool ready(const entry& e, const cmd_engine& engine) const;
+
+	private:
+		std::vector<entry> _scripts;
+		std::vector<entry> _spawned;
+		// the entry being resumed, its waits are recorded here
+		entry* _current{ nullptr };
+		float _time{ 0.0f };
+	};
+
+	// Resume on the next frame
+	inline script_scheduler::wait next_frame() { return { script_scheduler::wait_kind::frame, 0.0f, 0 }; }
+	// Resume on the first frame at least t seconds from now
+	inline script_scheduler::wait wait_seconds(float t) { return { script_scheduler::wait_kind::seconds, t, 0 }; }
+	// Resume on the frame key_id is pressed
+	inline script_scheduler::wait wait_key(int key_id) { return { script_scheduler::wait_kind::key, 0.0f, key_id }; }
+}
@@ -0,0 +1,274 @@
+#include "snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		//
+		// LZ77 in the style of LZ4: sequences of a token byte (literal count << 4 | match length - 4), extra length
+		// bytes when a nibble is 15, the literals, a 2 byte offset back into the output and extra match length bytes.
+		// The last sequence has literals only. Matches are found through a hash of the next 4 bytes, so it runs at
+		// memory speed on the mostly repeating screens and game state it's fed.
+		//
+		constexpr uint32_t g_compressed_magic = 0x5a4e4c4f;	// "OLNZ"
+		constexpr int g_hash_bits = 14;
+		constexpr size_t g_min_match = 4;
+		constexpr size_t g_max_offset = 0xffff;
+
+		uint32_t load32(const byte* p)
+		{
+			uint32_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		void put_length(vector<byte>& out, size_t n)
+		{
+			for (; n >= 255; n -= 255) {
+				out.push_back(byte{ 255 });
+			}
+			out.push_back(static_cast<byte>(n));
+		}
+
+		void put_sequence(vector<byte>& out, const byte* literals, size_t nliterals, size_t offset, size_t match)
+		{
+			size_t match_code = match ? match - g_min_match : 0;
+			out.push_back(static_cast<byte>((min<size_t>(nliterals, 15) << 4) | min<size_t>(match_code, 15)));
+			if (nliterals >= 15) {
+				put_length(out, nliterals - 15);
+			}
+			out.insert(out.end(), literals, literals + nliterals);
+			if (match) {
+				out.push_back(static_cast<byte>(offset & 0xff));
+				out.push_back(static_cast<byte>(offset >> 8));
+				if (match_code >= 15) {
+					put_length(out, match_code - 15);
+				}
+			}
+		}
+
+		vector<byte> lz_compress(const vector<byte>& src)
+		{
+			const byte* p = src.data();
+			size_t n = src.size();
+			vector<byte> out;
+			out.reserve(16 + n + n / 255);
+
+			uint64_t raw_size = n;
+			out.resize(sizeof(g_compressed_magic) + sizeof(raw_size));
+			memcpy(out.data(), &g_compressed_magic, sizeof(g_compressed_magic));
+			memcpy(out.data() + sizeof(g_compressed_magic), &raw_size, sizeof(raw_size));
+			// an empty source is just the header, src.data() may be null
+			if (n == 0) {
+				return out;
+			}
+
+			vector<uint32_t> table(size_t{ 1 } << g_hash_bits, 0);
+			size_t anchor = 0;
+			size_t i = 0;
+			while (i + g_min_match <= n) {
+				uint32_t v = load32(p + i);
+				uint32_t h = (v * 2654435761u) >> (32 - g_hash_bits);
+				size_t candidate = table[h];
+				table[h] = static_cast<uint32_t>(i);
+				if (candidate < i && i - candidate <= g_max_offset && load32(p + candidate) == v) {
+					size_t len = g_min_match;
+					while (i + len < n && p[candidate + len] == p[i + len]) {
+						++len;
+					}
+					put_sequence(out, p + anchor, i - anchor, i - candidate, len);
+					i += len;
+					anchor = i;
+				}
+				else {
+					// step faster through data that doesn't compress
+					i += 1 + ((i - anchor) >> 6);
+				}
+			}
+			put_sequence(out, p + anchor, n - anchor, 0, 0);
+			return out;
+		}
+
+		bool get_length(const byte*& p, const byte* end, size_t& n)
+		{
+			for (;;) {
+				if (p == end) {
+					return false;
+				}
+				auto b = static_cast<size_t>(*p++);
+				n += b;
+				if (b != 255) {
+					return true;
+				}
+			}
+		}
+
+		bool lz_decompress(const byte* p, size_t size, vector<byte>& out)
+		{
+			uint32_t magic;
+			uint64_t raw_size;
+			if (size < sizeof(magic) + sizeof(raw_size)) {
+				return false;
+			}
+			memcpy(&magic, p, sizeof(magic));
+			memcpy(&raw_size, p + sizeof(magic), sizeof(raw_size));
+			// no blob is bigger than a few screens and the game state
+			if (magic != g_compressed_magic || raw_size > (uint64_t{ 1 } << 32)) {
+				return false;
+			}
+			const byte* end = p + size;
+			p += sizeof(magic) + sizeof(raw_size);
+
+			out.resize(static_cast<size_t>(raw_size));
+			byte* dst = out.data();
+			byte* dst_end = dst + out.size();
+			while (p < end) {
+				auto token = static_cast<size_t>(*p++);
+				size_t nliterals = token >> 4;
+				if (nliterals == 15 && !get_length(p, end, nliterals)) {
+					return false;
+				}
+				if (nliterals > static_cast<size_t>(end - p) || nliterals > static_cast<size_t>(dst_end - dst)) {
+					return false;
+				}
+				// out is empty for an empty source and its data() may be null
+				if (nliterals > 0) {
+					memcpy(dst, p, nliterals);
+				}
+				dst += nliterals;
+				p += nliterals;
+				if (p == end) {
+					break;
+				}
+
+				if (end - p < 2) {
+					return false;
+				}
+				size_t offset = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8);
+				p += 2;
+				size_t match = token & 0xf;
+				if (match == 15 && !get_length(p, end, match)) {
+					return false;
+				}
+				match += g_min_match;
+				if (offset == 0 || offset > static_cast<size_t>(dst - out.data()) || match > static_cast<size_t>(dst_end - dst)) {
+					return false;
+				}
+				// byte by byte, the match may overlap what it produces
+				const byte* from = dst - offset;
+				for (size_t k = 0; k < match; ++k) {
+					dst[k] = from[k];
+				}
+				dst += match;
+			}
+			return dst == dst_end;
+		}
+	}
+
+	//
+	// snapshot class
+	//
+	uint64_t snapshot::frame() const
+	{
+		if (_data.size() < sizeof(header)) {
+			return 0;
+		}
+		header h;
+		memcpy(&h, _data.data(), sizeof(h));
+		return h.frame;
+	}
+
+	uint32_t snapshot::parts() const
+	{
+		if (_data.size() < sizeof(header)) {
+			return 0;
+		}
+		header h;
+		memcpy(&h, _data.data(), sizeof(h));
+		return h.parts;
+	}
+
+	void snapshot::compress_async()
+	{
+		if (_compressed_revision == _revision && !_compressed.empty()) {
+			return;
+		}
+		_compressing_revision = _revision;
+		_compressing = async(launch::async, [data = _data]() {
+			return lz_compress(data);
+		});
+	}
+
+	const vector<byte>& snapshot::compressed()
+	{
+		if (_compressing.valid()) {
+			auto result = _compressing.get();
+			if (_compressing_revision == _revision) {
+				_compressed = move(result);
+				_compressed_revision = _revision;
+			}
+		}
+		if (_compressed_revision != _revision || _compressed.empty()) {
+			_compressed = lz_compress(_data);
+			_compressed_revision = _revision;
+		}
+		return _compressed;
+	}
+
+	bool snapshot::decompress(const byte* data, size_t size)
+	{
+		++_revision;
+		_compressed.clear();
+		if (!lz_decompress(data, size, _data) || _data.size() < sizeof(header)) {
+			_data.clear();
+			return false;
+		}
+		header h;
+		memcpy(&h, _data.data(), sizeof(h));
+		if (h.magic != g_magic || h.version != g_version) {
+			_data.clear();
+			return false;
+		}
+		return true;
+	}
+
+	bool snapshot::save(const wstring& file)
+	{
+		if (empty()) {
+			return false;
+		}
+		const auto& blob = compressed();
+
+		FILE* f{ nullptr };
+		_wfopen_s(&f, file.c_str(), L"wb");
+		if (!f) {
+			return false;
+		}
+		bool ok = fwrite(blob.data(), 1, blob.size(), f) == blob.size();
+		fclose(f);
+		return ok;
+	}
+
+	bool snapshot::load(const wstring& file)
+	{
+		FILE* f{ nullptr };
+		_wfopen_s(&f, file.c_str(), L"rb");
+		if (!f) {
+			return false;
+		}
+
+		vector<byte> blob;
+		byte buf[4096];
+		size_t n;
+		while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+			blob.insert(blob.end(), buf, buf + n);
+		}
+		fclose(f);
+		return decompress(blob.data(), blob.size());
+	}
+}
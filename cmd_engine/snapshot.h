@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace olc
+{
+	// What cmd_engine::save_snapshot captures, or'ed together
+	struct snapshot_part
+	{
+		enum enum_t : uint32_t
+		{
+			// the screen cells
+			screen = 0x1,
+			// key and mouse state, the frame count
+			input = 0x2,
+			// the state regions the game registered
+			state = 0x4,
+			all = screen | input | state,
+		};
+	};
+
+	//
+	// An engine at the end of a frame as one contiguous blob, taken by cmd_engine::save_snapshot and put back by
+	// cmd_engine::restore_snapshot. Both are a few memcpys, so a game can snapshot every frame for rewind or
+	// rollback. Saving into the same snapshot again reuses its memory.
+	//
+	// For keeping or storing, the blob compresses well; compress_async does it on a background thread while the
+	// game goes on.
+	//
+	class snapshot
+	{
+	public:
+		snapshot() = default;
+
+		bool empty() const { return _data.empty(); }
+		const std::vector<std::byte>& data() const { return _data; }
+		// frame count of the engine when taken, 0 if empty
+		uint64_t frame() const;
+		// snapshot_part flags it holds
+		uint32_t parts() const;
+
+		// Compresses a copy of the blob on a background thread, the snapshot can be restored or saved into meanwhile.
+		// Waits for a compression still running from an earlier call.
+		void compress_async();
+		// The compressed blob, waits for compress_async or compresses now if it wasn't started
+		const std::vector<std::byte>& compressed();
+		// Replaces the blob with the one compressed in data. Returns false, leaving the snapshot empty, if it's corrupt.
+		bool decompress(const std::byte* data, size_t size);
+
+		// Compressed files, to seed a game or a benchmark from a saved position
+		bool save(const std::wstring& file);
+		bool load(const std::wstring& file);
+
+	private:
+		friend class cmd_engine;
+
+		struct header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t parts;
+			int32_t width;
+			int32_t height;
+			uint32_t regions;
+			uint64_t frame;
+		};
+		static constexpr uint32_t g_magic = 0x534e4c4f;	// "OLNS"
+		static constexpr uint32_t g_version = 1;
+
+	private:
+		std::vector<std::byte> _data;
+		// bumped whenever _data changes, a compression of an older revision is thrown away
+		uint64_t _revision{ 0 };
+		std::vector<std::byte> _compressed;
+		uint64_t _compressed_revision{ 0 };
+		std::future<std::vector<std::byte>> _compressing;
+		uint64_t _compressing_revision{ 0 };
+	};
+}
@@ -0,0 +1,165 @@
+#include "spatial_hash.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+using namespace std;
+
+namespace olc
+{
+	spatial_hash::spatial_hash(float cell_size, size_t expected_entities)
+		: _cell_size{ cell_size }
+		, _inv_cell_size{ 1.0f / cell_size }
+	{
+		assert(cell_size > 0.0f);
+		_nodes.reserve(expected_entities);
+		// a few entities per cell is the usual case, the table grows if they're spread thinner
+		size_t ncells = bit_ceil(max<size_t>(expected_entities / 2, 16));
+		_cells.assign(ncells, { 0, 0, npos, false });
+		_cell_mask = static_cast<uint32_t>(ncells - 1);
+	}
+
+	void spatial_hash::clear()
+	{
+		if (_used_cells > 0) {
+			fill(_cells.begin(), _cells.end(), cell{ 0, 0, npos, false });
+		}
+		for (auto& n : _nodes) {
+			n.slot = npos;
+		}
+		_used_cells = 0;
+		_size = 0;
+	}
+
+	void spatial_hash::insert(uint32_t id, float x, float y)
+	{
+		if (id >= _nodes.size()) {
+			_nodes.resize(static_cast<size_t>(id) + 1, { 0.0f, 0.0f, npos, npos });
+		}
+		if (_nodes[id].slot != npos) {
+			move(id, x, y);
+			return;
+		}
+		_nodes[id].x = x;
+		_nodes[id].y = y;
+		link(id, find_or_add_cell(to_cell(x), to_cell(y)));
+		++_size;
+	}
+
+	void spatial_hash::remove(uint32_t id)
+	{
+		if (!contains(id)) {
+			return;
+		}
+		unlink(id);
+		--_size;
+	}
+
+	void spatial_hash::move(uint32_t id, float x, float y)
+	{
+		if (!contains(id)) {
+			insert(id, x, y);
+			return;
+		}
+		auto& n = _nodes[id];
+		n.x = x;
+		n.y = y;
+		int cx = to_cell(x);
+		int cy = to_cell(y);
+		const auto& c = _cells[n.slot];
+		if (c.cx == cx && c.cy == cy) {
+			return;
+		}
+		unlink(id);
+		link(id, find_or_add_cell(cx, cy));
+	}
+
+	uint32_t spatial_hash::find_cell(int cx, int cy) const
+	{
+		for (uint32_t i = hash(cx, cy) & _cell_mask;; i = (i + 1) & _cell_mask) {
+			const auto& c = _cells[i];
+			if (!c.used) {
+				return npos;
+			}
+			if (c.cx == cx && c.cy == cy) {
+				return i;
+			}
+		}
+	}
+
+	uint32_t spatial_hash::find_or_add_cell(int cx, int cy)
+	{
+		for (;;) {
+			uint32_t i = hash(cx, cy) & _cell_mask;
+			for (;; i = (i + 1) & _cell_mask) {
+				auto& c = _cells[i];
+				if (!c.used) {
+					break;
+				}
+				if (c.cx == cx && c.cy == cy) {
+					return i;
+				}
+			}
+			if ((_used_cells + 1) * 2 <= _cells.size()) {
+				_cells[i] = { cx, cy, npos, true };
+				++_used_cells;
+				return i;
+			}
+			grow_cells();
+		}
+	}
+
+	void spatial_hash::grow_cells()
+	{
+		// cells that emptied are dropped here, only grow if the live ones really need it
+		size_t live = 0;
+		for (const auto& c : _cells) {
+			live += (c.used && c.head != npos);
+		}
+		size_t ncells = _cells.size();
+		if ((live + 1) * 4 > ncells) {
+			ncells *= 2;
+		}
+
+		// rehash through the spare table, purging at the same size reuses its memory
+		_spare_cells.assign(ncells, cell{ 0, 0, npos, false });
+		_spare_cells.swap(_cells);
+		_cell_mask = static_cast<uint32_t>(ncells - 1);
+		_used_cells = 0;
+		for (const auto& c : _spare_cells) {
+			if (!c.used || c.head == npos) {
+				continue;
+			}
+			uint32_t i = hash(c.cx, c.cy) & _cell_mask;
+			while (_cells[i].used) {
+				i = (i + 1) & _cell_mask;
+			}
+			_cells[i] = c;
+			++_used_cells;
+			for (uint32_t id = c.head; id != npos; id = _nodes[id].next) {
+				_nodes[id].slot = i;
+			}
+		}
+	}
+
+	void spatial_hash::link(uint32_t id, uint32_t slot)
+	{
+		auto& c = _cells[slot];
+		auto& n = _nodes[id];
+		n.slot = slot;
+		n.next = c.head;
+		c.head = id;
+	}
+
+	void spatial_hash::unlink(uint32_t id)
+	{
+		// cells hold a handful of entities, finding the predecessor is cheaper than keeping back links up to date
+		auto& n = _nodes[id];
+		uint32_t* link = &_cells[n.slot].head;
+		while (*link != id) {
+			link = &_nodes[*link].next;
+		}
+		*link = n.next;
+		n.slot = npos;
+	}
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace olc
+{
+	//
+	// Uniform grid for finding entities near a point or inside a rectangle, without testing every pair.
+	//
+	// Entities are points identified by the caller's own index (e.g. into its entity array), bucketed into square
+	// cells of cell_size. Only occupied cells take memory: they live in a flat open addressed table keyed by the
+	// cell coordinates, and each cell links its entities through the entity nodes, so insert, remove and move cost
+	// about one table probe, and queries walk the cells in range. Entities with a size are found by growing the
+	// query by the largest radius; pick cell_size around the typical query size.
+	//
+	// Either keep it up to date with move(), or clear() and insert everything again each frame, which is O(n).
+	// Neither allocates once the tables have grown to the entity count, and queries never allocate.
+	// Not thread safe, but concurrent queries are fine.
+	//
+	class spatial_hash
+	{
+	public:
+		static constexpr uint32_t npos = UINT32_MAX;
+
+	public:
+		explicit spatial_hash(float cell_size, size_t expected_entities = 1024);
+
+		// Removes every entity, keeps the memory
+		void clear();
+
+		void insert(uint32_t id, float x, float y);
+		void remove(uint32_t id);
+		// Cheap when the entity stays in its cell
+		void move(uint32_t id, float x, float y);
+
+		bool contains(uint32_t id) const { return id < _nodes.size() && _nodes[id].slot != npos; }
+		size_t size() const { return _size; }
+		float cell_size() const { return _cell_size; }
+
+		// Calls f(id) for every entity with x1 <= x <= x2 and y1 <= y <= y2, in no particular order.
+		// f must not modify the hash.
+		template<typename F>
+		void query_rect(float x1, float y1, float x2, float y2, F&& f) const
+		{
+			for_each_candidate(x1, y1, x2, y2, [&](const node& n, uint32_t id) {
+				if (n.x >= x1 && n.x <= x2 && n.y >= y1 && n.y <= y2) {
+					f(id);
+				}
+			});
+		}
+
+		// Calls f(id) for every entity within r of (x, y), in no particular order. f must not modify the hash.
+		template<typename F>
+		void query_radius(float x, float y, float r, F&& f) const
+		{
+			float r2 = r * r;
+			for_each_candidate(x - r, y - r, x + r, y + r, [&](const node& n, uint32_t id) {
+				float dx = n.x - x;
+				float dy = n.y - y;
+				if (dx * dx + dy * dy <= r2) {
+					f(id);
+				}
+			});
+		}
+
+	private:
+		struct node
+		{
+			float x;
+			float y;
+			// next entity in the cell
+			uint32_t next;
+			// table slot of the cell, npos when not in the hash
+			uint32_t slot;
+		};
+
+		struct cell
+		{
+			int32_t cx;
+			int32_t cy;
+			// first entity, npos for a cell that emptied since the last clear
+			uint32_t head;
+			bool used;
+		};
+
+		int to_cell(float v) const { return static_cast<int>(std::floor(v * _inv_cell_size)); }
+		static uint32_t hash(int cx, int cy)
+		{
+			uint64_t k = (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+			k *= 0x9e3779b97f4a7c15ull;
+			return static_cast<uint32_t>(k >> 32);
+		}
+
+		// slot of the cell, npos if never occupied since the last clear
+		uint32_t find_cell(int cx, int cy) const;
+		uint32_t find_or_add_cell(int cx, int cy);
+		void grow_cells();
+		void link(uint32_t id, uint32_t slot);
+		void unlink(uint32_t id);
+
+		// calls f(node, id) for every entity in the cells overlapping the rectangle
+		template<typename F>
+		void for_each_candidate(float x1, float y1, float x2, float y2, F&& f) const
+		{
+			if (_size == 0 || !(x1 <= x2) || !(y1 <= y2)) {
+				return;
+			}
+			int cx1 = to_cell(x1);
+			int cy1 = to_cell(y1);
+			int cx2 = to_cell(x2);
+			int cy2 = to_cell(y2);
+			auto visit = [&](uint32_t head) {
+				for (uint32_t id = head; id != npos; id = _nodes[id].next) {
+					f(_nodes[id], id);
+				}
+			};
+
+			// a query bigger than the populated area is cheaper as a scan of the occupied cells
+			double ncells = (static_cast<double>(cx2) - cx1 + 1) * (static_cast<double>(cy2) - cy1 + 1);
+			if (ncells > static_cast<double>(_used_cells)) {
+				for (const auto& c : _cells) {
+					if (c.used && c.head != npos && c.cx >= cx1 && c.cx <= cx2 && c.cy >= cy1 && c.cy <= cy2) {
+						visit(c.head);
+					}
+				}
+				return;
+			}
+			for (int cy = cy1; cy <= cy2; ++cy) {
+				for (int cx = cx1; cx <= cx2; ++cx) {
+					uint32_t slot = find_cell(cx, cy);
+					if (slot != npos) {
+						visit(_cells[slot].head);
+					}
+				}
+			}
+		}
+
+	private:
+		float _cell_size;
+		float _inv_cell_size;
+		std::vector<node> _nodes;
+		// power of 2 sized, linear probing, at most half full
+		std::vector<cell> _cells;
+		// the table before the last rehash, kept for the next one
+		std::vector<cell> _spare_cells;
+		uint32_t _cell_mask{ 0 };
+		// slots taken, including cells that emptied since the last clear
+		size_t _used_cells{ 0 };
+		size_t _size{ 0 };
+	};
+}
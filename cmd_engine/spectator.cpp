@@ -0,0 +1,398 @@
+// winsock2 must come before windows.h, which cmd_engine.h pulls in
+#include <winsock2.h>
+#include <afunix.h>
+#include "spectator.h"
+#include <cstring>
+#include <climits>
+
+#pragma comment(lib, "ws2_32.lib")
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		using namespace spectator_protocol;
+
+		// cells closer than this are merged into one run as a run header costs 2 cells
+		constexpr int g_run_merge_gap = 2;
+		constexpr size_t g_recv_chunk = 64 * 1024;
+		// changed runs kept for a viewer that doesn't clear them, past this they're one run over the whole screen
+		constexpr size_t g_max_changed_runs = 16 * 1024;
+
+		olc_exception socket_error(wstring_view what)
+		{
+			return olc_exception(L"ERROR: "s.append(what).append(L" failed. WSAGetLastError() returns ").append(to_wstring(WSAGetLastError())));
+		}
+
+		// WSAStartup once per process, WSACleanup at exit
+		struct wsa_session
+		{
+			wsa_session()
+			{
+				WSADATA data;
+				if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+					throw socket_error(L"WSAStartup");
+				}
+			}
+			~wsa_session()
+			{
+				WSACleanup();
+			}
+		};
+
+		sockaddr_un make_address(const string& path)
+		{
+			sockaddr_un addr{};
+			addr.sun_family = AF_UNIX;
+			if (path.size() >= sizeof(addr.sun_path)) {
+				throw olc_exception(L"Spectator socket path too long");
+			}
+			strncpy_s(addr.sun_path, sizeof(addr.sun_path), path.c_str(), path.size());
+			return addr;
+		}
+
+		void set_non_blocking(SOCKET s)
+		{
+			u_long mode = 1;
+			ioctlsocket(s, FIONBIO, &mode);
+		}
+
+		bool same_cell(const CHAR_INFO& a, const CHAR_INFO& b)
+		{
+			return a.Char.UnicodeChar == b.Char.UnicodeChar && a.Attributes == b.Attributes;
+		}
+
+		// reuse the buffer if no client is still sending it, otherwise start a new one
+		shared_ptr<vector<char>> acquire(shared_ptr<vector<char>>& buf)
+		{
+			if (!buf || buf.use_count() > 1) {
+				buf = make_shared<vector<char>>();
+			}
+			buf->clear();
+			return buf;
+		}
+
+		void write_header(vector<char>& out, frame_type type, int w, int h, uint32_t seq, uint32_t runs)
+		{
+			frame_header hdr{ magic, type, (uint16_t)w, (uint16_t)h, 0, seq, runs, (uint32_t)(out.size() - sizeof(frame_header)) };
+			memcpy(out.data(), &hdr, sizeof(hdr));
+		}
+	}
+
+	//
+	// spectator_server class
+	//
+	spectator_server::spectator_server(const string& socket_path)
+		: _path{ socket_path }
+		, _listen_sock{ INVALID_SOCKET }
+	{
+		static wsa_session wsa;
+
+		auto addr = make_address(_path);
+		// a stale socket file from a previous run makes bind fail
+		DeleteFileA(_path.c_str());
+
+		SOCKET s = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (s == INVALID_SOCKET) {
+			throw socket_error(L"socket");
+		}
+		if (::bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+			closesocket(s);
+			throw socket_error(L"bind");
+		}
+		if (listen(s, SOMAXCONN) == SOCKET_ERROR) {
+			closesocket(s);
+			throw socket_error(L"listen");
+		}
+		set_non_blocking(s);
+		_listen_sock = s;
+	}
+
+	spectator_server::~spectator_server()
+	{
+		for (auto& c : _clients) {
+			close_socket(c.sock);
+		}
+		_clients.clear();
+		if (_listen_sock != INVALID_SOCKET) {
+			close_socket(_listen_sock);
+			DeleteFileA(_path.c_str());
+		}
+	}
+
+	void spectator_server::close_socket(uintptr_t sock)
+	{
+		closesocket(static_cast<SOCKET>(sock));
+	}
+
+	void spectator_server::accept_clients()
+	{
+		// poll with 0 timeout so the game thread never waits on viewers
+		WSAPOLLFD pfd{ static_cast<SOCKET>(_listen_sock), POLLRDNORM, 0 };
+		while (WSAPoll(&pfd, 1, 0) > 0 && (pfd.revents & POLLRDNORM)) {
+			SOCKET s = accept(static_cast<SOCKET>(_listen_sock), nullptr, nullptr);
+			if (s == INVALID_SOCKET) {
+				break;
+			}
+			set_non_blocking(s);
+			_clients.push_back({ static_cast<uintptr_t>(s) });
+			OutputDebugString(L"spectator connected\n");
+		}
+	}
+
+	bool spectator_server::flush(client& c)
+	{
+		const auto& buf = *c.pending;
+		while (c.sent < buf.size()) {
+			int len = static_cast<int>(min<size_t>(buf.size() - c.sent, INT_MAX));
+			int r = send(static_cast<SOCKET>(c.sock), buf.data() + c.sent, len, 0);
+			if (r == SOCKET_ERROR) {
+				// would block - the viewer is behind, keep what is left for later
+				return WSAGetLastError() == WSAEWOULDBLOCK;
+			}
+			c.sent += r;
+		}
+		c.pending.reset();
+		c.sent = 0;
+		return true;
+	}
+
+	spectator_server::frame_buf spectator_server::make_keyframe(const CHAR_INFO* screen, int w, int h)
+	{
+		auto out = acquire(_key_buf);
+		size_t n = static_cast<size_t>(w) * h;
+		out->resize(sizeof(frame_header) + n * sizeof(CHAR_INFO));
+		memcpy(out->data() + sizeof(frame_header), screen, n * sizeof(CHAR_INFO));
+		write_header(*out, keyframe, w, h, _seq, 0);
+		return out;
+	}
+
+	spectator_server::frame_buf spectator_server::make_delta(const CHAR_INFO* screen, int w, int h)
+	{
+		auto out = acquire(_delta_buf);
+		out->resize(sizeof(frame_header));
+		uint32_t runs = 0;
+		const int n = w * h;
+		int i = 0;
+		while (i < n) {
+			if (same_cell(screen[i], _prev[i])) {
+				++i;
+				continue;
+			}
+			// extend the run until g_run_merge_gap unchanged cells in a row
+			int start = i;
+			int end = i + 1;
+			for (int j = end; j < n && j - end < g_run_merge_gap; ++j) {
+				if (!same_cell(screen[j], _prev[j])) {
+					end = j + 1;
+				}
+			}
+
+			run_header run{ static_cast<uint32_t>(start), static_cast<uint32_t>(end - start) };
+			size_t pos = out->size();
+			size_t cells_bytes = run.length * sizeof(CHAR_INFO);
+			out->resize(pos + sizeof(run) + cells_bytes);
+			memcpy(out->data() + pos, &run, sizeof(run));
+			memcpy(out->data() + pos + sizeof(run), screen + start, cells_bytes);
+			memcpy(_prev.data() + start, screen + start, cells_bytes);
+			++runs;
+			i = end;
+		}
+		if (runs == 0) {
+			return nullptr;
+		}
+		write_header(*out, delta, w, h, _seq, runs);
+		return out;
+	}
+
+	void spectator_server::publish(const CHAR_INFO* screen, int w, int h, int stride)
+	{
+		accept_clients();
+		if (_clients.empty()) {
+			// nobody to diff for, the next viewer starts from a keyframe anyway
+			_prev_width = 0;
+			_prev_height = 0;
+			return;
+		}
+
+		if (stride > w) {
+			// padded rows, the wire format is always packed
+			_packed.resize(static_cast<size_t>(w) * h);
+			for (int y = 0; y < h; ++y) {
+				copy_n(screen + static_cast<size_t>(y) * stride, w, _packed.data() + static_cast<size_t>(y) * w);
+			}
+			screen = _packed.data();
+		}
+
+		++_seq;
+		// the diff is done once per frame, regardless of the number of viewers
+		frame_buf delta;
+		if (w == _prev_width && h == _prev_height) {
+			delta = make_delta(screen, w, h);
+		}
+		else {
+			_prev.assign(screen, screen + static_cast<size_t>(w) * h);
+			_prev_width = w;
+			_prev_height = h;
+			for (auto& c : _clients) {
+				c.need_keyframe = true;
+			}
+		}
+
+		frame_buf key;
+		for (size_t i = 0; i < _clients.size();) {
+			auto& c = _clients[i];
+			bool ok = true;
+			if (c.pending) {
+				ok = flush(c);
+				if (ok && c.pending) {
+					// still busy with an older frame, this one is dropped for it
+					c.need_keyframe = true;
+				}
+			}
+			if (ok && !c.pending) {
+				if (c.need_keyframe) {
+					if (!key) {
+						key = make_keyframe(screen, w, h);
+					}
+					c.pending = key;
+					c.need_keyframe = false;
+				}
+				else {
+					c.pending = delta;
+				}
+				if (c.pending) {
+					c.sent = 0;
+					ok = flush(c);
+				}
+			}
+
+			if (!ok) {
+				OutputDebugString(L"spectator disconnected\n");
+				close_socket(c.sock);
+				_clients.erase(_clients.begin() + i);
+				continue;
+			}
+			++i;
+		}
+	}
+
+	//
+	// spectator_client class
+	//
+	spectator_client::spectator_client()
+		: _sock{ INVALID_SOCKET }
+	{
+		static wsa_session wsa;
+	}
+
+	spectator_client::~spectator_client()
+	{
+		if (_sock != INVALID_SOCKET) {
+			closesocket(static_cast<SOCKET>(_sock));
+		}
+	}
+
+	void spectator_client::connect(const string& socket_path)
+	{
+		auto addr = make_address(socket_path);
+		SOCKET s = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (s == INVALID_SOCKET) {
+			throw socket_error(L"socket");
+		}
+		if (::connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+			closesocket(s);
+			throw socket_error(L"connect");
+		}
+		_sock = s;
+
+		// the server always starts a new viewer with a keyframe
+		while (_width == 0) {
+			if (!receive(true) || !apply_messages()) {
+				throw olc_exception(L"Spectator stream closed before the first keyframe");
+			}
+		}
+		set_non_blocking(s);
+	}
+
+	bool spectator_client::poll()
+	{
+		if (!receive(false)) {
+			return false;
+		}
+		return apply_messages();
+	}
+
+	bool spectator_client::receive(bool block)
+	{
+		array<char, g_recv_chunk> chunk;
+		do {
+			int r = recv(static_cast<SOCKET>(_sock), chunk.data(), static_cast<int>(chunk.size()), 0);
+			if (r == 0) {
+				return false;
+			}
+			if (r == SOCKET_ERROR) {
+				return !block && WSAGetLastError() == WSAEWOULDBLOCK;
+			}
+			_inbuf.insert(_inbuf.end(), chunk.data(), chunk.data() + r);
+		} while (!block);
+		return true;
+	}
+
+	bool spectator_client::apply_messages()
+	{
+		size_t pos = 0;
+		while (_inbuf.size() - pos >= sizeof(frame_header)) {
+			frame_header hdr;
+			memcpy(&hdr, _inbuf.data() + pos, sizeof(hdr));
+			if (hdr.magic != magic) {
+				return false;
+			}
+			if (_inbuf.size() - pos - sizeof(hdr) < hdr.payload_size) {
+				// wait for the rest of the message
+				break;
+			}
+
+			const char* payload = _inbuf.data() + pos + sizeof(hdr);
+			size_t ncells = static_cast<size_t>(hdr.width) * hdr.height;
+			if (hdr.type == keyframe) {
+				if (hdr.payload_size != ncells * sizeof(CHAR_INFO)) {
+					return false;
+				}
+				_width = hdr.width;
+				_height = hdr.height;
+				_screen.resize(ncells);
+				memcpy(_screen.data(), payload, hdr.payload_size);
+				_changed.clear();
+				_changed.push_back({ 0, static_cast<uint32_t>(ncells) });
+			}
+			else if (hdr.type == delta && hdr.width == _width && hdr.height == _height) {
+				const char* p = payload;
+				const char* end = payload + hdr.payload_size;
+				for (uint32_t r = 0; r < hdr.run_count; ++r) {
+					run_header run;
+					if (end - p < static_cast<ptrdiff_t>(sizeof(run))) {
+						return false;
+					}
+					memcpy(&run, p, sizeof(run));
+					p += sizeof(run);
+					size_t bytes = static_cast<size_t>(run.length) * sizeof(CHAR_INFO);
+					if (static_cast<size_t>(run.offset) + run.length > ncells || static_cast<size_t>(end - p) < bytes) {
+						return false;
+					}
+					memcpy(_screen.data() + run.offset, p, bytes);
+					p += bytes;
+					_changed.push_back(run);
+				}
+				if (_changed.size() > g_max_changed_runs) {
+					_changed.assign(1, { 0, static_cast<uint32_t>(ncells) });
+				}
+			}
+			pos += sizeof(hdr) + hdr.payload_size;
+		}
+		_inbuf.erase(_inbuf.begin(), _inbuf.begin() + pos);
+		return true;
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace olc
+{
+	//
+	// Wire format of the spectator stream. Every message is a frame_header followed by its payload.
+	//
+	// keyframe: width * height CHAR_INFO cells, row major.
+	// delta:    run_count runs, each a run_header followed by run.length CHAR_INFO cells.
+	//
+	// Only changed cells are serialized for a delta, and the serialized buffer is shared by all viewers.
+	//
+	namespace spectator_protocol
+	{
+		constexpr uint32_t magic = 0x53434c4f;	// "OLCS"
+		constexpr const char* default_path = "olc_spectator.sock";
+
+		enum frame_type : uint16_t
+		{
+			keyframe = 0,
+			delta = 1,
+		};
+
+#pragma pack(push, 1)
+		struct frame_header
+		{
+			uint32_t magic;
+			uint16_t type;
+			uint16_t width;
+			uint16_t height;
+			uint16_t reserved;
+			uint32_t seq;
+			uint32_t run_count;		// number of runs for delta, 0 for keyframe
+			uint32_t payload_size;	// bytes following this header
+		};
+
+		struct run_header
+		{
+			uint32_t offset;		// index of the first cell, y * width + x
+			uint32_t length;		// number of cells in the run
+		};
+#pragma pack(pop)
+	}
+
+	//
+	// Fans out the engine's screen to local viewers over a unix domain socket.
+	//
+	// publish() is called once per frame from the game thread. It diffs the frame against the last published one,
+	// serializes the changed cells once, and writes that same buffer to every connected viewer with non blocking sends.
+	// A viewer that can't keep up still has at most one frame in flight; the frames it misses are dropped and it is
+	// resynced with the next keyframe instead of buffering without bound.
+	//
+	class spectator_server
+	{
+	public:
+		explicit spectator_server(const std::string& socket_path);
+		~spectator_server();
+
+		spectator_server(const spectator_server&) = delete;
+		spectator_server& operator=(const spectator_server&) = delete;
+
+		// stride is the distance between rows in cells, 0 for rows packed back to back
+		void publish(const CHAR_INFO* screen, int w, int h, int stride = 0);
+
+		size_t viewer_count() const { return _clients.size(); }
+
+	private:
+		using frame_buf = std::shared_ptr<const std::vector<char>>;
+
+		struct client
+		{
+			uintptr_t sock;
+			frame_buf pending;		// frame partially sent to this client
+			size_t sent{ 0 };
+			bool need_keyframe{ true };
+		};
+
+		void accept_clients();
+		// returns false if the connection is broken
+		bool flush(client& c);
+		frame_buf make_keyframe(const CHAR_INFO* screen, int w, int h);
+		frame_buf make_delta(const CHAR_INFO* screen, int w, int h);
+		void close_socket(uintptr_t sock);
+
+	private:
+		std::string _path;
+		uintptr_t _listen_sock;
+		std::vector<client> _clients;
+		// serialization buffers, reused once no client is sending them anymore
+		std::shared_ptr<std::vector<char>> _key_buf;
+		std::shared_ptr<std::vector<char>> _delta_buf;
+		// last published frame, used for diffing
+		std::vector<CHAR_INFO> _prev;
+		// rows of a padded screen copied back to back
+		std::vector<CHAR_INFO> _packed;
+		int _prev_width{ 0 };
+		int _prev_height{ 0 };
+		uint32_t _seq{ 0 };
+	};
+
+	//
+	// Receiving end of the spectator stream. Reassembles messages from a non blocking socket and applies them to a
+	// local copy of the screen.
+	//
+	class spectator_client
+	{
+	public:
+		spectator_client();
+		~spectator_client();
+
+		spectator_client(const spectator_client&) = delete;
+		spectator_client& operator=(const spectator_client&) = delete;
+
+		// blocks until the first keyframe is received so that the screen size is known
+		void connect(const std::string& socket_path);
+
+		// apply all complete messages received so far. Returns false if the server has gone away.
+		bool poll();
+
+		// a keyframe may change the size, the screen is then resized and changed() covers all of it
+		int width() const { return _width; }
+		int height() const { return _height; }
+		const std::vector<CHAR_INFO>& screen() const { return _screen; }
+
+		// Cells changed since the last clear_changed(), as (offset, length) runs. poll() adds to them rather than
+		// starting over, so nothing is lost if they aren't drawn after every poll, starting with the first keyframe.
+		const std::vector<spectator_protocol::run_header>& changed() const { return _changed; }
+		void clear_changed() { _changed.clear(); }
+
+	private:
+		bool receive(bool block);
+		bool apply_messages();
+
+	private:
+		uintptr_t _sock;
+		std::vector<char> _inbuf;
+		std::vector<CHAR_INFO> _screen;
+		std::vector<spectator_protocol::run_header> _changed;
+		int _width{ 0 };
+		int _height{ 0 };
+	};
+}
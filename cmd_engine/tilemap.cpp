@@ -0,0 +1,198 @@
+#include "tilemap.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		// rounds towards negative infinity, cameras may look left of or above the map
+		int floor_div(int a, int b)
+		{
+			return (a >= 0) ? a / b : -((-a + b - 1) / b);
+		}
+
+		const CHAR_INFO g_blank{ { L' ' }, 0 };
+	}
+
+	void camera::follow(float wx, float wy, int view_w, int view_h, const tilemap& map)
+	{
+		x = wx - view_w * 0.5f;
+		y = wy - view_h * 0.5f;
+		// a map smaller than the view stays at the top left
+		x = max(0.0f, min(x, float(map.world_width() - view_w)));
+		y = max(0.0f, min(y, float(map.world_height() - view_h)));
+	}
+
+	tilemap::tilemap(int w, int h, int tile_w, int tile_h)
+		: _width{ w }
+		, _height{ h }
+		, _tile_w{ tile_w }
+		, _tile_h{ tile_h }
+		, _tileset(static_cast<size_t>(tile_w) * tile_h, g_blank)
+	{
+	}
+
+	void tilemap::define_tile(tile_id id, wchar_t c, short color)
+	{
+		size_t cells = static_cast<size_t>(_tile_w) * _tile_h;
+		if (_tileset.size() < (id + 1) * cells) {
+			_tileset.resize((id + 1) * cells, g_blank);
+		}
+		CHAR_INFO ci;
+		ci.Char.UnicodeChar = c;
+		ci.Attributes = color;
+		fill_n(_tileset.begin() + id * cells, cells, ci);
+		++_tileset_version;
+	}
+
+	void tilemap::define_tile(tile_id id, const sprite& s)
+	{
+		size_t cells = static_cast<size_t>(_tile_w) * _tile_h;
+		if (_tileset.size() < (id + 1) * cells) {
+			_tileset.resize((id + 1) * cells, g_blank);
+		}
+		for (int y = 0; y < _tile_h; ++y) {
+			for (int x = 0; x < _tile_w; ++x) {
+				auto& ci = _tileset[id * cells + y * _tile_w + x];
+				ci.Char.UnicodeChar = s.get_glyph(x, y);
+				ci.Attributes = s.get_color(x, y);
+			}
+		}
+		++_tileset_version;
+	}
+
+	void tilemap::set(int x, int y, tile_id id)
+	{
+		if (out_of_bound(x, y)) {
+			return;
+		}
+		int cx = x / chunk_tiles;
+		int cy = y / chunk_tiles;
+		auto it = _chunks.find(chunk_key(cx, cy));
+		if (it == _chunks.end()) {
+			if (id == 0) {
+				// already empty, keep the chunk unallocated
+				return;
+			}
+			it = _chunks.emplace(chunk_key(cx, cy), make_unique<chunk>()).first;
+		}
+		auto& tile = it->second->tiles[(y - cy * chunk_tiles) * chunk_tiles + (x - cx * chunk_tiles)];
+		if (tile != id) {
+			tile = id;
+			it->second->raster_version = 0;
+		}
+	}
+
+	tilemap::tile_id tilemap::get(int x, int y) const
+	{
+		if (out_of_bound(x, y)) {
+			return 0;
+		}
+		int cx = x / chunk_tiles;
+		int cy = y / chunk_tiles;
+		auto it = _chunks.find(chunk_key(cx, cy));
+		if (it == _chunks.end()) {
+			return 0;
+		}
+		return it->second->tiles[(y - cy * chunk_tiles) * chunk_tiles + (x - cx * chunk_tiles)];
+	}
+
+	const CHAR_INFO* tilemap::tile_cells(tile_id id) const
+	{
+		size_t cells = static_cast<size_t>(_tile_w) * _tile_h;
+		// undefined tiles look like the empty one
+		if ((id + 1) * cells > _tileset.size()) {
+			id = 0;
+		}
+		return _tileset.data() + id * cells;
+	}
+
+	void tilemap::rasterize(const array<tile_id, chunk_tiles * chunk_tiles>& tiles, vector<CHAR_INFO>& raster) const
+	{
+		int raster_w = chunk_tiles * _tile_w;
+		raster.resize(static_cast<size_t>(raster_w) * chunk_tiles * _tile_h);
+		for (int ty = 0; ty < chunk_tiles; ++ty) {
+			for (int tx = 0; tx < chunk_tiles; ++tx) {
+				const CHAR_INFO* src = tile_cells(tiles[ty * chunk_tiles + tx]);
+				CHAR_INFO* dst = raster.data() + static_cast<size_t>(ty) * _tile_h * raster_w + tx * _tile_w;
+				for (int y = 0; y < _tile_h; ++y) {
+					copy_n(src + y * _tile_w, _tile_w, dst + static_cast<size_t>(y) * raster_w);
+				}
+			}
+		}
+	}
+
+	const CHAR_INFO* tilemap::raster(int cx, int cy)
+	{
+		chunk* c = &_empty;
+		if (cx >= 0 && cy >= 0) {
+			auto it = _chunks.find(chunk_key(cx, cy));
+			if (it != _chunks.end()) {
+				c = it->second.get();
+			}
+		}
+		if (c->raster_version != _tileset_version) {
+			rasterize(c->tiles, c->raster);
+			c->raster_version = _tileset_version;
+		}
+		return c->raster.data();
+	}
+
+	void tilemap::render(cmd_engine& engine, const camera& cam, int x, int y, int w, int h)
+	{
+		OLC_TRACE_ZONE("tilemap render");
+		if (w <= 0) {
+			w = engine.width();
+		}
+		if (h <= 0) {
+			h = engine.height();
+		}
+		// clip the view to the screen, shifting the world origin along with it
+		int wx0 = static_cast<int>(floorf(cam.x));
+		int wy0 = static_cast<int>(floorf(cam.y));
+		if (x < 0) {
+			wx0 -= x;
+			w += x;
+			x = 0;
+		}
+		if (y < 0) {
+			wy0 -= y;
+			h += y;
+			y = 0;
+		}
+		w = min(w, engine.width() - x);
+		h = min(h, engine.height() - y);
+		if (w <= 0 || h <= 0) {
+			return;
+		}
+
+		// only the chunks overlapping the view are visited, one span per chunk per row
+		int chunk_w = chunk_tiles * _tile_w;
+		int chunk_h = chunk_tiles * _tile_h;
+		int cx1 = floor_div(wx0, chunk_w);
+		int cx2 = floor_div(wx0 + w - 1, chunk_w);
+		int cy1 = floor_div(wy0, chunk_h);
+		int cy2 = floor_div(wy0 + h - 1, chunk_h);
+		int chunks_x = (_width + chunk_tiles - 1) / chunk_tiles;
+		int chunks_y = (_height + chunk_tiles - 1) / chunk_tiles;
+		for (int cy = cy1; cy <= cy2; ++cy) {
+			// the part of this chunk row in view, in world cells
+			int top = max(cy * chunk_h, wy0);
+			int bottom = min((cy + 1) * chunk_h, wy0 + h);
+			for (int cx = cx1; cx <= cx2; ++cx) {
+				int left = max(cx * chunk_w, wx0);
+				int right = min((cx + 1) * chunk_w, wx0 + w);
+				bool inside = cx >= 0 && cy >= 0 && cx < chunks_x && cy < chunks_y;
+				const CHAR_INFO* r = raster(inside ? cx : -1, inside ? cy : -1);
+				for (int wy = top; wy < bottom; ++wy) {
+					const CHAR_INFO* src = r + static_cast<size_t>(wy - cy * chunk_h) * chunk_w + (left - cx * chunk_w);
+					engine.draw_cells(x + left - wx0, y + wy - wy0, src, right - left);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace olc
+{
+	class tilemap;
+
+	//
+	// Top left corner of the view, in world cells (tiles * tile size)
+	//
+	struct camera
+	{
+		float x{ 0.0f };
+		float y{ 0.0f };
+
+		// Centers the view of view_w x view_h cells on a world position, without showing past the map edges
+		void follow(float wx, float wy, int view_w, int view_h, const tilemap& map);
+	};
+
+	//
+	// Grid of tiles that can be much bigger than the screen.
+	//
+	// Tiles are stored in chunks of chunk_tiles x chunk_tiles, only allocated once a non empty tile is set, so a
+	// 100k x 100k world costs memory for the parts that are used. Each chunk keeps its tiles rasterized into console
+	// cells, redone only after one of its tiles or the tileset changes, and render() copies the rows of the chunks
+	// in view straight to the screen as spans. The cost of a frame depends on the view size, not the map size.
+	//
+	// Tile 0 is the empty tile: what unset tiles and anything outside the map are drawn with. It's blank unless
+	// defined otherwise.
+	//
+	class tilemap
+	{
+	public:
+		using tile_id = uint16_t;
+		static constexpr int chunk_tiles = 32;
+
+	public:
+		// w, h in tiles; every tile is tile_w x tile_h console cells
+		tilemap(int w, int h, int tile_w = 1, int tile_h = 1);
+
+		tilemap(const tilemap&) = delete;
+		tilemap& operator=(const tilemap&) = delete;
+
+		// Every cell of the tile drawn with c in color
+		void define_tile(tile_id id, wchar_t c, short color);
+		// The tile looks like the sprite, which should be tile_w x tile_h
+		void define_tile(tile_id id, const sprite& s);
+
+		// Out of bound tiles are ignored
+		void set(int x, int y, tile_id id);
+		tile_id get(int x, int y) const;
+
+		int width() const { return _width; }
+		int height() const { return _height; }
+		int tile_width() const { return _tile_w; }
+		int tile_height() const { return _tile_h; }
+		// map size in console cells
+		int world_width() const { return _width * _tile_w; }
+		int world_height() const { return _height * _tile_h; }
+
+		size_t allocated_chunks() const { return _chunks.size(); }
+
+		// Draws the map as seen from cam into the w x h area at (x, y) of the screen, the whole screen by default
+		void render(cmd_engine& engine, const camera& cam, int x = 0, int y = 0, int w = 0, int h = 0);
+
+	private:
+		struct chunk
+		{
+			std::array<tile_id, chunk_tiles * chunk_tiles> tiles{};
+			// chunk_tiles * tile_w wide, empty until first drawn
+			std::vector<CHAR_INFO> raster;
+			// tileset version the raster was made with, 0 when it must be redone
+			uint32_t raster_version{ 0 };
+		};
+
+		static uint64_t chunk_key(int cx, int cy)
+		{
+			return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+		}
+
+		bool out_of_bound(int x, int y) const { return x < 0 || x >= _width || y < 0 || y >= _height; }
+		const CHAR_INFO* tile_cells(tile_id id) const;
+		// the chunk's raster, brought up to date; the empty raster for chunks never set
+		const CHAR_INFO* raster(int cx, int cy);
+		void rasterize(const std::array<tile_id, chunk_tiles * chunk_tiles>& tiles, std::vector<CHAR_INFO>& raster) const;
+
+	private:
+		int _width;
+		int _height;
+		int _tile_w;
+		int _tile_h;
+
+		// tile_w * tile_h cells per tile id
+		std::vector<CHAR_INFO> _tileset;
+		// bumped whenever a tile is defined, starts at 1 so 0 can mean never rasterized
+		uint32_t _tileset_version{ 1 };
+
+		std::unordered_map<uint64_t, std::unique_ptr<chunk>> _chunks;
+		// raster of a chunk of empty tiles
+		chunk _empty;
+	};
+}
@@ -0,0 +1,268 @@
+#include "trace.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	namespace trace
+	{
+		namespace detail
+		{
+			atomic<bool> g_recording{ false };
+		}
+
+		namespace
+		{
+			struct event
+			{
+				const char* name;
+				uint64_t begin;
+				uint64_t end;
+			};
+
+			//
+			// Single producer single consumer ring. The owner thread pushes at head, the flusher pops at tail.
+			//
+			struct thread_buffer
+			{
+				static constexpr uint64_t capacity = 1 << 14;
+				static constexpr uint64_t mask = capacity - 1;
+
+				alignas(64) atomic<uint64_t> head{ 0 };
+				// the producer's last look at tail, saves reading the flusher's cache line on every event
+				uint64_t cached_tail{ 0 };
+				// only written by the owner thread
+				atomic<uint64_t> dropped{ 0 };
+				alignas(64) atomic<uint64_t> tail{ 0 };
+				unique_ptr<event[]> events{ new event[capacity] };
+				uint32_t tid{ 0 };
+				// guarded by g_buffers_mutex
+				string name;
+				bool name_written{ true };
+			};
+
+			// buffers live until exit, a thread may still hold its pointer after a session ends
+			mutex g_buffers_mutex;
+			vector<unique_ptr<thread_buffer>> g_buffers;
+			thread_local thread_buffer* t_buffer = nullptr;
+
+			// session state, only touched by start/stop and the flusher
+			mutex g_session_mutex;
+			FILE* g_file = nullptr;
+			thread g_flusher;
+			mutex g_flusher_mutex;
+			condition_variable g_flusher_cv;
+			bool g_flusher_stop = false;
+			bool g_first_entry = true;
+			uint64_t g_tsc0 = 0;
+			double g_ticks_per_us = 1.0;
+
+			constexpr auto g_flush_interval = 10ms;
+
+			thread_buffer& this_thread_buffer()
+			{
+				if (!t_buffer) {
+					lock_guard<mutex> lk(g_buffers_mutex);
+					auto& buf = g_buffers.emplace_back(make_unique<thread_buffer>());
+					buf->tid = static_cast<uint32_t>(g_buffers.size());
+					t_buffer = buf.get();
+				}
+				return *t_buffer;
+			}
+
+			vector<thread_buffer*> snapshot_buffers()
+			{
+				lock_guard<mutex> lk(g_buffers_mutex);
+				vector<thread_buffer*> buffers;
+				for (auto& buf : g_buffers) {
+					buffers.push_back(buf.get());
+				}
+				return buffers;
+			}
+
+			void write_separator()
+			{
+				if (!g_first_entry) {
+					fputs(",\n", g_file);
+				}
+				g_first_entry = false;
+			}
+
+			void write_string(const char* s)
+			{
+				fputc('"', g_file);
+				for (; *s; ++s) {
+					if (*s == '"' || *s == '\\') {
+						fputc('\\', g_file);
+						fputc(*s, g_file);
+					}
+					else if (static_cast<unsigned char>(*s) < 0x20) {
+						fprintf(g_file, "\\u%04x", *s);
+					}
+					else {
+						fputc(*s, g_file);
+					}
+				}
+				fputc('"', g_file);
+			}
+
+			double to_us(uint64_t tsc)
+			{
+				return static_cast<double>(static_cast<int64_t>(tsc - g_tsc0)) / g_ticks_per_us;
+			}
+
+			void write_thread_names()
+			{
+				lock_guard<mutex> lk(g_buffers_mutex);
+				for (auto& buf : g_buffers) {
+					if (!buf->name_written) {
+						write_separator();
+						fprintf(g_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buf->tid);
+						write_string(buf->name.c_str());
+						fputs("}}", g_file);
+						buf->name_written = true;
+					}
+				}
+			}
+
+			// drains every ring into the file, called by the flusher, or by stop() once the flusher is gone
+			void drain()
+			{
+				write_thread_names();
+				for (auto* buf : snapshot_buffers()) {
+					uint64_t head = buf->head.load(memory_order_acquire);
+					uint64_t tail = buf->tail.load(memory_order_relaxed);
+					for (; tail != head; ++tail) {
+						const auto& e = buf->events[tail & thread_buffer::mask];
+						write_separator();
+						fputs("{\"name\":", g_file);
+						write_string(e.name);
+						fprintf(g_file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+							to_us(e.begin), static_cast<double>(e.end - e.begin) / g_ticks_per_us, buf->tid);
+					}
+					buf->tail.store(head, memory_order_release);
+				}
+				// keep the file usable if the game is killed rather than quit
+				fflush(g_file);
+			}
+
+			void flusher()
+			{
+				unique_lock<mutex> lk(g_flusher_mutex);
+				while (!g_flusher_cv.wait_for(lk, g_flush_interval, [] { return g_flusher_stop; })) {
+					lk.unlock();
+					drain();
+					lk.lock();
+				}
+			}
+		}
+
+		namespace detail
+		{
+			void record(const char* name, uint64_t begin, uint64_t end)
+			{
+				auto& buf = this_thread_buffer();
+				uint64_t head = buf.head.load(memory_order_relaxed);
+				if (head - buf.cached_tail >= thread_buffer::capacity) {
+					buf.cached_tail = buf.tail.load(memory_order_acquire);
+					if (head - buf.cached_tail >= thread_buffer::capacity) {
+						// the flusher is behind, losing events beats stalling the game
+						buf.dropped.store(buf.dropped.load(memory_order_relaxed) + 1, memory_order_relaxed);
+						return;
+					}
+				}
+				buf.events[head & thread_buffer::mask] = { name, begin, end };
+				buf.head.store(head + 1, memory_order_release);
+			}
+		}
+
+		bool start(const string& path)
+		{
+			lock_guard<mutex> lk(g_session_mutex);
+			if (g_file) {
+				return false;
+			}
+			if (fopen_s(&g_file, path.c_str(), "w") != 0 || !g_file) {
+				g_file = nullptr;
+				return false;
+			}
+
+			// rdtsc ticks at a constant rate on anything recent, measure it once against the steady clock
+			auto t0 = chrono::steady_clock::now();
+			uint64_t tsc0 = detail::now();
+			this_thread::sleep_for(20ms);
+			uint64_t tsc1 = detail::now();
+			auto t1 = chrono::steady_clock::now();
+			g_tsc0 = tsc0;
+			g_ticks_per_us = static_cast<double>(tsc1 - tsc0) / chrono::duration<double, micro>(t1 - t0).count();
+
+			// anything left over from a previous session is stale, names need writing again to the new file
+			{
+				lock_guard<mutex> blk(g_buffers_mutex);
+				for (auto& buf : g_buffers) {
+					buf->tail.store(buf->head.load(memory_order_acquire), memory_order_release);
+					buf->dropped.store(0, memory_order_relaxed);
+					buf->name_written = buf->name.empty();
+				}
+			}
+
+			// JSON array format, the closing bracket is optional so a trace of a killed game still loads
+			fputs("[\n", g_file);
+			g_first_entry = true;
+			g_flusher_stop = false;
+			g_flusher = thread(flusher);
+			detail::g_recording = true;
+			return true;
+		}
+
+		void stop()
+		{
+			lock_guard<mutex> lk(g_session_mutex);
+			if (!g_file) {
+				return;
+			}
+			detail::g_recording = false;
+			{
+				lock_guard<mutex> flk(g_flusher_mutex);
+				g_flusher_stop = true;
+			}
+			g_flusher_cv.notify_all();
+			g_flusher.join();
+			drain();
+
+			uint64_t dropped = 0;
+			for (auto* buf : snapshot_buffers()) {
+				dropped += buf->dropped.load(memory_order_relaxed);
+			}
+			if (dropped > 0) {
+				// global instant event at the end so it's easy to spot
+				write_separator();
+				fprintf(g_file, "{\"name\":\"dropped events\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":0,\"args\":{\"count\":%llu}}",
+					to_us(detail::now()), static_cast<unsigned long long>(dropped));
+			}
+			fputs("\n]\n", g_file);
+			fclose(g_file);
+			g_file = nullptr;
+		}
+
+		bool recording()
+		{
+			return detail::g_recording.load(memory_order_relaxed);
+		}
+
+		void set_thread_name(const string& name)
+		{
+			auto& buf = this_thread_buffer();
+			lock_guard<mutex> lk(g_buffers_mutex);
+			buf.name = name;
+			buf.name_written = false;
+		}
+	}
+}
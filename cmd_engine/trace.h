@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <intrin.h>
+
+//
+// Scoped trace zones, written as a Chrome trace event file that chrome://tracing or ui.perfetto.dev can open.
+//
+//     OLC_TRACE_ZONE("life generation");
+//
+// records the time from that line to the end of the enclosing scope. Zones only exist when OLC_ENABLE_TRACE is
+// defined, otherwise the macros expand to nothing and cost nothing. Recording is started and stopped at run time
+// with trace::start() and trace::stop(); a zone while not recording only costs a relaxed load.
+//
+// Each thread records into its own lock free ring, and a background thread drains the rings to the file, so a
+// zone is two rdtsc and a few stores on the hot path. When a ring is full, events are dropped rather than blocking.
+//
+#define OLC_TRACE_CONCAT_IMPL(a, b) a##b
+#define OLC_TRACE_CONCAT(a, b) OLC_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef OLC_ENABLE_TRACE
+// name must be a string literal, only the pointer is recorded
+#define OLC_TRACE_ZONE(name) ::olc::trace::zone OLC_TRACE_CONCAT(_olc_trace_zone_, __LINE__){ name }
+#define OLC_TRACE_THREAD_NAME(name) ::olc::trace::set_thread_name(name)
+#else
+#define OLC_TRACE_ZONE(name) ((void)0)
+#define OLC_TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+namespace olc
+{
+	namespace trace
+	{
+		// Starts recording to a new trace file. Returns false if the file can't be created or already recording.
+		bool start(const std::string& path);
+		// Writes out everything recorded so far and closes the file
+		void stop();
+		bool recording();
+
+		// Names the calling thread in the trace
+		void set_thread_name(const std::string& name);
+
+		namespace detail
+		{
+			extern std::atomic<bool> g_recording;
+
+			inline uint64_t now()
+			{
+				return __rdtsc();
+			}
+
+			void record(const char* name, uint64_t begin, uint64_t end);
+		}
+
+		class zone
+		{
+		public:
+			explicit zone(const char* name)
+				: _name{ name }
+				, _begin{ detail::g_recording.load(std::memory_order_relaxed) ? detail::now() : 0 }
+			{
+			}
+
+			~zone()
+			{
+				if (_begin) {
+					detail::record(_name, _begin, detail::now());
+				}
+			}
+
+			zone(const zone&) = delete;
+			zone& operator=(const zone&) = delete;
+
+		private:
+			const char* _name;
+			uint64_t _begin;
+		};
+	}
+}
@@ -0,0 +1,475 @@
+#include "video_player.h"
+#include "image_import.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+#include <string_view>
+
+using namespace std;
+
+namespace olc
+{
+	namespace
+	{
+		constexpr string_view g_y4m_magic = "YUV4MPEG2";
+		constexpr string_view g_y4m_frame = "FRAME";
+		constexpr size_t g_page_size = 4096;
+
+		//
+		// BT.601 studio range to rgb, 8 pixels per step in 16 bit fixed point with 5 fraction bits:
+		//   r = 1.164 (y - 16) + 1.596 (v - 128)
+		//   g = 1.164 (y - 16) - 0.392 (u - 128) - 0.813 (v - 128)
+		//   b = 1.164 (y - 16) + 2.017 (u - 128)
+		//
+		void yuv_to_rgb(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* r, uint8_t* g, uint8_t* b, int n)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i c16 = _mm_set1_epi16(16);
+			const __m128i c128 = _mm_set1_epi16(128);
+			const __m128i round = _mm_set1_epi16(16);
+			const __m128i ky = _mm_set1_epi16(37);
+			const __m128i kvr = _mm_set1_epi16(51);
+			const __m128i kug = _mm_set1_epi16(13);
+			const __m128i kvg = _mm_set1_epi16(26);
+			const __m128i kub = _mm_set1_epi16(65);
+			int x = 0;
+			for (; x + 8 <= n; x += 8) {
+				__m128i yy = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero), c16);
+				__m128i uu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x)), zero), c128);
+				__m128i vv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x)), zero), c128);
+				__m128i luma = _mm_add_epi16(_mm_mullo_epi16(yy, ky), round);
+				__m128i rr = _mm_srai_epi16(_mm_adds_epi16(luma, _mm_mullo_epi16(vv, kvr)), 5);
+				__m128i gg = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(luma, _mm_mullo_epi16(uu, kug)), _mm_mullo_epi16(vv, kvg)), 5);
+				__m128i bb = _mm_srai_epi16(_mm_adds_epi16(luma, _mm_mullo_epi16(uu, kub)), 5);
+				// packus clamps to 0..255
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(r + x), _mm_packus_epi16(rr, zero));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(g + x), _mm_packus_epi16(gg, zero));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(b + x), _mm_packus_epi16(bb, zero));
+			}
+			for (; x < n; ++x) {
+				int luma = (y[x] - 16) * 37 + 16;
+				int cu = u[x] - 128;
+				int cv = v[x] - 128;
+				r[x] = static_cast<uint8_t>(clamp((luma + cv * 51) >> 5, 0, 255));
+				g[x] = static_cast<uint8_t>(clamp((luma - cu * 13 - cv * 26) >> 5, 0, 255));
+				b[x] = static_cast<uint8_t>(clamp((luma + cu * 65) >> 5, 0, 255));
+			}
+		}
+	}
+
+	//
+	// index_queue
+	//
+	bool video_player::index_queue::push(int64_t v)
+	{
+		unique_lock<mutex> lk(_mutex);
+		_not_full.wait(lk, [this] { return _closed || _size < _buf.size(); });
+		if (_closed) {
+			return false;
+		}
+		_buf[(_head + _size) % _buf.size()] = v;
+		++_size;
+		_not_empty.notify_one();
+		return true;
+	}
+
+	bool video_player::index_queue::pop(int64_t& v)
+	{
+		unique_lock<mutex> lk(_mutex);
+		_not_empty.wait(lk, [this] { return _closed || _size > 0; });
+		if (_size == 0) {
+			return false;
+		}
+		v = _buf[_head];
+		_head = (_head + 1) % _buf.size();
+		--_size;
+		_not_full.notify_one();
+		return true;
+	}
+
+	bool video_player::index_queue::try_pop(int64_t& v)
+	{
+		lock_guard<mutex> lk(_mutex);
+		if (_size == 0) {
+			return false;
+		}
+		v = _buf[_head];
+		_head = (_head + 1) % _buf.size();
+		--_size;
+		_not_full.notify_one();
+		return true;
+	}
+
+	void video_player::index_queue::reset()
+	{
+		lock_guard<mutex> lk(_mutex);
+		_head = 0;
+		_size = 0;
+		_closed = false;
+	}
+
+	void video_player::index_queue::close()
+	{
+		lock_guard<mutex> lk(_mutex);
+		_closed = true;
+		_not_empty.notify_all();
+		_not_full.notify_all();
+	}
+
+	bool video_player::index_queue::closed_and_empty()
+	{
+		lock_guard<mutex> lk(_mutex);
+		return _closed && _size == 0;
+	}
+
+	//
+	// video_player
+	//
+	video_player::video_player(const wstring& file)
+	{
+		try {
+			map_file(file);
+			parse_y4m_header();
+		}
+		catch (...) {
+			// the destructor doesn't run for a throwing constructor
+			unmap();
+			throw;
+		}
+	}
+
+	video_player::video_player(const wstring& file, int w, int h, float fps)
+		: _video_w{ w }
+		, _video_h{ h }
+		, _fps{ fps }
+		, _frame_bytes{ static_cast<size_t>(w) * h * 3 }
+	{
+		if (w <= 0 || h <= 0 || !(fps > 0.0f)) {
+			throw olc_exception(L"Bad raw video size or frame rate for "s + file);
+		}
+		try {
+			map_file(file);
+		}
+		catch (...) {
+			unmap();
+			throw;
+		}
+	}
+
+	video_player::~video_player()
+	{
+		stop();
+		unmap();
+	}
+
+	void video_player::map_file(const wstring& file)
+	{
+		// mapped rather than read, the reader only has to touch the pages to bring them in
+		_file = CreateFileW(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (_file == INVALID_HANDLE_VALUE) {
+			throw olc_exception(L"Can't open video "s + file);
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+			throw olc_exception(L"Empty video "s + file);
+		}
+		_size = static_cast<size_t>(size.QuadPart);
+		_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!_mapping) {
+			throw olc_exception(L"Can't map video "s + file);
+		}
+		_data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!_data) {
+			throw olc_exception(L"Can't map video "s + file);
+		}
+	}
+
+	void video_player::unmap()
+	{
+		if (_data) {
+			UnmapViewOfFile(_data);
+			_data = nullptr;
+		}
+		if (_mapping) {
+			CloseHandle(_mapping);
+			_mapping = nullptr;
+		}
+		if (_file != INVALID_HANDLE_VALUE) {
+			CloseHandle(_file);
+			_file = INVALID_HANDLE_VALUE;
+		}
+	}
+
+	void video_player::parse_y4m_header()
+	{
+		const char* begin = reinterpret_cast<const char*>(_data);
+		const char* end = static_cast<const char*>(memchr(begin, '\n', _size));
+		string_view header(begin, end ? end - begin : 0);
+		if (!end || header.substr(0, g_y4m_magic.size()) != g_y4m_magic) {
+			throw olc_exception(L"Not a YUV4MPEG2 video");
+		}
+		_y4m = true;
+		_first_frame = header.size() + 1;
+
+		// space separated parameters, each a letter and a value
+		size_t pos = g_y4m_magic.size();
+		while (pos < header.size()) {
+			size_t next = header.find(' ', pos + 1);
+			string_view param = header.substr(pos + 1, (next == string_view::npos ? header.size() : next) - pos - 1);
+			pos = (next == string_view::npos) ? header.size() : next;
+			if (param.empty()) {
+				continue;
+			}
+			string value(param.substr(1));
+			switch (param[0]) {
+			case 'W':
+				_video_w = atoi(value.c_str());
+				break;
+			case 'H':
+				_video_h = atoi(value.c_str());
+				break;
+			case 'F': {
+				// a ratio, 30000:1001 for ntsc
+				size_t colon = value.find(':');
+				int num = atoi(value.c_str());
+				int den = (colon == string::npos) ? 1 : atoi(value.c_str() + colon + 1);
+				if (num > 0 && den > 0) {
+					_fps = static_cast<float>(num) / den;
+				}
+				break;
+			}
+			case 'C':
+				if (value.rfind("444", 0) == 0) {
+					_chroma_shift_x = 0;
+					_chroma_shift_y = 0;
+				}
+				else if (value.rfind("422", 0) == 0) {
+					_chroma_shift_x = 1;
+					_chroma_shift_y = 0;
+				}
+				else if (value.rfind("mono", 0) == 0) {
+					_mono = true;
+				}
+				else if (value.rfind("420", 0) != 0) {
+					throw olc_exception(L"Unsupported YUV4MPEG2 color space");
+				}
+				break;
+			}
+		}
+		if (_video_w <= 0 || _video_h <= 0) {
+			throw olc_exception(L"YUV4MPEG2 video without a size");
+		}
+		size_t luma = static_cast<size_t>(_video_w) * _video_h;
+		size_t chroma = static_cast<size_t>((_video_w + (1 << _chroma_shift_x) - 1) >> _chroma_shift_x) *
+			((_video_h + (1 << _chroma_shift_y) - 1) >> _chroma_shift_y);
+		_frame_bytes = _mono ? luma : luma + 2 * chroma;
+	}
+
+	void video_player::start(int w, int h)
+	{
+		stop();
+		_w = w;
+		_h = h;
+		_x_map.resize(w);
+		_cx_map.resize(w);
+		for (int x = 0; x < w; ++x) {
+			_x_map[x] = static_cast<int>(static_cast<int64_t>(x) * _video_w / w);
+			_cx_map[x] = _x_map[x] >> _chroma_shift_x;
+		}
+		// padded so the 8 wide loads never read past the end
+		for (auto* row : { &_y, &_u, &_v, &_r, &_g, &_b }) {
+			row->assign(w + 8, 0);
+		}
+
+		_to_convert.reset();
+		_ready.reset();
+		_free.reset();
+		_frames.assign(pool_frames, {});
+		for (size_t i = 0; i < pool_frames; ++i) {
+			_frames[i].cells.resize(static_cast<size_t>(w) * h);
+			_free.push(static_cast<int64_t>(i));
+		}
+		_pending = -1;
+		_stop = false;
+		_clock_started = false;
+		_presented = 0;
+		_dropped = 0;
+		_converted = 0;
+		_convert_ns = 0;
+		_reader = thread(&video_player::reader, this);
+		_converter = thread(&video_player::converter, this);
+	}
+
+	void video_player::stop()
+	{
+		_stop = true;
+		_to_convert.close();
+		_ready.close();
+		_free.close();
+		if (_reader.joinable()) {
+			_reader.join();
+		}
+		if (_converter.joinable()) {
+			_converter.join();
+		}
+	}
+
+	void video_player::reader()
+	{
+		OLC_TRACE_THREAD_NAME("video reader");
+		volatile uint8_t sink = 0;
+		bool any = false;
+		do {
+			size_t offset = _first_frame;
+			any = false;
+			while (!_stop) {
+				if (_y4m) {
+					// every frame has its own header line, normally just FRAME
+					const char* p = reinterpret_cast<const char*>(_data) + offset;
+					const char* nl = offset < _size ? static_cast<const char*>(memchr(p, '\n', _size - offset)) : nullptr;
+					if (!nl || string_view(p, nl - p).substr(0, g_y4m_frame.size()) != g_y4m_frame) {
+						break;
+					}
+					offset = nl - reinterpret_cast<const char*>(_data) + 1;
+				}
+				if (offset + _frame_bytes > _size) {
+					break;
+				}
+				// fault the frame in here, the converter then finds it in memory
+				for (size_t i = 0; i < _frame_bytes; i += g_page_size) {
+					sink = sink + _data[offset + i];
+				}
+				if (!_to_convert.push(static_cast<int64_t>(offset))) {
+					return;
+				}
+				any = true;
+				offset += _frame_bytes;
+			}
+			// a file without a single whole frame would spin forever
+		} while (_loop && !_stop && any);
+		_to_convert.close();
+	}
+
+	void video_player::converter()
+	{
+		OLC_TRACE_THREAD_NAME("video converter");
+		int64_t index = 0;
+		int64_t offset;
+		while (_to_convert.pop(offset)) {
+			int64_t this_index = index++;
+			// already a frame behind, converting it would only make the next one late too
+			if (!_unthrottled && started() && due(this_index + 1) < chrono::steady_clock::now()) {
+				++_dropped;
+				continue;
+			}
+			int64_t slot;
+			if (!_free.pop(slot)) {
+				break;
+			}
+			auto t0 = chrono::steady_clock::now();
+			frame& f = _frames[slot];
+			f.index = this_index;
+			convert(_data + offset, f);
+			_convert_ns += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count();
+			++_converted;
+			if (!_ready.push(slot)) {
+				break;
+			}
+		}
+		_ready.close();
+	}
+
+	void video_player::convert(const uint8_t* src, frame& f)
+	{
+		OLC_TRACE_ZONE("video convert");
+		if (!_y4m) {
+			// rgb24, only the sampling to deinterleave
+			for (int y = 0; y < _h; ++y) {
+				const uint8_t* row = src + static_cast<size_t>(y) * _video_h / _h * _video_w * 3;
+				for (int x = 0; x < _w; ++x) {
+					const uint8_t* p = row + _x_map[x] * 3;
+					_r[x] = p[0];
+					_g[x] = p[1];
+					_b[x] = p[2];
+				}
+				rgb_to_cells(_r.data(), _g.data(), _b.data(), _w, y, _dither, f.cells.data() + static_cast<size_t>(y) * _w);
+			}
+			return;
+		}
+
+		int chroma_w = (_video_w + (1 << _chroma_shift_x) - 1) >> _chroma_shift_x;
+		int chroma_h = (_video_h + (1 << _chroma_shift_y) - 1) >> _chroma_shift_y;
+		const uint8_t* plane_y = src;
+		const uint8_t* plane_u = src + static_cast<size_t>(_video_w) * _video_h;
+		const uint8_t* plane_v = plane_u + static_cast<size_t>(chroma_w) * chroma_h;
+		for (int y = 0; y < _h; ++y) {
+			int sy = static_cast<int>(static_cast<int64_t>(y) * _video_h / _h);
+			const uint8_t* line_y = plane_y + static_cast<size_t>(sy) * _video_w;
+			const uint8_t* line_u = plane_u + static_cast<size_t>(sy >> _chroma_shift_y) * chroma_w;
+			const uint8_t* line_v = plane_v + static_cast<size_t>(sy >> _chroma_shift_y) * chroma_w;
+			for (int x = 0; x < _w; ++x) {
+				_y[x] = line_y[_x_map[x]];
+				_u[x] = _mono ? 128 : line_u[_cx_map[x]];
+				_v[x] = _mono ? 128 : line_v[_cx_map[x]];
+			}
+			yuv_to_rgb(_y.data(), _u.data(), _v.data(), _r.data(), _g.data(), _b.data(), _w);
+			rgb_to_cells(_r.data(), _g.data(), _b.data(), _w, y, _dither, f.cells.data() + static_cast<size_t>(y) * _w);
+		}
+	}
+
+	chrono::steady_clock::time_point video_player::due(int64_t index) const
+	{
+		return _clock_start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(index / _fps));
+	}
+
+	bool video_player::draw(cmd_engine& engine, int x, int y)
+	{
+		auto now = chrono::steady_clock::now();
+		if (!started()) {
+			_clock_start = now;
+			_clock_started.store(true, memory_order_release);
+		}
+
+		// newest frame that is due; unthrottled, simply the next one
+		int64_t show = -1;
+		for (;;) {
+			if (_pending < 0 && !_ready.try_pop(_pending)) {
+				break;
+			}
+			if (!_unthrottled && due(_frames[_pending].index) > now) {
+				break;
+			}
+			if (show >= 0) {
+				++_dropped;
+				_free.push(show);
+			}
+			show = _pending;
+			_pending = -1;
+			if (_unthrottled) {
+				break;
+			}
+		}
+
+		if (show >= 0) {
+			const CHAR_INFO* cells = _frames[show].cells.data();
+			for (int row = 0; row < _h; ++row) {
+				engine.draw_cells(x, y + row, cells + static_cast<size_t>(row) * _w, _w);
+			}
+			++_presented;
+			_free.push(show);
+		}
+		return _pending >= 0 || !_ready.closed_and_empty();
+	}
+
+	video_player::stats video_player::get_stats() const
+	{
+		stats s;
+		s.presented = _presented;
+		s.dropped = _dropped;
+		uint64_t converted = _converted;
+		s.convert_ms = converted ? _convert_ns / 1e6 / converted : 0.0;
+		return s;
+	}
+}
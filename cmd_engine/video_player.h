@@ -0,0 +1,171 @@
+#pragma once
+
+#include "cmd_engine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace olc
+{
+	//
+	// Plays a raw video file on the console.
+	//
+	// Three stages on their own threads, joined by bounded queues:
+	//   reader    walks the memory mapped file a few frames ahead of the converter, touching their pages so the
+	//             converter doesn't stall on disk
+	//   converter scales each frame to the screen and turns it into console cells, yuv to rgb and the palette
+	//             quantize running 8 pixels at a time with SSE2
+	//   present   draw() on the game thread copies the frame that's due into the screen, the engine presents it
+	// Converted frames live in a fixed pool, so playback doesn't allocate.
+	//
+	// A frame that is already late when it reaches the converter is skipped, and when several are ready at once
+	// draw() shows only the newest due one; either way the video keeps time at the file's frame rate. Unthrottled,
+	// every frame is converted and shown as fast as the engine takes them, which makes a sustained throughput test
+	// of the presentation path.
+	//
+	// Supports YUV4MPEG2 (.y4m) in 420, 422, 444 and mono, and headerless rgb24 frames.
+	//
+	class video_player
+	{
+	public:
+		struct stats
+		{
+			uint64_t presented{ 0 };
+			// skipped by the converter or replaced by a newer frame before they were shown
+			uint64_t dropped{ 0 };
+			// average time to convert one frame
+			double convert_ms{ 0.0 };
+		};
+
+	public:
+		// Throws olc_exception if the file can't be opened or isn't a YUV4MPEG2 stream
+		explicit video_player(const std::wstring& file);
+		// Raw rgb24 frames of w x h, one after another
+		video_player(const std::wstring& file, int w, int h, float fps);
+		~video_player();
+
+		video_player(const video_player&) = delete;
+		video_player& operator=(const video_player&) = delete;
+
+		// Settings, before start()
+		void set_loop(bool loop) { _loop = loop; }
+		void set_dither(bool dither) { _dither = dither; }
+		// Ignore the frame rate and never drop frames
+		void set_unthrottled(bool unthrottled) { _unthrottled = unthrottled; }
+
+		// Starts reading and converting frames of w x h cells; the clock starts with the first draw()
+		void start(int w, int h);
+		void stop();
+
+		// Copies the frame due now to (x, y) on the screen, the last one stays when none is due.
+		// Returns false once the video has ended.
+		bool draw(cmd_engine& engine, int x = 0, int y = 0);
+
+		int video_width() const { return _video_w; }
+		int video_height() const { return _video_h; }
+		float fps() const { return _fps; }
+		stats get_stats() const;
+
+	private:
+		//
+		// Fixed size blocking queue of file offsets or pool indices. Closing wakes every waiter; pop still drains
+		// what's left.
+		//
+		class index_queue
+		{
+		public:
+			explicit index_queue(size_t capacity) : _buf(capacity) {}
+
+			// false if closed
+			bool push(int64_t v);
+			// false once closed and empty
+			bool pop(int64_t& v);
+			bool try_pop(int64_t& v);
+			void close();
+			bool closed_and_empty();
+			// empty and open again, only while nobody waits on it
+			void reset();
+
+		private:
+			std::vector<int64_t> _buf;
+			size_t _head{ 0 };
+			size_t _size{ 0 };
+			bool _closed{ false };
+			std::mutex _mutex;
+			std::condition_variable _not_empty;
+			std::condition_variable _not_full;
+		};
+
+		struct frame
+		{
+			// position in the video, counting on across loops
+			int64_t index{ 0 };
+			std::vector<CHAR_INFO> cells;
+		};
+
+		void map_file(const std::wstring& file);
+		void unmap();
+		void parse_y4m_header();
+		void reader();
+		void converter();
+		void convert(const uint8_t* src, frame& f);
+		std::chrono::steady_clock::time_point due(int64_t index) const;
+		bool started() const { return _clock_started.load(std::memory_order_acquire); }
+
+	private:
+		HANDLE _file{ INVALID_HANDLE_VALUE };
+		HANDLE _mapping{ nullptr };
+		const uint8_t* _data{ nullptr };
+		size_t _size{ 0 };
+
+		bool _y4m{ false };
+		int _video_w{ 0 };
+		int _video_h{ 0 };
+		// y4m chroma planes are the picture size shifted right by these
+		int _chroma_shift_x{ 1 };
+		int _chroma_shift_y{ 1 };
+		bool _mono{ false };
+		float _fps{ 30.0f };
+		size_t _first_frame{ 0 };
+		size_t _frame_bytes{ 0 };
+
+		bool _loop{ false };
+		bool _dither{ true };
+		bool _unthrottled{ false };
+
+		int _w{ 0 };
+		int _h{ 0 };
+		// source column of every screen column, for luma and chroma
+		std::vector<int> _x_map;
+		std::vector<int> _cx_map;
+		// one screen row of sampled yuv and of rgb, padded to a multiple of 8
+		std::vector<uint8_t> _y, _u, _v;
+		std::vector<uint8_t> _r, _g, _b;
+
+		// the reader passes file offsets, the converter and draw() pass indices into _frames
+		static constexpr size_t readahead_frames = 8;
+		static constexpr size_t pool_frames = 4;
+		index_queue _to_convert{ readahead_frames };
+		index_queue _ready{ pool_frames };
+		index_queue _free{ pool_frames };
+		std::vector<frame> _frames;
+		// popped from _ready but not due yet
+		int64_t _pending{ -1 };
+
+		std::atomic<bool> _stop{ false };
+		std::atomic<bool> _clock_started{ false };
+		std::chrono::steady_clock::time_point _clock_start;
+		std::thread _reader;
+		std::thread _converter;
+
+		std::atomic<uint64_t> _presented{ 0 };
+		std::atomic<uint64_t> _dropped{ 0 };
+		std::atomic<uint64_t> _converted{ 0 };
+		std::atomic<uint64_t> _convert_ns{ 0 };
+	};
+}
@@ -1,113 +1,175 @@
-#include "cmd_engine.h"
-
-
-using namespace std;
-
-namespace olc {
-
-	class game_of_life : public cmd_engine
-	{
-	public:
-		game_of_life()
-			: _grids(2)
-			, _active_grid_index{0}
-		{
-		}
-
-		// Inherited via cmd_engine
-		virtual bool on_user_init() override
-		{
-			_grids[0] = vector<int>(width() * height());
-			_grids[1] = vector<int>(width() * height());
-
-			auto &grid = _grids[_active_grid_index];
-
-			//grid[grid_index(3, 3)] = 1;
-			//grid[grid_index(4, 3)] = 1;
-			//grid[grid_index(5, 3)] = 1;
-			srand(time(nullptr));
-			for (auto &cell : grid) {
-				cell = (rand() % 2 == 0) ? 1 : 0;
-			}
-			return true;
-		}
-
-		virtual bool on_user_update(float elapsed) override
-		{
-			this_thread::sleep_for(100ms);
-
-			//
-			// update cells
-			//
-			auto &grid = _grids[_active_grid_index];
-			int update_grid_index = (_active_grid_index + 1) % 2;
-			auto &update_grid = _grids[update_grid_index];
-			
-			// use active grid state to write update to update_grid
-			for (int x = 0; x < width(); ++x) {
-				for (int y = 0; y < height(); ++y) {
-					auto count = neighbour_count(grid, x, y);
-					auto idx = grid_index(x, y);
-					if (count == 3) {
-						update_grid[idx] = 1;
-					}
-					else if (count == 2) {
-						update_grid[idx] = grid[idx];
-					}
-					else {
-						update_grid[idx] = 0;
-					}
-				}
-			}
-			_active_grid_index = update_grid_index;
-
-			//
-			// render
-			//
-			for (int x = 0; x < width(); ++x) {
-				for (int y = 0; y < height(); ++y) {
-					color_t::enum_t c = grid[grid_index(x, y)] ? color_t::white : color_t::black;
-					draw(x, y, pixel_type::solid, c);
-				}
-			}
-			return true;
-		}
-
-	private:
-		int grid_index(int x, int y) {
-			return y * width() + x;
-		}
-
-		int neighbour_count(const vector<int>& grid, int x, int y) {
-			int count = 0;
-			for (auto xoff : { -1, 0, 1 }) {
-				for (auto yoff : { -1, 0, 1 }) {
-					if (xoff != 0 || yoff != 0) {
-						auto px = x + xoff;
-						auto py = y + yoff;
-						if (px >= 0 && px < width() - 1 && py >= 0 && py < height() - 1) {
-							count += (grid[grid_index(px, py)] > 0) ? 1 : 0;
-						}
-					}
-				}
-			}
-			return count;
-		}
-
-	private:
-		vector<vector<int>> _grids;
-
-		// the grid to be rendered
-		int _active_grid_index;
-	};
-}
-
-int main() {
-	int grid_w = 160;
-	int grid_h = 100;
-	olc::game_of_life game{};
-	game.construct_console(grid_w, grid_h, 8, 8);
-	game.start();
-
-	return 0;
+#include "fixed_cmd_engine.h"
+#include "spectator.h"
+#include "engine_runner.h"
+#include "job_system.h"
+#include "trace.h"
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <random>
+
+
+using namespace std;
+
+namespace olc {
+	constexpr int g_grid_w = 160;
+	constexpr int g_grid_h = 100;
+
+	class game_of_life : public fixed_cmd_engine<g_grid_w, g_grid_h>
+	{
+	public:
+		// each game draws its starting cells from its own generator, games with different seeds start differently
+		explicit game_of_life(uint32_t seed)
+			: _grids(2)
+			, _active_grid_index{0}
+			, _random{ seed }
+		{
+		}
+
+		// Inherited via cmd_engine
+		virtual bool on_user_init() override
+		{
+			_grids[0] = vector<int>(width() * height());
+			_grids[1] = vector<int>(width() * height());
+
+			auto &grid = _grids[_active_grid_index];
+
+			//grid[grid_index(3, 3)] = 1;
+			//grid[grid_index(4, 3)] = 1;
+			//grid[grid_index(5, 3)] = 1;
+			for (auto &cell : grid) {
+				cell = (_random() % 2 == 0) ? 1 : 0;
+			}
+			return true;
+		}
+
+		virtual bool on_user_update(float elapsed) override
+		{
+			// slow down for viewing, simulations run flat out
+			if (!headless()) {
+				this_thread::sleep_for(100ms);
+			}
+
+			//
+			// update cells
+			//
+			auto &grid = _grids[_active_grid_index];
+			int update_grid_index = (_active_grid_index + 1) % 2;
+			auto &update_grid = _grids[update_grid_index];
+			
+			// use active grid state to write update to update_grid, rows are independent so they're spread across cores
+			OLC_TRACE_ZONE("life generation");
+			jobs().parallel_for_rows(0, height(), g_rows_per_job, [&](int y0, int y1) {
+				for (int y = y0; y < y1; ++y) {
+					for (int x = 0; x < width(); ++x) {
+						auto count = neighbour_count(grid, x, y);
+						auto idx = grid_index(x, y);
+						if (count == 3) {
+							update_grid[idx] = 1;
+						}
+						else if (count == 2) {
+							update_grid[idx] = grid[idx];
+						}
+						else {
+							update_grid[idx] = 0;
+						}
+					}
+				}
+			});
+			_active_grid_index = update_grid_index;
+
+			//
+			// render
+			//
+			jobs().parallel_for_rows(0, height(), g_rows_per_job, [&](int y0, int y1) {
+				for (int y = y0; y < y1; ++y) {
+					for (int x = 0; x < width(); ++x) {
+						color_t::enum_t c = grid[grid_index(x, y)] ? color_t::white : color_t::black;
+						draw(x, y, pixel_type::solid, c);
+					}
+				}
+			});
+			return true;
+		}
+
+		int population() const {
+			const auto& grid = _grids[_active_grid_index];
+			return static_cast<int>(count(grid.begin(), grid.end(), 1));
+		}
+
+	private:
+		int grid_index(int x, int y) {
+			return y * width() + x;
+		}
+
+		int neighbour_count(const vector<int>& grid, int x, int y) {
+			int count = 0;
+			for (auto xoff : { -1, 0, 1 }) {
+				for (auto yoff : { -1, 0, 1 }) {
+					if (xoff != 0 || yoff != 0) {
+						auto px = x + xoff;
+						auto py = y + yoff;
+						if (px >= 0 && px < width() - 1 && py >= 0 && py < height() - 1) {
+							count += (grid[grid_index(px, py)] > 0) ? 1 : 0;
+						}
+					}
+				}
+			}
+			return count;
+		}
+
+	private:
+		static constexpr int g_rows_per_job = 8;
+
+		vector<vector<int>> _grids;
+
+		// the grid to be rendered
+		int _active_grid_index;
+
+		mt19937 _random;
+	};
+}
+
+int main(int argc, char* argv[]) {
+	// cmd_life --sweep <games> <generations> [--seed <base>] runs many headless games in parallel and reports the populations
+	if (argc > 3 && argv[1] == "--sweep"s) {
+		int ngames = atoi(argv[2]);
+		int generations = atoi(argv[3]);
+		// one base seed for the sweep, printed so a run can be repeated with --seed <base>
+		uint32_t base_seed = (argc > 5 && argv[4] == "--seed"s) ? static_cast<uint32_t>(strtoul(argv[5], nullptr, 10))
+			: static_cast<uint32_t>(time(nullptr));
+		cout << "base seed " << base_seed << "\n";
+		vector<unique_ptr<olc::game_of_life>> games;
+		olc::engine_runner runner;
+		for (int i = 0; i < ngames; ++i) {
+			games.push_back(make_unique<olc::game_of_life>(base_seed + i));
+			games.back()->construct_headless();
+			runner.add(*games.back());
+		}
+		auto t1 = chrono::steady_clock::now();
+		auto frames = runner.run(0.1f, generations);
+		float secs = chrono::duration<float>(chrono::steady_clock::now() - t1).count();
+		for (int i = 0; i < ngames; ++i) {
+			cout << "game " << i << ": population " << games[i]->population() << "\n";
+		}
+		cout << frames << " generations on " << runner.thread_count() << " threads in " << secs << "s ("
+			<< frames / secs << " generations/s)" << endl;
+		return 0;
+	}
+
+	olc::game_of_life game{ static_cast<uint32_t>(time(nullptr)) };
+	game.construct_console(8, 8);
+	// cmd_life --spectate [socket path] lets the spectate tool watch the game
+	if (argc > 1 && argv[1] == "--spectate"s) {
+		game.enable_spectators(argc > 2 ? argv[2] : olc::spectator_protocol::default_path);
+	}
+	// cmd_life --trace <file> records a chrome trace, zones are only compiled in with OLC_ENABLE_TRACE
+	if (argc > 2 && argv[1] == "--trace"s) {
+		olc::trace::start(argv[2]);
+	}
+	game.start();
+	olc::trace::stop();
+
+	return 0;
 }
\ No newline at end of file
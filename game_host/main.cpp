@@ -0,0 +1,32 @@
+#include "game_module.h"
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	// game_host [module.dll [width height]] runs a game module, rebuild the module while it runs to see the change
+	wstring module = L"life_module.dll";
+	int width = 160;
+	int height = 100;
+	if (argc > 1) {
+		string arg = argv[1];
+		module.assign(arg.begin(), arg.end());
+	}
+	if (argc > 3) {
+		width = max(1, atoi(argv[2]));
+		height = max(1, atoi(argv[3]));
+	}
+
+	try {
+		olc::game_host host{ module };
+		host.construct_console(width, height, 8, 8);
+		host.start();
+	}
+	catch (olc::olc_exception& e) {
+		wcerr << e.msg().data() << endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include "image_import.h"
+#include "job_system.h"
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+//
+// Batch converts PPM/PGM images to .spr sprites.
+//
+// Files are converted in parallel, and rows within a file too, so a big asset directory or a single huge image
+// both keep every core busy. Directories are searched recursively for .ppm, .pgm and .pnm files.
+// Sprites are written next to their image unless --out is given, with the extension changed to .spr. Under --out
+// images found in a directory keep their path relative to it, so same named images in different subdirectories
+// don't overwrite each other; images that would still end up at the same sprite are refused before converting.
+//
+// usage: img2spr [--dither none|ordered|fs] [--width <cells>] [--out <dir>] <file or directory>...
+//
+namespace
+{
+	bool is_image(const fs::path& p)
+	{
+		auto ext = p.extension().wstring();
+		return ext == L".ppm" || ext == L".pgm" || ext == L".pnm";
+	}
+
+	struct job_result
+	{
+		fs::path in;
+		fs::path out;
+		bool ok{ false };
+		// why it failed, when there's more to say than that it did
+		wstring error;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	olc::dither_mode::enum_t mode = olc::dither_mode::ordered;
+	int width = 0;
+	fs::path out_dir;
+	vector<fs::path> inputs;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg == "--dither" && i + 1 < argc) {
+			string m = argv[++i];
+			if (m == "none") {
+				mode = olc::dither_mode::none;
+			}
+			else if (m == "ordered") {
+				mode = olc::dither_mode::ordered;
+			}
+			else if (m == "fs") {
+				mode = olc::dither_mode::floyd_steinberg;
+			}
+			else {
+				cerr << "unknown dither mode " << m << endl;
+				return 1;
+			}
+		}
+		else if (arg == "--width" && i + 1 < argc) {
+			width = atoi(argv[++i]);
+		}
+		else if (arg == "--out" && i + 1 < argc) {
+			out_dir = argv[++i];
+		}
+		else if (!arg.empty() && arg[0] != '-') {
+			inputs.emplace_back(arg);
+		}
+		else {
+			cerr << "usage: img2spr [--dither none|ordered|fs] [--width <cells>] [--out <dir>] <file or directory>..." << endl;
+			return 1;
+		}
+	}
+
+	vector<job_result> jobs;
+	error_code ec;
+	auto add_job = [&](const fs::path& in, const fs::path& relative) {
+		fs::path out = (out_dir.empty() ? in.parent_path() : out_dir / relative.parent_path()) / in.filename();
+		jobs.push_back({ in, out.replace_extension(L".spr") });
+	};
+	for (const auto& in : inputs) {
+		if (fs::is_directory(in, ec)) {
+			for (const auto& entry : fs::recursive_directory_iterator(in, ec)) {
+				if (entry.is_regular_file(ec) && is_image(entry.path())) {
+					add_job(entry.path(), entry.path().lexically_relative(in));
+				}
+			}
+		}
+		else {
+			add_job(in, in.filename());
+		}
+	}
+
+	// two jobs writing the same sprite at once would leave either or garbage
+	vector<fs::path> outs;
+	for (const auto& j : jobs) {
+		outs.push_back(j.out.lexically_normal());
+	}
+	sort(outs.begin(), outs.end());
+	bool clash = false;
+	for (size_t i = 1; i < outs.size(); ++i) {
+		if (outs[i] == outs[i - 1] && (i == 1 || outs[i] != outs[i - 2])) {
+			wcerr << L"more than one image converts to " << outs[i].wstring() << L"\n";
+			clash = true;
+		}
+	}
+	if (clash) {
+		return 1;
+	}
+
+	// directories are made up front, jobs making the same one at once could see each other's
+	for (const auto& j : jobs) {
+		if (!j.out.parent_path().empty()) {
+			fs::create_directories(j.out.parent_path(), ec);
+		}
+	}
+
+	olc::job_system js;
+	js.parallel_for_rows(0, static_cast<int>(jobs.size()), 1, [&](int begin, int end) {
+		for (int i = begin; i < end; ++i) {
+			auto& j = jobs[i];
+			// caught here, one bad image mustn't take the other jobs down with it
+			try {
+				olc::image img;
+				if (!olc::load_pnm(j.in.wstring(), img)) {
+					continue;
+				}
+				if (width > 0 && width != img.width) {
+					// keeps the aspect, console fonts set up by the samples have square cells
+					int height = max(1, static_cast<int>(static_cast<int64_t>(img.height) * width / img.width));
+					img = olc::resize_image(img, width, height);
+				}
+				// rows of one image go wide as well, the job system spreads both levels over the same workers
+				olc::sprite spr = olc::image_to_sprite(img, mode, &js);
+				j.ok = spr.save(j.out.wstring());
+			}
+			catch (const olc::olc_exception& e) {
+				j.error = e.msg();
+			}
+			catch (const exception& e) {
+				string what = e.what();
+				j.error.assign(what.begin(), what.end());
+			}
+		}
+	});
+
+	// a job that never ran counts as failed too
+	int failed = 0;
+	for (const auto& j : jobs) {
+		if (j.ok) {
+			wcout << j.in.wstring() << L" -> " << j.out.wstring() << L"\n";
+		}
+		else {
+			wcerr << L"failed: " << j.in.wstring() << (j.error.empty() ? L"" : L" (" + j.error + L")") << L"\n";
+			++failed;
+		}
+	}
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+#include "game_module.h"
+#include "job_system.h"
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+
+using namespace std;
+
+//
+// Game of life as a game module for game_host. Change the constants or the rules and rebuild while the host runs,
+// the board carries on from where it was.
+//
+namespace olc
+{
+	namespace
+	{
+		constexpr short g_live_color = color_t::white;
+		constexpr short g_dead_color = color_t::black;
+		// seconds between generations
+		constexpr float g_generation_time = 0.1f;
+		constexpr int g_rows_per_job = 8;
+
+		// consoles larger than this only use the top left of it
+		constexpr int g_max_w = 400;
+		constexpr int g_max_h = 200;
+
+		// everything that survives a reload, plain data only. Bump g_state_version when it changes.
+		struct life_state
+		{
+			int w;
+			int h;
+			int active;
+			float timer;
+			uint8_t grids[2][g_max_w * g_max_h];
+		};
+		constexpr uint32_t g_state_version = 1;
+
+		int neighbour_count(const life_state& s, const uint8_t* grid, int x, int y)
+		{
+			int count = 0;
+			for (int py = max(y - 1, 0); py <= min(y + 1, s.h - 1); ++py) {
+				for (int px = max(x - 1, 0); px <= min(x + 1, s.w - 1); ++px) {
+					count += grid[py * s.w + px];
+				}
+			}
+			return count - grid[y * s.w + x];
+		}
+
+		bool init(cmd_engine& engine, void* state, bool reloaded)
+		{
+			auto& s = *static_cast<life_state*>(state);
+			if (reloaded) {
+				return true;
+			}
+			s.w = min(engine.width(), g_max_w);
+			s.h = min(engine.height(), g_max_h);
+			srand(static_cast<unsigned>(time(nullptr)));
+			for (int i = 0; i < s.w * s.h; ++i) {
+				s.grids[0][i] = rand() % 2;
+			}
+			return true;
+		}
+
+		bool update(cmd_engine& engine, void* state, float elapsed)
+		{
+			if (engine.get_key(VK_ESCAPE).pressed) {
+				return false;
+			}
+
+			auto& s = *static_cast<life_state*>(state);
+			s.timer += elapsed;
+			if (s.timer >= g_generation_time) {
+				s.timer = 0.0f;
+				const uint8_t* grid = s.grids[s.active];
+				uint8_t* next = s.grids[1 - s.active];
+				engine.jobs().parallel_for_rows(0, s.h, g_rows_per_job, [&](int y0, int y1) {
+					for (int y = y0; y < y1; ++y) {
+						for (int x = 0; x < s.w; ++x) {
+							int count = neighbour_count(s, grid, x, y);
+							int idx = y * s.w + x;
+							next[idx] = count == 3 || (count == 2 && grid[idx]);
+						}
+					}
+				});
+				s.active = 1 - s.active;
+			}
+
+			const uint8_t* grid = s.grids[s.active];
+			for (int y = 0; y < s.h; ++y) {
+				for (int x = 0; x < s.w; ++x) {
+					engine.draw(x, y, pixel_type::solid, grid[y * s.w + x] ? g_live_color : g_dead_color);
+				}
+			}
+			return true;
+		}
+
+		constexpr game_api g_api{ game_api::current_abi, sizeof(life_state), g_state_version, init, update, nullptr };
+	}
+}
+
+OLC_GAME_EXPORT const olc::game_api* olc_game_api()
+{
+	return &olc::g_api;
+}
@@ -1,270 +1,429 @@
-#include "cmd_engine.h"
-#include <iostream>
-#include <stack>
-#include <thread>
-#include <time.h>
-
-using namespace std;
-
-namespace olc
-{
-    constexpr int g_maze_w = 40;
-    constexpr int g_maze_h = 25;
-    constexpr int g_cell_w = 3;
-    constexpr int pixel_offset_x = 1;
-    constexpr int pixel_offset_y = 1;
-    constexpr int g_window_w = g_maze_w * (g_cell_w + 1) + pixel_offset_x;	// cell true width + wall = g_cell_w + 1
-    constexpr int g_window_h = g_maze_h * (g_cell_w + 1) + pixel_offset_y;	// cell true height + wall = g_cell_w + 1
-
-    class maze : public olc::cmd_engine
-    {
-    private:
-        struct cell_attrib
-        {
-            enum enum_t
-            {
-                path_n = 0x01,
-                path_e = 0x02,
-                path_s = 0x04,
-                path_w = 0x08,
-                visited = 0x10,
-                solved = 0x20,
-            };
-        };
-
-        struct direction
-        {
-            enum enum_t
-            {
-                N, E, S, W,
-            };
-        };
-
-    public:
-        maze()
-            : _maze_w{ g_maze_w }
-            , _maze_h{ g_maze_h }
-            , _cell_w{ g_cell_w }
-            , _maze(_maze_w * _maze_h, 0)
-            , _solve_maze(_maze_w* _maze_h, 0)
-        {
-            _app_name = L"Maze";
-        }
-
-        // Inherited via cmd_engine
-        virtual bool on_user_init() override
-        {
-            srand(time(nullptr));
-            _stack.emplace(0, 0);
-            _maze[0] = cell_attrib::visited;
-            _solve_stack.emplace(0, 0);
-            _solve_maze[0] = cell_attrib::visited | cell_attrib::solved;
-            return true;
-        }
-
-        virtual bool on_user_update(float elapsed) override
-        {
-            // slow down for animation
-            //this_thread::sleep_for(2ms);
-
-            //
-            // update maze
-            //
-            // CAUTION: don't capture by [*this], it will make a copy of this object and will invoke the destructor, killing the console buffer
-            auto maze_index = [this](int x, int y) {
-                return y * _maze_w + x;
-            };
-            if (!_stack.empty()) {
-                vector<direction::enum_t> neighbours;
-                auto [curr_x, curr_y] = _stack.top();
-                if (curr_y > 0 && (_maze[maze_index(curr_x, curr_y - 1)] & cell_attrib::visited) == 0) {
-                    neighbours.push_back(direction::N);
-                }
-                if (curr_x < _maze_w - 1 && (_maze[maze_index(curr_x + 1, curr_y)] & cell_attrib::visited) == 0) {
-                    neighbours.push_back(direction::E);
-                }
-                if (curr_y < _maze_h - 1 && (_maze[maze_index(curr_x, curr_y + 1)] & cell_attrib::visited) == 0) {
-                    neighbours.push_back(direction::S);
-                }
-                if (curr_x > 0 && (_maze[maze_index(curr_x - 1, curr_y)] & cell_attrib::visited) == 0) {
-                    neighbours.push_back(direction::W);
-                }
-
-                if (!neighbours.empty()) {
-                    // move to next neighbour
-                    direction::enum_t next_dir = neighbours[rand() % neighbours.size()];
-                    // create path between the curr cell and neighbour
-                    switch (next_dir) {
-                    case direction::N:
-                        _maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_n;
-                        _maze[maze_index(curr_x, curr_y - 1)] |= cell_attrib::path_s | cell_attrib::visited;
-                        _stack.emplace(curr_x, curr_y - 1);
-                        break;
-                    case direction::E:
-                        _maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_e;
-                        _maze[maze_index(curr_x + 1, curr_y)] |= cell_attrib::path_w | cell_attrib::visited;
-                        _stack.emplace(curr_x + 1, curr_y);
-                        break;
-                    case direction::S:
-                        _maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_s;
-                        _maze[maze_index(curr_x, curr_y + 1)] |= cell_attrib::path_n | cell_attrib::visited;
-                        _stack.emplace(curr_x, curr_y + 1);
-                        break;
-                    case direction::W:
-                        _maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_w;
-                        _maze[maze_index(curr_x - 1, curr_y)] |= cell_attrib::path_e | cell_attrib::visited;
-                        _stack.emplace(curr_x - 1, curr_y);
-                        break;
-                    }
-                }
-                else {
-                    // no more neighbour, pop
-                    _stack.pop();
-                }
-            }
-            else if (!_solve_stack.empty()) {
-                // solving
-                auto has_path = [this, &maze_index](int x, int y, direction::enum_t dir) {
-                    cell_attrib::enum_t dir_val;
-                    switch (dir) {
-                    case direction::N:
-                        dir_val = cell_attrib::path_n;
-                        break;
-                    case direction::E:
-                        dir_val = cell_attrib::path_e;
-                        break;
-                    case direction::S:
-                        dir_val = cell_attrib::path_s;
-                        break;
-                    case direction::W:
-                        dir_val = cell_attrib::path_w;
-                        break;
-                    }
-                    return (_maze[maze_index(x, y)] & dir_val) != 0;
-                };
-                vector<direction::enum_t> neighbours;
-                auto [curr_x, curr_y] = _solve_stack.top();
-                if (curr_y > 0 && (_solve_maze[maze_index(curr_x, curr_y - 1)] & cell_attrib::visited) == 0 &&
-                    has_path(curr_x, curr_y, direction::N)) {
-                    neighbours.push_back(direction::N);
-                }
-                if (curr_x < _maze_w - 1 && (_solve_maze[maze_index(curr_x + 1, curr_y)] & cell_attrib::visited) == 0 &&
-                    has_path(curr_x, curr_y, direction::E)) {
-                    neighbours.push_back(direction::E);
-                }
-                if (curr_y < _maze_h - 1 && (_solve_maze[maze_index(curr_x, curr_y + 1)] & cell_attrib::visited) == 0 &&
-                    has_path(curr_x, curr_y, direction::S)) {
-                    neighbours.push_back(direction::S);
-                }
-                if (curr_x > 0 && (_solve_maze[maze_index(curr_x - 1, curr_y)] & cell_attrib::visited) == 0 &&
-                    has_path(curr_x, curr_y, direction::W)) {
-                    neighbours.push_back(direction::W);
-                }
-
-                if (!neighbours.empty()) {
-                    // move to next neighbour
-                    direction::enum_t next_dir = neighbours[rand() % neighbours.size()];
-                    // create path between the curr cell and neighbour
-                    switch (next_dir) {
-                    case direction::N:
-                        _solve_maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_n;
-                        _solve_maze[maze_index(curr_x, curr_y - 1)] |= cell_attrib::path_s | cell_attrib::visited | cell_attrib::solved;
-                        _solve_stack.emplace(curr_x, curr_y - 1);
-                        break;
-                    case direction::E:
-                        _solve_maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_e;
-                        _solve_maze[maze_index(curr_x + 1, curr_y)] |= cell_attrib::path_w | cell_attrib::visited | cell_attrib::solved;
-                        _solve_stack.emplace(curr_x + 1, curr_y);
-                        break;
-                    case direction::S:
-                        _solve_maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_s;
-                        _solve_maze[maze_index(curr_x, curr_y + 1)] |= cell_attrib::path_n | cell_attrib::visited | cell_attrib::solved;
-                        _solve_stack.emplace(curr_x, curr_y + 1);
-                        break;
-                    case direction::W:
-                        _solve_maze[maze_index(curr_x, curr_y)] |= cell_attrib::path_w;
-                        _solve_maze[maze_index(curr_x - 1, curr_y)] |= cell_attrib::path_e | cell_attrib::visited | cell_attrib::solved;
-                        _solve_stack.emplace(curr_x - 1, curr_y);
-                        break;
-                    }
-
-                    if (auto [dest_x, dest_y] = _solve_stack.top(); dest_x == _maze_w - 1 && dest_y == _maze_h - 1) {
-                        // reached the end, we solved the maze, empty the stack
-                        _solve_stack = {};
-                    }
-                }
-                else {
-                    // no more neighbour, pop
-                    // mark it as not solved
-                    _solve_stack.pop();
-                    _solve_maze[maze_index(curr_x, curr_y)] &= ~cell_attrib::solved;
-                }
-            }
-
-            //
-            // === rendering ===
-            //
-
-            // draw maze
-            
-            int cell_plus_wall_w = _cell_w + 1;
-            auto [curr_x, curr_y] = (!_stack.empty()) ? _stack.top() : pair<int, int>(-1, -1);
-            // draw cells
-            for (int x = 0; x < _maze_w; ++x) {
-                for (int y = 0; y < _maze_h; ++y) {
-                    // current cell = red, visited = white, non visited = blue, solved = cyan
-                    int cell = _maze[maze_index(x, y)];
-                    int solve_cell = _solve_maze[maze_index(x, y)];
-                    short cell_color{ color_t::red };
-                    if (x != curr_x || y != curr_y) {
-                        if (solve_cell & cell_attrib::solved) {
-                            cell_color = color_t::cyan;
-                        }
-                        else {
-                            cell_color = (cell & cell_attrib::visited) ? color_t::white : color_t::blue;
-                        }
-                    }
-                    for (int px = 0; px < _cell_w; ++px) {
-                        for (int py = 0; py < _cell_w; ++py) {
-                            draw(x * cell_plus_wall_w + px + pixel_offset_x, y * cell_plus_wall_w + py + pixel_offset_y, pixel_type::solid, cell_color);
-                        }
-                    }
-                    // draw paths, if there is a path, fill in white/cyan at the wall pixel to "break" the wall
-                    for (int p = 0; p < _cell_w; ++p) {
-                        if (cell & cell_attrib::path_s) {
-                            color_t::enum_t wall_color = (solve_cell & cell_attrib::path_s && _solve_maze[maze_index(x, y + 1)] & cell_attrib::solved) ? color_t::cyan : color_t::white;
-                            draw(x * cell_plus_wall_w + p + pixel_offset_x, y * cell_plus_wall_w + _cell_w + pixel_offset_y, pixel_type::solid, wall_color);
-                        }
-                        if (cell & cell_attrib::path_e) {
-                            color_t::enum_t wall_color = (solve_cell & cell_attrib::path_e && _solve_maze[maze_index(x + 1, y)] & cell_attrib::solved) ? color_t::cyan : color_t::white;
-                            draw(x * cell_plus_wall_w + _cell_w + pixel_offset_x, y * cell_plus_wall_w + p + pixel_offset_y, pixel_type::solid, wall_color);
-                        }
-                    }
-                }
-            }
-            return true;
-        }
-
-    private:
-        const int _maze_w;
-        const int _maze_h;
-        const int _cell_w;  // excluding wall of 1 pixel
-        vector<int> _maze;
-        stack<pair<int, int>> _stack;
-        vector<int> _solve_maze;
-        stack<pair<int, int>> _solve_stack;
-    };
-}
-
-int main()
-{
-    try {
-        olc::maze maze{};
-        maze.construct_console(olc::g_window_w, olc::g_window_h, 8, 8);
-        maze.start();
-    }
-    catch (olc::olc_exception& e) {
-        wcerr << e.msg().data() << endl;
-    }
-    return 0;
+#include "cmd_engine.h"
+#include "fov.h"
+#include "pathfinding.h"
+#include "script.h"
+#include "tilemap.h"
+#include <iostream>
+#include <memory_resource>
+#include <stack>
+#include <thread>
+#include <time.h>
+
+using namespace std;
+
+namespace olc
+{
+    constexpr int g_maze_w = 40;
+    constexpr int g_maze_h = 25;
+    constexpr int g_cell_w = 3;
+    constexpr int pixel_offset_x = 1;
+    constexpr int pixel_offset_y = 1;
+    constexpr int g_window_w = g_maze_w * (g_cell_w + 1) + pixel_offset_x;	// cell true width + wall = g_cell_w + 1
+    constexpr int g_window_h = g_maze_h * (g_cell_w + 1) + pixel_offset_y;	// cell true height + wall = g_cell_w + 1
+    constexpr int g_torch_count = 12;
+    constexpr int g_torch_radius = 12;
+
+    class maze : public olc::cmd_engine
+    {
+    private:
+        struct cell_attrib
+        {
+            enum enum_t
+            {
+                path_n = 0x01,
+                path_e = 0x02,
+                path_s = 0x04,
+                path_w = 0x08,
+                visited = 0x10,
+                solved = 0x20,
+            };
+        };
+
+        struct direction
+        {
+            enum enum_t
+            {
+                N, E, S, W,
+            };
+        };
+
+        // tile ids in _map, empty is the black wall
+        struct tile
+        {
+            enum enum_t : tilemap::tile_id
+            {
+                empty, blue, white, red, cyan,
+            };
+        };
+
+    public:
+        maze()
+            : _maze_w{ g_maze_w }
+            , _maze_h{ g_maze_h }
+            , _cell_w{ g_cell_w }
+            , _maze(_maze_w * _maze_h, 0)
+            , _solve_maze(_maze_w* _maze_h, 0)
+            , _map{ g_window_w, g_window_h }
+            , _walkable{ g_window_w, g_window_h }
+        {
+            _app_name = L"Maze";
+            // once solved the maze doesn't change anymore, no need to spin
+            set_idle_tick(100ms);
+        }
+
+        // Inherited via cmd_engine
+        virtual bool on_user_init() override
+        {
+            srand(time(nullptr));
+            _stack.emplace(0, 0);
+            _maze[0] = cell_attrib::visited;
+            _solve_stack.emplace(0, 0);
+            _solve_maze[0] = cell_attrib::visited | cell_attrib::solved;
+
+            _map.define_tile(tile::blue, pixel_type::solid, color_t::blue);
+            _map.define_tile(tile::white, pixel_type::solid, color_t::white);
+            _map.define_tile(tile::red, pixel_type::solid, color_t::red);
+            _map.define_tile(tile::cyan, pixel_type::solid, color_t::cyan);
+            for (int y = 0; y < _maze_h; ++y) {
+                for (int x = 0; x < _maze_w; ++x) {
+                    paint_cell(x, y);
+                }
+            }
+            scripts().spawn(animate());
+            return true;
+        }
+
+        virtual bool on_user_update(float elapsed) override
+        {
+            // the maze is advanced by the animate() script, which has run by now
+            if (_solved && get_key(L'L').pressed) {
+                toggle_lights();
+            }
+            if (_lights_out) {
+                wander_torches();
+                _light.update();
+                draw_lit();
+            }
+            else {
+                _map.render(*this, _camera);
+            }
+            if (_solved) {
+                // once solved, the shortest way from the entrance to the mouse
+                grid_point entrance{ pixel_offset_x, pixel_offset_y };
+                if (_paths.find_path_jps(entrance, { get_mouse_x(), get_mouse_y() }, _path)) {
+                    for (auto p : _path) {
+                        draw(p.x, p.y, pixel_type::solid, color_t::yellow);
+                    }
+                }
+            }
+            return true;
+        }
+
+    private:
+        // one step of generating, then one step of solving every frame until the end is reached
+        script animate()
+        {
+            while (!_stack.empty()) {
+                auto prev_top = stack_top(_stack);
+                step_generate();
+                // a step only changes the cells around the old and new top of the stack, repaint just those tiles
+                paint_around(prev_top);
+                paint_around(stack_top(_stack));
+                co_await next_frame();
+            }
+            while (!_solve_stack.empty()) {
+                auto prev_top = stack_top(_solve_stack);
+                step_solve();
+                paint_around(prev_top);
+                paint_around(stack_top(_solve_stack));
+                co_await next_frame();
+            }
+            // everything but the walls can be walked
+            for (int y = 0; y < g_window_h; ++y) {
+                for (int x = 0; x < g_window_w; ++x) {
+                    _walkable.set_passable(x, y, _map.get(x, y) != tile::empty);
+                }
+            }
+            _solved = true;
+        }
+
+        void step_generate()
+        {
+            // transient, lives in the frame arena so stepping the maze doesn't hit the heap
+            pmr::vector<direction::enum_t> neighbours{ frame_resource() };
+            neighbours.reserve(4);
+            auto [curr_x, curr_y] = _stack.top();
+            if (curr_y > 0 && (_maze[index(curr_x, curr_y - 1)] & cell_attrib::visited) == 0) {
+                neighbours.push_back(direction::N);
+            }
+            if (curr_x < _maze_w - 1 && (_maze[index(curr_x + 1, curr_y)] & cell_attrib::visited) == 0) {
+                neighbours.push_back(direction::E);
+            }
+            if (curr_y < _maze_h - 1 && (_maze[index(curr_x, curr_y + 1)] & cell_attrib::visited) == 0) {
+                neighbours.push_back(direction::S);
+            }
+            if (curr_x > 0 && (_maze[index(curr_x - 1, curr_y)] & cell_attrib::visited) == 0) {
+                neighbours.push_back(direction::W);
+            }
+
+            if (!neighbours.empty()) {
+                // move to next neighbour
+                direction::enum_t next_dir = neighbours[rand() % neighbours.size()];
+                // create path between the curr cell and neighbour
+                switch (next_dir) {
+                case direction::N:
+                    _maze[index(curr_x, curr_y)] |= cell_attrib::path_n;
+                    _maze[index(curr_x, curr_y - 1)] |= cell_attrib::path_s | cell_attrib::visited;
+                    _stack.emplace(curr_x, curr_y - 1);
+                    break;
+                case direction::E:
+                    _maze[index(curr_x, curr_y)] |= cell_attrib::path_e;
+                    _maze[index(curr_x + 1, curr_y)] |= cell_attrib::path_w | cell_attrib::visited;
+                    _stack.emplace(curr_x + 1, curr_y);
+                    break;
+                case direction::S:
+                    _maze[index(curr_x, curr_y)] |= cell_attrib::path_s;
+                    _maze[index(curr_x, curr_y + 1)] |= cell_attrib::path_n | cell_attrib::visited;
+                    _stack.emplace(curr_x, curr_y + 1);
+                    break;
+                case direction::W:
+                    _maze[index(curr_x, curr_y)] |= cell_attrib::path_w;
+                    _maze[index(curr_x - 1, curr_y)] |= cell_attrib::path_e | cell_attrib::visited;
+                    _stack.emplace(curr_x - 1, curr_y);
+                    break;
+                }
+            }
+            else {
+                // no more neighbour, pop
+                _stack.pop();
+            }
+        }
+
+        void step_solve()
+        {
+            auto has_path = [this](int x, int y, direction::enum_t dir) {
+                cell_attrib::enum_t dir_val;
+                switch (dir) {
+                case direction::N:
+                    dir_val = cell_attrib::path_n;
+                    break;
+                case direction::E:
+                    dir_val = cell_attrib::path_e;
+                    break;
+                case direction::S:
+                    dir_val = cell_attrib::path_s;
+                    break;
+                case direction::W:
+                    dir_val = cell_attrib::path_w;
+                    break;
+                }
+                return (_maze[index(x, y)] & dir_val) != 0;
+            };
+            // transient, lives in the frame arena so stepping the maze doesn't hit the heap
+            pmr::vector<direction::enum_t> neighbours{ frame_resource() };
+            neighbours.reserve(4);
+            auto [curr_x, curr_y] = _solve_stack.top();
+            if (curr_y > 0 && (_solve_maze[index(curr_x, curr_y - 1)] & cell_attrib::visited) == 0 &&
+                has_path(curr_x, curr_y, direction::N)) {
+                neighbours.push_back(direction::N);
+            }
+            if (curr_x < _maze_w - 1 && (_solve_maze[index(curr_x + 1, curr_y)] & cell_attrib::visited) == 0 &&
+                has_path(curr_x, curr_y, direction::E)) {
+                neighbours.push_back(direction::E);
+            }
+            if (curr_y < _maze_h - 1 && (_solve_maze[index(curr_x, curr_y + 1)] & cell_attrib::visited) == 0 &&
+                has_path(curr_x, curr_y, direction::S)) {
+                neighbours.push_back(direction::S);
+            }
+            if (curr_x > 0 && (_solve_maze[index(curr_x - 1, curr_y)] & cell_attrib::visited) == 0 &&
+                has_path(curr_x, curr_y, direction::W)) {
+                neighbours.push_back(direction::W);
+            }
+
+            if (!neighbours.empty()) {
+                // move to next neighbour
+                direction::enum_t next_dir = neighbours[rand() % neighbours.size()];
+                // create path between the curr cell and neighbour
+                switch (next_dir) {
+                case direction::N:
+                    _solve_maze[index(curr_x, curr_y)] |= cell_attrib::path_n;
+                    _solve_maze[index(curr_x, curr_y - 1)] |= cell_attrib::path_s | cell_attrib::visited | cell_attrib::solved;
+                    _solve_stack.emplace(curr_x, curr_y - 1);
+                    break;
+                case direction::E:
+                    _solve_maze[index(curr_x, curr_y)] |= cell_attrib::path_e;
+                    _solve_maze[index(curr_x + 1, curr_y)] |= cell_attrib::path_w | cell_attrib::visited | cell_attrib::solved;
+                    _solve_stack.emplace(curr_x + 1, curr_y);
+                    break;
+                case direction::S:
+                    _solve_maze[index(curr_x, curr_y)] |= cell_attrib::path_s;
+                    _solve_maze[index(curr_x, curr_y + 1)] |= cell_attrib::path_n | cell_attrib::visited | cell_attrib::solved;
+                    _solve_stack.emplace(curr_x, curr_y + 1);
+                    break;
+                case direction::W:
+                    _solve_maze[index(curr_x, curr_y)] |= cell_attrib::path_w;
+                    _solve_maze[index(curr_x - 1, curr_y)] |= cell_attrib::path_e | cell_attrib::visited | cell_attrib::solved;
+                    _solve_stack.emplace(curr_x - 1, curr_y);
+                    break;
+                }
+
+                if (auto [dest_x, dest_y] = _solve_stack.top(); dest_x == _maze_w - 1 && dest_y == _maze_h - 1) {
+                    // reached the end, we solved the maze, empty the stack
+                    _solve_stack = {};
+                }
+            }
+            else {
+                // no more neighbour, pop
+                // mark it as not solved
+                _solve_stack.pop();
+                _solve_maze[index(curr_x, curr_y)] &= ~cell_attrib::solved;
+            }
+        }
+
+        // once solved, L puts the lights out and leaves a few torches wandering the maze
+        void toggle_lights()
+        {
+            _lights_out = !_lights_out;
+            if (!_torches.empty()) {
+                return;
+            }
+            const light_color colors[] = {
+                { 1.0f, 0.6f, 0.2f }, { 0.3f, 0.5f, 1.0f }, { 0.3f, 1.0f, 0.4f }, { 1.0f, 0.3f, 0.8f },
+            };
+            while (_torches.size() < g_torch_count) {
+                grid_point at{ rand() % g_window_w, rand() % g_window_h };
+                if (_walkable.passable(at.x, at.y)) {
+                    auto color = colors[_torches.size() % size(colors)];
+                    _torches.push_back({ _light.add(at, g_torch_radius, color), at, { 0, 0 } });
+                }
+            }
+        }
+
+        // each torch keeps going until it hits a wall, then turns a random way it can go
+        void wander_torches()
+        {
+            constexpr grid_point headings[] = { { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 } };
+            for (auto& t : _torches) {
+                if (!_walkable.passable(t.at.x + t.heading.x, t.at.y + t.heading.y) || t.heading == grid_point{ 0, 0 } || rand() % 16 == 0) {
+                    t.heading = headings[rand() % size(headings)];
+                }
+                grid_point next{ t.at.x + t.heading.x, t.at.y + t.heading.y };
+                if (_walkable.passable(next.x, next.y)) {
+                    t.at = next;
+                    _light.move(t.id, next);
+                }
+            }
+        }
+
+        void draw_lit()
+        {
+            for (int y = 0; y < g_window_h; ++y) {
+                for (int x = 0; x < g_window_w; ++x) {
+                    wchar_t glyph{ L' ' };
+                    short color{ color_t::fg_black };
+                    if (_walkable.passable(x, y)) {
+                        _light.shade(x, y, glyph, color);
+                    }
+                    draw(x, y, glyph, color);
+                }
+            }
+        }
+
+        int index(int x, int y) const
+        {
+            return y * _maze_w + x;
+        }
+
+        static pair<int, int> stack_top(const stack<pair<int, int>>& s)
+        {
+            return s.empty() ? pair<int, int>(-1, -1) : s.top();
+        }
+
+        // a cell's own tiles plus its south and east walls, whose colors also depend on the neighbour
+        void paint_cell(int x, int y)
+        {
+            if (x < 0 || x >= _maze_w || y < 0 || y >= _maze_h) {
+                return;
+            }
+            int cell_plus_wall_w = _cell_w + 1;
+            int cell = _maze[y * _maze_w + x];
+            int solve_cell = _solve_maze[y * _maze_w + x];
+            // current cell = red, visited = white, non visited = blue, solved = cyan
+            tile::enum_t cell_tile{ tile::red };
+            if (stack_top(_stack) != pair<int, int>(x, y)) {
+                if (solve_cell & cell_attrib::solved) {
+                    cell_tile = tile::cyan;
+                }
+                else {
+                    cell_tile = (cell & cell_attrib::visited) ? tile::white : tile::blue;
+                }
+            }
+            int left = x * cell_plus_wall_w + pixel_offset_x;
+            int top = y * cell_plus_wall_w + pixel_offset_y;
+            for (int py = 0; py < _cell_w; ++py) {
+                for (int px = 0; px < _cell_w; ++px) {
+                    _map.set(left + px, top + py, cell_tile);
+                }
+            }
+            // draw paths, if there is a path, fill in white/cyan at the wall pixel to "break" the wall
+            for (int p = 0; p < _cell_w; ++p) {
+                if (cell & cell_attrib::path_s) {
+                    tile::enum_t wall_tile = (solve_cell & cell_attrib::path_s && _solve_maze[(y + 1) * _maze_w + x] & cell_attrib::solved) ? tile::cyan : tile::white;
+                    _map.set(left + p, top + _cell_w, wall_tile);
+                }
+                if (cell & cell_attrib::path_e) {
+                    tile::enum_t wall_tile = (solve_cell & cell_attrib::path_e && _solve_maze[y * _maze_w + x + 1] & cell_attrib::solved) ? tile::cyan : tile::white;
+                    _map.set(left + _cell_w, top + p, wall_tile);
+                }
+            }
+        }
+
+        // the cells whose walls touch (x, y)
+        void paint_around(pair<int, int> cell)
+        {
+            auto [x, y] = cell;
+            paint_cell(x, y);
+            paint_cell(x - 1, y);
+            paint_cell(x, y - 1);
+        }
+
+        const int _maze_w;
+        const int _maze_h;
+        const int _cell_w;  // excluding wall of 1 pixel
+        vector<int> _maze;
+        stack<pair<int, int>> _stack;
+        vector<int> _solve_maze;
+        stack<pair<int, int>> _solve_stack;
+        // the maze as drawn, only the tiles of cells that changed are repainted each step
+        tilemap _map;
+        camera _camera;
+        // the drawn maze as walls and floor, for paths to the mouse once solved
+        grid_map _walkable;
+        path_finder _paths{ _walkable };
+        vector<grid_point> _path;
+        bool _solved{ false };
+        // lights out mode, the floor lit only by torches that see along the corridors
+        struct torch
+        {
+            light_map::light_id id;
+            grid_point at;
+            grid_point heading;
+        };
+        light_map _light{ _walkable };
+        vector<torch> _torches;
+        bool _lights_out{ false };
+    };
+}
+
+int main()
+{
+    try {
+        olc::maze maze{};
+        maze.construct_console(olc::g_window_w, olc::g_window_h, 8, 8);
+        maze.start();
+    }
+    catch (olc::olc_exception& e) {
+        wcerr << e.msg().data() << endl;
+    }
+    return 0;
 }
\ No newline at end of file
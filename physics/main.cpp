@@ -0,0 +1,186 @@
+#include "cmd_engine.h"
+#include "physics.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <time.h>
+#include <vector>
+
+using namespace std;
+
+namespace olc
+{
+	constexpr int g_screen_w = 200;
+	constexpr int g_screen_h = 120;
+	constexpr int g_start_bodies = 400;
+
+	//
+	// Circles and polygons poured into a box. Left click drops a body at the mouse, right click a handful, J toggles
+	// solving the islands on the job system. The box follows the console window when it's resized.
+	//
+	class physics_sample : public cmd_engine
+	{
+	public:
+		physics_sample()
+		{
+			_app_name = L"Physics";
+		}
+
+		// Inherited via cmd_engine
+		virtual bool on_user_init() override
+		{
+			srand(static_cast<unsigned>(time(nullptr)));
+			_world.set_gravity(0.0f, 30.0f);
+			build_box();
+
+			float w = static_cast<float>(width());
+			float h = static_cast<float>(height());
+			for (int i = 0; i < g_start_bodies; ++i) {
+				spawn(random(4.0f, w - 4.0f), random(4.0f, h * 0.3f));
+			}
+			return true;
+		}
+
+		virtual void on_resize(int w, int h) override
+		{
+			// the box is rebuilt around the new size, bodies it leaves outside are dropped
+			auto dropped = remove_if(_bodies.begin(), _bodies.end(), [&](const body& b) {
+				float x = _world.x(b.id);
+				float y = _world.y(b.id);
+				if (!_world.is_static(b.id) && x >= 2.0f && x <= w - 2.0f && y <= h - 2.0f) {
+					return false;
+				}
+				_world.remove(b.id);
+				return true;
+			});
+			_bodies.erase(dropped, _bodies.end());
+			build_box();
+		}
+
+		virtual bool on_user_update(float elapsed) override
+		{
+			if (get_key(VK_ESCAPE).pressed) {
+				return false;
+			}
+			float mx = static_cast<float>(get_mouse_x());
+			float my = static_cast<float>(get_mouse_y());
+			if (get_mouse(0).pressed) {
+				spawn(mx, my);
+			}
+			if (get_mouse(1).pressed) {
+				for (int i = 0; i < 20; ++i) {
+					spawn(mx + random(-8.0f, 8.0f), my + random(-8.0f, 8.0f));
+				}
+			}
+			if (get_key(L'J').pressed) {
+				_parallel = !_parallel;
+				_world.set_job_system(_parallel ? &jobs() : nullptr);
+			}
+
+			auto t0 = chrono::steady_clock::now();
+			int steps = _world.update(elapsed);
+			if (steps > 0) {
+				float ms = chrono::duration<float, milli>(chrono::steady_clock::now() - t0).count() / steps;
+				// smoothed so it can be read
+				_step_ms += (ms - _step_ms) * 0.1f;
+			}
+
+			fill(0, 0, width() - 1, height() - 1, L' ', color_t::fg_black);
+			for (const auto& b : _bodies) {
+				float x = _world.x(b.id);
+				float y = _world.y(b.id);
+				float a = _world.angle(b.id);
+				if (_world.type(b.id) == shape_type::circle) {
+					float r = _world.radius(b.id);
+					draw_circle(static_cast<int>(x), static_cast<int>(y), static_cast<int>(r + 0.5f), pixel_type::solid, b.color);
+					// a spoke to see it roll
+					draw_line(static_cast<int>(x), static_cast<int>(y), static_cast<int>(x + cosf(a) * r), static_cast<int>(y + sinf(a) * r),
+						pixel_type::solid, b.color);
+				}
+				else {
+					draw_wire_polygon(_world.shape(b.id), x, y, a, 1.0f, pixel_type::solid, b.color);
+				}
+			}
+			// formatted into a stack buffer so there's no string allocation every frame
+			wchar_t text[128];
+			swprintf_s(text, L"bodies %zu  contacts %zu  islands %zu  step %.2f ms  [J] parallel %ls", _world.size(),
+				_world.contact_count(), _world.island_count(), _step_ms, _parallel ? L"on" : L"off");
+			draw_string(3, 1, text);
+			return true;
+		}
+
+	private:
+		struct body
+		{
+			physics_world::body_id id;
+			short color;
+		};
+
+		static float random(float lo, float hi)
+		{
+			return lo + (hi - lo) * (rand() / static_cast<float>(RAND_MAX));
+		}
+
+		void add_static(const physics_world::model& shape, float x, float y, float angle)
+		{
+			_bodies.push_back({ _world.add_polygon(shape, x, y, angle, 0.0f), color_t::fg_grey });
+		}
+
+		// the box, and two shelves for things to slide off
+		void build_box()
+		{
+			float w = static_cast<float>(width());
+			float h = static_cast<float>(height());
+			add_static({ { 0.0f, 0.0f }, { w, 0.0f }, { w, 2.0f }, { 0.0f, 2.0f } }, 0.0f, h - 2.0f, 0.0f);
+			add_static({ { 0.0f, 0.0f }, { 2.0f, 0.0f }, { 2.0f, h }, { 0.0f, h } }, 0.0f, 0.0f, 0.0f);
+			add_static({ { 0.0f, 0.0f }, { 2.0f, 0.0f }, { 2.0f, h }, { 0.0f, h } }, w - 2.0f, 0.0f, 0.0f);
+			add_static({ { 0.0f, 0.0f }, { 60.0f, 0.0f }, { 60.0f, 2.0f }, { 0.0f, 2.0f } }, 20.0f, h * 0.4f, 0.2f);
+			add_static({ { 0.0f, 0.0f }, { 60.0f, 0.0f }, { 60.0f, 2.0f }, { 0.0f, 2.0f } }, w - 80.0f, h * 0.55f, -0.2f);
+		}
+
+		// a random circle, box, triangle or hexagon
+		void spawn(float x, float y)
+		{
+			const short colors[] = { color_t::fg_cyan, color_t::fg_yellow, color_t::fg_magenta, color_t::fg_green, color_t::fg_red };
+			float r = random(1.0f, 2.5f);
+			physics_world::model shape;
+			switch (rand() % 4) {
+			case 0:
+				_bodies.push_back({ _world.add_circle(x, y, r), colors[rand() % size(colors)] });
+				return;
+			case 1:
+				shape = { { -r, -r }, { r, -r }, { r, r }, { -r, r } };
+				break;
+			case 2:
+				shape = { { 0.0f, -r }, { r, r }, { -r, r } };
+				break;
+			default:
+				for (int i = 0; i < 6; ++i) {
+					shape.emplace_back(cosf(i * 1.0472f) * r, sinf(i * 1.0472f) * r);
+				}
+				break;
+			}
+			_bodies.push_back({ _world.add_polygon(shape, x, y, random(0.0f, 6.28f)), colors[rand() % size(colors)] });
+		}
+
+		physics_world _world;
+		vector<body> _bodies;
+		bool _parallel{ false };
+		float _step_ms{ 0.0f };
+	};
+}
+
+int main()
+{
+	try {
+		olc::physics_sample sample{};
+		sample.set_resizable(true);
+		sample.construct_console(olc::g_screen_w, olc::g_screen_h, 6, 6);
+		sample.start();
+	}
+	catch (olc::olc_exception& e) {
+		wcerr << e.msg().data() << endl;
+	}
+	return 0;
+}
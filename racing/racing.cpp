@@ -1,273 +1,370 @@
-#include "cmd_engine.h"
-#include <list>
-#include <string>
-#include <array>
-
-using namespace std;
-
-constexpr auto g_screen_width = 160;
-constexpr auto g_screen_height = 100;
-constexpr auto g_car_y = 80;
-constexpr auto g_car_w = 14;
-
-
-namespace olc {
-    struct track_section
-    {
-        float curvature;
-        float dist;
-
-        track_section(float curv, float dist) : curvature{ curv }, dist{ dist } {}
-    };
-
-    class racing : public cmd_engine {
-    private:
-        float _car_pos = 0.0f;
-        float _car_dist = 0.0f;
-        float _car_speed = 0.0f;
-
-        float _curvature = 0.0f;
-
-        float _track_curv_accum = 0.0f;
-        float _car_curv_accum = 0.0f;
-
-        // when reach 1, passed a lap
-        int _lap_progress = 0;
-        float _lap_time = 0.0f;
-        list<float> _lap_time_hist{};
-
-        vector<track_section> _track{};
-        float _track_dist_total = 0.0f;
-
-    public:
-        racing() : _lap_time_hist(5, 0.0f) {
-            _app_name = L"Classic Racing";
-        }
-
-        // Inherited via cmd_engine
-        virtual bool on_user_init() override
-        {
-            _track.emplace_back(0.0f, 10.0f);    // short section for start/finish
-            _track.emplace_back(0.0f, 200.0f);
-            _track.emplace_back(1.0f, 200.0f);
-            _track.emplace_back(0.0f, 400.0f);
-            _track.emplace_back(-1.0f, 200.0f);
-            _track.emplace_back(0.0f, 200.0f);
-            _track.emplace_back(-1.0f, 200.0f);
-            _track.emplace_back(1.0f, 200.0f);
-            _track.emplace_back(0.0f, 200.0f);
-            _track.emplace_back(0.2f, 500.0f);
-            _track.emplace_back(0.0f, 200.0f);
-            
-            for (const auto& section : _track) {
-                _track_dist_total += section.dist;
-            }
-
-	        return true;
-        }
-
-        virtual bool on_user_update(float elapsed) override
-        {
-            constexpr int dir_neutral = 0;
-            constexpr int dir_right = 1;
-            constexpr int dir_left = 2;
-
-            int car_dir = dir_neutral;
-
-            if (get_key(VK_UP).held) {
-                _car_speed += 2.5f * elapsed;
-            }
-            else if (get_key(VK_DOWN).held) {
-                _car_speed -= 2.0f * elapsed;
-            }
-            else {
-                if (_car_speed > 0.0f) {
-                    _car_speed = fmaxf(0.0f, _car_speed - 1.0f * elapsed);
-                }
-                else {
-                    _car_speed = fminf(0.0f, _car_speed + 1.0f * elapsed);
-                }
-            }
-
-            if (get_key(VK_RIGHT).held) {
-                _car_curv_accum += 0.7f * elapsed;
-                car_dir = dir_right;
-            }
-            else if (get_key(VK_LEFT).held) {
-                _car_curv_accum -= 0.7f * elapsed;
-                car_dir = dir_left;
-            }
-
-            if (fabs(_car_curv_accum - _track_curv_accum) >= 0.8f) {
-                if (_car_speed > 0.0f) {
-                    _car_speed = fmaxf(0.0f, _car_speed - 5.0f * elapsed);
-                }
-                else {
-                    _car_speed = fminf(0.0f, _car_speed + 5.0f * elapsed);
-                }
-            }
-
-            _car_speed = std::clamp(_car_speed, -1.0f, 1.5f);
-            
-            _car_dist += 70.0f * _car_speed * elapsed;
-            if (_car_dist >= _track_dist_total) {
-                ++_lap_progress;
-                _car_dist -= _track_dist_total;
-            }
-            else if (_car_dist < 0) {
-                --_lap_progress;
-                _car_dist += _track_dist_total;
-            }
-
-            if (_lap_progress == 1) {
-                _lap_time_hist.push_front(_lap_time);
-                _lap_time_hist.pop_back();
-                _lap_time = 0.0f;
-                _lap_progress = 0;
-            }
-            _lap_time += elapsed;
-
-            // get point on track
-            int track_section = 0;
-            float track_dist = _track[0].dist;
-            auto car_dist_on_track = fmod(_car_dist, _track_dist_total);
-
-            while (track_section < _track.size() && track_dist <= car_dist_on_track) {
-                ++track_section;
-                track_dist += _track[track_section].dist;
-            }
-
-            float target_curvature = _track[track_section].curvature;
-            // gradually change curvature to target curvature over 1 sec
-            _curvature += (target_curvature - _curvature) * elapsed * abs(_car_speed);
-            _track_curv_accum += _curvature * elapsed * abs(_car_speed);
-
-            // draw sky
-            for (auto y = 0; y < height() / 2; ++y) {
-                for (auto x = 0; x < width(); ++x) {
-                    draw(x, y, y < height() / 4 ? pixel_type::half : pixel_type::solid, color_t::fg_dark_blue);
-                }
-            }
-
-            // draw scenary - our hills are a rectified sine wave where phase is adjusted by accumulated track curvature
-            for (auto x = 0; x < width(); ++x) {
-                int hill_height = static_cast<int>(fabs(sinf(x * 0.01f - _track_curv_accum) * 16.0f));
-                for (auto y = height() / 2 - hill_height; y < height() / 2; ++y) {
-                    draw(x, y, pixel_type::solid, color_t::fg_dark_yellow);
-                }
-            }
-
-            // draw road
-            for (auto y = 0; y < height() / 2; ++y) {
-                // bottom of the screen is for the road
-
-                auto perspective = (float)y / (height() / 2.0f);
-
-                // 20.0f - determines the number of strips for the grass, the larger, the more strips
-                // powf exponent - determines how drastically the height of the grass strips are based on view dist,
-                //                 the higher the exp, the more dramatic
-                // -0.1f * _car_dist - controls the phase of scrolling for the strips
-                // sine function - makes the strip runs in periodic manner
-                auto grass_color = sinf(20.0f * powf(perspective - 1, 3.0f) - 0.1f * _car_dist) >= 0.0f ? color_t::fg_dark_green : color_t::fg_green;
-                auto clip_color = sinf(80.0f * powf(perspective - 1, 2.0f) + _car_dist) >= 0.0f ? color_t::fg_red : color_t::fg_white;
-                auto road_color = color_t::fg_grey;
-                if (track_section == 0) {
-                    // at the start/finish line
-                    road_color = sinf(60.0f * powf(perspective - 1, 2.0f) + _car_dist) >= 0.0f ? color_t::fg_white : color_t::fg_dark_grey;
-                }
-
-                for (auto x = 0; x < width(); ++x) {
-
-                    auto mid_pt = 0.5f + _curvature * powf(1.0f - perspective, 3.0f);
-                    // 0.1f is min width at the top and 0.9f is the max width at the bottom
-                    auto road_w = 0.1f + perspective * 0.8f;
-                    auto clip_w = road_w * 0.15f;
-
-                    road_w *= 0.5f;
-
-                    int grass_left_end = static_cast<int>((mid_pt - road_w - clip_w) * width());
-                    int clip_left_end = static_cast<int>((mid_pt - road_w) * width());
-                    int clip_right_start = static_cast<int>((mid_pt + road_w) * width());
-                    int grass_right_start = static_cast<int>((mid_pt + road_w + clip_w) * width());
-
-
-                    int row = height() / 2 + y;
-                    if (x < grass_left_end || x >= grass_right_start) {
-                        draw(x, row, pixel_type::solid, grass_color);
-                    }
-                    else if (x < clip_left_end || x >= clip_right_start) {
-                        draw(x, row, pixel_type::solid, clip_color);
-                    }
-                    else {
-                        draw(x, row, pixel_type::solid, road_color);
-                    }
-                }
-            }
-
-            // draw car
-            _car_pos = _car_curv_accum - _track_curv_accum;
-            int car_x = width() / 2 + static_cast<int>(_car_pos * width() / 2.0f) - g_car_w / 2;
-            int car_y = g_car_y;
-            switch (car_dir) {
-            case dir_neutral:
-                draw_string_alpha(car_x, car_y++, L"   ||####||   ");
-                draw_string_alpha(car_x, car_y++, L"      ##      ");
-                draw_string_alpha(car_x, car_y++, L"     ####     ");
-                draw_string_alpha(car_x, car_y++, L"     ####     ");
-                draw_string_alpha(car_x, car_y++, L"|||  ####  |||");
-                draw_string_alpha(car_x, car_y++, L"|||########|||");
-                draw_string_alpha(car_x, car_y++, L"|||  ####  |||");
-                break;
-            case dir_right:
-                draw_string_alpha(car_x, car_y++, L"      //####//");
-                draw_string_alpha(car_x, car_y++, L"         ##   ");
-                draw_string_alpha(car_x, car_y++, L"       ####   ");
-                draw_string_alpha(car_x, car_y++, L"      ####    ");
-                draw_string_alpha(car_x, car_y++, L"///  ####//// ");
-                draw_string_alpha(car_x, car_y++, L"//#######///O ");
-                draw_string_alpha(car_x, car_y++, L"/// #### //// ");
-                break;
-            case dir_left:
-                draw_string_alpha(car_x, car_y++, LR"(\\####\\      )");
-                draw_string_alpha(car_x, car_y++, LR"(   ##         )");
-                draw_string_alpha(car_x, car_y++, LR"(   ####       )");
-                draw_string_alpha(car_x, car_y++, LR"(    ####      )");
-                draw_string_alpha(car_x, car_y++, LR"( \\\\####  \\\)");
-                draw_string_alpha(car_x, car_y++, LR"( O\\\#######\\)");
-                draw_string_alpha(car_x, car_y++, LR"( \\\\ #### \\\)");
-                break;
-            }
-
-            // draw stats
-            int stats_y = 0;
-            draw_string(0, stats_y++, L"Distance: " + to_wstring(_car_dist));
-            draw_string(0, stats_y++, L"Target Curvature: " + to_wstring(target_curvature));
-            draw_string(0, stats_y++, L"Current Track Curvature: " + to_wstring(_curvature));
-            draw_string(0, stats_y++, L"Track Curvature Accum: " + to_wstring(_track_curv_accum));
-            draw_string(0, stats_y++, L"Car Curvature Accum: " + to_wstring(_car_curv_accum));
-            draw_string(0, stats_y++, L"Car Speed: " + to_wstring(_car_speed));
-            draw_string(0, stats_y++, L"Lap progress: " + to_wstring(_lap_progress + _car_dist / _track_dist_total));
-
-            auto time2string = [](float t) {
-                int min = static_cast<int>(t / 60.0f);
-                t -= min * 60.0f;
-                int sec = static_cast<int>(t);
-                int ms = static_cast<int>((t - (float)sec) * 1000.0f);
-                return to_wstring(min) + L":" + to_wstring(sec) + L"." + to_wstring(ms);
-            };
-            draw_string(10, 8, time2string(_lap_time));
-            stats_y = 10;
-            for (auto lt : _lap_time_hist) {
-                draw_string(10, stats_y++, time2string(lt));
-            }
-
-	        return true;
-        }
-    };
-}
-
-int main() {
-    olc::racing game{};
-    game.construct_console(160, 100, 8, 8);
-    game.start();
+#include "fixed_cmd_engine.h"
+#include "job_system.h"
+#include "font.h"
+#include "audio.h"
+#include "noise.h"
+#include <string>
+#include <array>
+
+using namespace std;
+
+constexpr auto g_screen_width = 160;
+constexpr auto g_screen_height = 100;
+constexpr auto g_car_y = 80;
+constexpr auto g_car_w = 14;
+// about 10 seconds
+constexpr auto g_rewind_frames = 600;
+
+
+namespace olc {
+    struct track_section
+    {
+        float curvature;
+        float dist;
+
+        track_section(float curv, float dist) : curvature{ curv }, dist{ dist } {}
+    };
+
+    class racing : public fixed_cmd_engine<g_screen_width, g_screen_height> {
+    private:
+        struct car_dir
+        {
+            enum enum_t
+            {
+                neutral, right, left,
+            };
+        };
+
+        // everything that changes as the race goes on, plain data so it can be snapshotted for rewind
+        struct race_state
+        {
+            float car_pos = 0.0f;
+            float car_dist = 0.0f;
+            float car_speed = 0.0f;
+
+            float curvature = 0.0f;
+
+            float track_curv_accum = 0.0f;
+            float car_curv_accum = 0.0f;
+
+            // when reach 1, passed a lap
+            int lap_progress = 0;
+            float lap_time = 0.0f;
+            // latest first
+            array<float, 5> lap_time_hist{};
+        };
+
+        race_state _race{};
+
+        vector<track_section> _track{};
+        float _track_dist_total = 0.0f;
+
+        // big digits for the current lap time
+        font _font{};
+
+        // the race at the start of each of the last g_rewind_frames frames, holding backspace steps back through them
+        vector<snapshot> _rewind;
+        int _rewind_head = 0;
+        int _rewind_count = 0;
+
+        // a low tone fading out every tenth of a second, looped it putters like an engine
+        sound _engine_sound = sound::tone(55.0f, 0.1f);
+        sound _lap_sound = sound::tone(880.0f, 0.4f);
+        audio_mixer::voice_id _engine_voice = 0;
+
+        // hills along the horizon and clouds drifting over them, both scroll with the accumulated track curvature
+        noise _noise{ 2019 };
+        vector<float> _hills;
+        vector<float> _clouds;
+        float _cloud_time = 0.0f;
+
+        // where the road, its clips and the grass are on each row below the horizon this frame
+        struct road_row
+        {
+            int grass_left_end;
+            int clip_left_end;
+            int clip_right_start;
+            int grass_right_start;
+            short grass_color;
+            short clip_color;
+            short road_color;
+        };
+        array<road_row, g_screen_height / 2> _road_rows{};
+
+    public:
+        racing() : _rewind(g_rewind_frames), _hills(g_screen_width), _clouds(g_screen_width * g_screen_height / 2) {
+            _app_name = L"Classic Racing";
+            register_snapshot_state(&_race, sizeof(_race));
+        }
+
+        // Inherited via cmd_engine
+        virtual bool on_user_init() override
+        {
+            _track.emplace_back(0.0f, 10.0f);    // short section for start/finish
+            _track.emplace_back(0.0f, 200.0f);
+            _track.emplace_back(1.0f, 200.0f);
+            _track.emplace_back(0.0f, 400.0f);
+            _track.emplace_back(-1.0f, 200.0f);
+            _track.emplace_back(0.0f, 200.0f);
+            _track.emplace_back(-1.0f, 200.0f);
+            _track.emplace_back(1.0f, 200.0f);
+            _track.emplace_back(0.0f, 200.0f);
+            _track.emplace_back(0.2f, 500.0f);
+            _track.emplace_back(0.0f, 200.0f);
+            
+            for (const auto& section : _track) {
+                _track_dist_total += section.dist;
+            }
+
+            _engine_voice = audio().play(_engine_sound, 0.0f, 0.0f, true);
+
+            // every slot taken once, so filling the ring during the race doesn't allocate
+            for (auto& s : _rewind) {
+                save_snapshot(s, snapshot_part::state);
+            }
+
+	        return true;
+        }
+
+        virtual bool on_user_update(float elapsed) override
+        {
+            auto dir = car_dir::neutral;
+            if (get_key(VK_BACK).held && _rewind_count > 0) {
+                // a frame back every frame, the race plays backwards
+                _rewind_head = (_rewind_head + g_rewind_frames - 1) % g_rewind_frames;
+                --_rewind_count;
+                restore_snapshot(_rewind[_rewind_head]);
+            }
+            else {
+                save_snapshot(_rewind[_rewind_head], snapshot_part::state);
+                _rewind_head = (_rewind_head + 1) % g_rewind_frames;
+                _rewind_count = min(_rewind_count + 1, g_rewind_frames);
+                dir = drive(elapsed);
+            }
+            // idles quietly, louder with speed
+            audio().set_volume(_engine_voice, 0.2f + 0.4f * fabs(_race.car_speed));
+            int track_section = section_at(_race.car_dist);
+
+            // hills are a row of fractal value noise, the accumulated track curvature scrolls it. Clouds are 3D noise
+            // sliced at the time, so they change shape as they go; further than the hills so slower
+            _noise.fill(_hills.data(), width(), 1, -_race.track_curv_accum * 2.0f, 0.0f, 0.02f, noise_type::value, { 3 });
+            _cloud_time += elapsed;
+            _noise.fill(_clouds.data(), width(), height() / 2, -_race.track_curv_accum, 0.0f, _cloud_time * 0.2f, 0.04f,
+                noise_type::simplex, { 3 });
+
+            // draw sky, clouds and scenary
+            int horizon = height() / 2;
+            draw_shader(0, 0, width() - 1, horizon - 1, [&](int x, int y) {
+                int hill_height = static_cast<int>((_hills[x] * 0.5f + 0.5f) * 24.0f);
+                if (y >= horizon - hill_height) {
+                    return shader_cell{ pixel_type::solid, color_t::fg_dark_yellow };
+                }
+                // thinning out toward the horizon
+                float cloud = _clouds[y * width() + x] - static_cast<float>(y) / height();
+                if (cloud > 0.1f) {
+                    wchar_t glyph = cloud < 0.2f ? pixel_type::quarter : cloud < 0.3f ? pixel_type::half : pixel_type::threequarters;
+                    return shader_cell{ glyph, color_t::fg_grey | color_t::bg_dark_blue };
+                }
+                wchar_t glyph = y < height() / 4 ? pixel_type::half : pixel_type::solid;
+                return shader_cell{ glyph, color_t::fg_dark_blue };
+            });
+
+            // bottom of the screen is for the road, every row only depends on its perspective so it's worked out once
+            // for the row and the shader just picks the color for x
+            for (auto y = 0; y < horizon; ++y) {
+                auto perspective = (float)y / (height() / 2.0f);
+
+                // 20.0f - determines the number of strips for the grass, the larger, the more strips
+                // powf exponent - determines how drastically the height of the grass strips are based on view dist,
+                //                 the higher the exp, the more dramatic
+                // -0.1f * _race.car_dist - controls the phase of scrolling for the strips
+                // sine function - makes the strip runs in periodic manner
+                auto& row = _road_rows[y];
+                row.grass_color = sinf(20.0f * powf(perspective - 1, 3.0f) - 0.1f * _race.car_dist) >= 0.0f ? color_t::fg_dark_green : color_t::fg_green;
+                row.clip_color = sinf(80.0f * powf(perspective - 1, 2.0f) + _race.car_dist) >= 0.0f ? color_t::fg_red : color_t::fg_white;
+                row.road_color = color_t::fg_grey;
+                if (track_section == 0) {
+                    // at the start/finish line
+                    row.road_color = sinf(60.0f * powf(perspective - 1, 2.0f) + _race.car_dist) >= 0.0f ? color_t::fg_white : color_t::fg_dark_grey;
+                }
+
+                auto mid_pt = 0.5f + _race.curvature * powf(1.0f - perspective, 3.0f);
+                // 0.1f is min width at the top and 0.9f is the max width at the bottom
+                auto road_w = 0.1f + perspective * 0.8f;
+                auto clip_w = road_w * 0.15f;
+
+                road_w *= 0.5f;
+
+                row.grass_left_end = static_cast<int>((mid_pt - road_w - clip_w) * width());
+                row.clip_left_end = static_cast<int>((mid_pt - road_w) * width());
+                row.clip_right_start = static_cast<int>((mid_pt + road_w) * width());
+                row.grass_right_start = static_cast<int>((mid_pt + road_w + clip_w) * width());
+            }
+
+            // draw road
+            draw_shader(0, horizon, width() - 1, height() - 1, [&](int x, int y) {
+                const auto& row = _road_rows[y - horizon];
+                if (x < row.grass_left_end || x >= row.grass_right_start) {
+                    return shader_cell{ pixel_type::solid, row.grass_color };
+                }
+                if (x < row.clip_left_end || x >= row.clip_right_start) {
+                    return shader_cell{ pixel_type::solid, row.clip_color };
+                }
+                return shader_cell{ pixel_type::solid, row.road_color };
+            });
+
+            // draw car
+            _race.car_pos = _race.car_curv_accum - _race.track_curv_accum;
+            int car_x = width() / 2 + static_cast<int>(_race.car_pos * width() / 2.0f) - g_car_w / 2;
+            int car_y = g_car_y;
+            switch (dir) {
+            case car_dir::neutral:
+                draw_string_alpha(car_x, car_y++, L"   ||####||   ");
+                draw_string_alpha(car_x, car_y++, L"      ##      ");
+                draw_string_alpha(car_x, car_y++, L"     ####     ");
+                draw_string_alpha(car_x, car_y++, L"     ####     ");
+                draw_string_alpha(car_x, car_y++, L"|||  ####  |||");
+                draw_string_alpha(car_x, car_y++, L"|||########|||");
+                draw_string_alpha(car_x, car_y++, L"|||  ####  |||");
+                break;
+            case car_dir::right:
+                draw_string_alpha(car_x, car_y++, L"      //####//");
+                draw_string_alpha(car_x, car_y++, L"         ##   ");
+                draw_string_alpha(car_x, car_y++, L"       ####   ");
+                draw_string_alpha(car_x, car_y++, L"      ####    ");
+                draw_string_alpha(car_x, car_y++, L"///  ####//// ");
+                draw_string_alpha(car_x, car_y++, L"//#######///O ");
+                draw_string_alpha(car_x, car_y++, L"/// #### //// ");
+                break;
+            case car_dir::left:
+                draw_string_alpha(car_x, car_y++, LR"(\\####\\      )");
+                draw_string_alpha(car_x, car_y++, LR"(   ##         )");
+                draw_string_alpha(car_x, car_y++, LR"(   ####       )");
+                draw_string_alpha(car_x, car_y++, LR"(    ####      )");
+                draw_string_alpha(car_x, car_y++, LR"( \\\\####  \\\)");
+                draw_string_alpha(car_x, car_y++, LR"( O\\\#######\\)");
+                draw_string_alpha(car_x, car_y++, LR"( \\\\ #### \\\)");
+                break;
+            }
+
+            // draw stats, formatted into a stack buffer so there's no string allocation every frame
+            wchar_t text[64];
+            int stats_y = 0;
+            auto draw_stat = [&](const wchar_t* label, float value) {
+                swprintf_s(text, L"%ls%f", label, value);
+                draw_string(0, stats_y++, text);
+            };
+            draw_stat(L"Distance: ", _race.car_dist);
+            draw_stat(L"Target Curvature: ", _track[track_section].curvature);
+            draw_stat(L"Current Track Curvature: ", _race.curvature);
+            draw_stat(L"Track Curvature Accum: ", _race.track_curv_accum);
+            draw_stat(L"Car Curvature Accum: ", _race.car_curv_accum);
+            draw_stat(L"Car Speed: ", _race.car_speed);
+            draw_stat(L"Lap progress: ", _race.lap_progress + _race.car_dist / _track_dist_total);
+
+            auto format_time = [&](float t) {
+                int min = static_cast<int>(t / 60.0f);
+                t -= min * 60.0f;
+                int sec = static_cast<int>(t);
+                int ms = static_cast<int>((t - (float)sec) * 1000.0f);
+                swprintf_s(text, L"%d:%d.%d", min, sec, ms);
+            };
+            format_time(_race.lap_time);
+            _font.draw_string(*this, width() - 96, 2, text, 2, color_t::fg_yellow);
+            stats_y = 10;
+            for (auto lt : _race.lap_time_hist) {
+                format_time(lt);
+                draw_string(10, stats_y++, text);
+            }
+
+	        return true;
+        }
+
+    private:
+        // steers and moves the car on the keys held, returns which way it's steering
+        car_dir::enum_t drive(float elapsed)
+        {
+            auto dir = car_dir::neutral;
+
+            if (get_key(VK_UP).held) {
+                _race.car_speed += 2.5f * elapsed;
+            }
+            else if (get_key(VK_DOWN).held) {
+                _race.car_speed -= 2.0f * elapsed;
+            }
+            else {
+                if (_race.car_speed > 0.0f) {
+                    _race.car_speed = fmaxf(0.0f, _race.car_speed - 1.0f * elapsed);
+                }
+                else {
+                    _race.car_speed = fminf(0.0f, _race.car_speed + 1.0f * elapsed);
+                }
+            }
+
+            if (get_key(VK_RIGHT).held) {
+                _race.car_curv_accum += 0.7f * elapsed;
+                dir = car_dir::right;
+            }
+            else if (get_key(VK_LEFT).held) {
+                _race.car_curv_accum -= 0.7f * elapsed;
+                dir = car_dir::left;
+            }
+
+            if (fabs(_race.car_curv_accum - _race.track_curv_accum) >= 0.8f) {
+                if (_race.car_speed > 0.0f) {
+                    _race.car_speed = fmaxf(0.0f, _race.car_speed - 5.0f * elapsed);
+                }
+                else {
+                    _race.car_speed = fminf(0.0f, _race.car_speed + 5.0f * elapsed);
+                }
+            }
+
+            _race.car_speed = std::clamp(_race.car_speed, -1.0f, 1.5f);
+            
+            _race.car_dist += 70.0f * _race.car_speed * elapsed;
+            if (_race.car_dist >= _track_dist_total) {
+                ++_race.lap_progress;
+                _race.car_dist -= _track_dist_total;
+            }
+            else if (_race.car_dist < 0) {
+                --_race.lap_progress;
+                _race.car_dist += _track_dist_total;
+            }
+
+            if (_race.lap_progress == 1) {
+                copy_backward(_race.lap_time_hist.begin(), _race.lap_time_hist.end() - 1, _race.lap_time_hist.end());
+                _race.lap_time_hist[0] = _race.lap_time;
+                _race.lap_time = 0.0f;
+                _race.lap_progress = 0;
+                audio().play(_lap_sound);
+            }
+            _race.lap_time += elapsed;
+
+            float target_curvature = _track[section_at(_race.car_dist)].curvature;
+            // gradually change curvature to target curvature over 1 sec
+            _race.curvature += (target_curvature - _race.curvature) * elapsed * abs(_race.car_speed);
+            _race.track_curv_accum += _race.curvature * elapsed * abs(_race.car_speed);
+            return dir;
+        }
+
+        // the section the car is on at dist
+        int section_at(float dist) const
+        {
+            int track_section = 0;
+            float track_dist = _track[0].dist;
+            auto car_dist_on_track = fmod(dist, _track_dist_total);
+
+            while (track_section < _track.size() && track_dist <= car_dist_on_track) {
+                ++track_section;
+                track_dist += _track[track_section].dist;
+            }
+            return track_section;
+        }
+    };
+}
+
+int main() {
+    olc::racing game{};
+    game.construct_console(8, 8);
+    game.start();
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "cmd_engine.h"
+#include "spectator.h"
+#include <iostream>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// Renders the frames streamed by a running engine's spectator_server.
+	// Only the runs changed by each delta are redrawn. The console follows a keyframe that changes the size, and
+	// everything is redrawn after a resize.
+	//
+	class spectate : public cmd_engine
+	{
+	public:
+		explicit spectate(spectator_client& client)
+			: _client{ client }
+			, _stream_w{ client.width() }
+			, _stream_h{ client.height() }
+		{
+			_app_name = L"Spectator";
+		}
+
+		// Inherited via cmd_engine
+		virtual bool on_user_init() override
+		{
+			return true;
+		}
+
+		virtual bool on_user_update(float elapsed) override
+		{
+			if (!_client.poll()) {
+				// game ended
+				return false;
+			}
+			if (_client.width() != _stream_w || _client.height() != _stream_h) {
+				_stream_w = _client.width();
+				_stream_h = _client.height();
+				set_screen_size(_stream_w, _stream_h);
+			}
+
+			const auto& screen = _client.screen();
+			const int w = _client.width();
+			auto draw_run = [&](uint32_t offset, uint32_t length) {
+				for (uint32_t i = offset; i < offset + length; ++i) {
+					draw(i % w, i / w, screen[i].Char.UnicodeChar, screen[i].Attributes);
+				}
+			};
+			if (_redraw) {
+				draw_run(0, static_cast<uint32_t>(screen.size()));
+				_redraw = false;
+			}
+			else {
+				for (const auto& run : _client.changed()) {
+					draw_run(run.offset, run.length);
+				}
+			}
+			_client.clear_changed();
+			return true;
+		}
+
+		// the screen is blank after a resize
+		virtual void on_resize(int w, int h) override
+		{
+			_redraw = true;
+		}
+
+	private:
+		spectator_client& _client;
+		int _stream_w;
+		int _stream_h;
+		bool _redraw{ false };
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	string path = (argc > 1) ? argv[1] : olc::spectator_protocol::default_path;
+	int font_size = (argc > 2) ? atoi(argv[2]) : 8;
+
+	try {
+		olc::spectator_client client;
+		client.connect(path);
+
+		olc::spectate viewer{ client };
+		viewer.set_resizable(true);
+		viewer.construct_console(client.width(), client.height(), font_size, font_size);
+		viewer.start();
+	}
+	catch (olc::olc_exception& e) {
+		wcerr << e.msg().data() << endl;
+		return 1;
+	}
+	return 0;
+}
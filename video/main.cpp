@@ -0,0 +1,112 @@
+#include "cmd_engine.h"
+#include "video_player.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+namespace olc
+{
+	//
+	// Plays a video file on the console. With --fast every frame is shown as soon as it's converted, the frame rate
+	// in the title then is what the engine can present.
+	//
+	class video : public cmd_engine
+	{
+	public:
+		explicit video(video_player& player)
+			: _player{ player }
+		{
+			_app_name = L"Video";
+		}
+
+		// Inherited via cmd_engine
+		virtual bool on_user_init() override
+		{
+			_player.start(width(), height());
+			return true;
+		}
+
+		virtual bool on_user_update(float elapsed) override
+		{
+			if (get_key(VK_ESCAPE).pressed) {
+				return false;
+			}
+			return _player.draw(*this);
+		}
+
+	private:
+		video_player& _player;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	string usage = "usage: video [--fast] [--loop] [--no-dither] [--width <cells>] <file.y4m>\n"
+		"       video [--fast] [--loop] [--no-dither] [--width <cells>] --raw <w> <h> <fps> <file.rgb>";
+	bool fast = false;
+	bool loop = false;
+	bool dither = true;
+	int width = 160;
+	int raw_w = 0, raw_h = 0;
+	float raw_fps = 0.0f;
+	wstring file;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg == "--fast") {
+			fast = true;
+		}
+		else if (arg == "--loop") {
+			loop = true;
+		}
+		else if (arg == "--no-dither") {
+			dither = false;
+		}
+		else if (arg == "--width" && i + 1 < argc) {
+			width = max(8, atoi(argv[++i]));
+		}
+		else if (arg == "--raw" && i + 3 < argc) {
+			raw_w = atoi(argv[++i]);
+			raw_h = atoi(argv[++i]);
+			raw_fps = static_cast<float>(atof(argv[++i]));
+		}
+		else if (file.empty() && !arg.empty() && arg[0] != '-') {
+			file = filesystem::path(arg).wstring();
+		}
+		else {
+			cerr << usage << endl;
+			return 1;
+		}
+	}
+	if (file.empty()) {
+		cerr << usage << endl;
+		return 1;
+	}
+
+	try {
+		unique_ptr<olc::video_player> player = raw_w > 0
+			? make_unique<olc::video_player>(file, raw_w, raw_h, raw_fps)
+			: make_unique<olc::video_player>(file);
+		player->set_loop(loop);
+		player->set_dither(dither);
+		player->set_unthrottled(fast);
+
+		// square cells at 4x4, so the picture keeps its aspect
+		int height = max(1, width * player->video_height() / player->video_width());
+		olc::video app{ *player };
+		app.construct_console(width, height, 4, 4);
+		app.start();
+
+		auto s = player->get_stats();
+		wcout << L"presented " << s.presented << L" frames, dropped " << s.dropped << L", "
+			<< s.convert_ms << L" ms per frame to convert" << endl;
+	}
+	catch (olc::olc_exception& e) {
+		wcerr << e.msg().data() << endl;
+		return 1;
+	}
+	return 0;
+}